@@ -4,12 +4,14 @@ out vec4 FragColor;
 in vec3 FragPos;
 in vec3 Normal;
 in vec3 UV;
+in vec3 VertexColor;
 
 uniform vec3 color;
 uniform vec3 lightColor;
 uniform vec3 lightPos;
 uniform float ambientStrength;
 uniform bool uniformColor;
+uniform bool vertexColor; // Couleur donnée par sommet (rayons, cf. RayBatch)
 
 // 0 = Visualisation des couleurs
 // 1 = Visualisation de la normale
@@ -18,6 +20,11 @@ uniform int displayMode;
 
 void main()
 {
+    if(vertexColor) {
+        FragColor = vec4(VertexColor, 1.0f);
+        return;
+    }
+
     if(uniformColor) {
         FragColor = vec4(color, 1.0f);
         return;
@@ -2,10 +2,12 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec3 aUV;
+layout (location = 3) in vec3 aColor;
 
 out vec3 FragPos; // Fragment position
 out vec3 Normal; // Normal value
 out vec3 UV; // UV Map (only Bezier Curve)
+out vec3 VertexColor; // Vertex color (only RayBatch)
 
 uniform mat4 model;
 uniform mat4 view;
@@ -18,4 +20,5 @@ void main()
     FragPos = vec3(model * vec4(aPos, 1.0));
     Normal = aNormal;
     UV = aUV;
+    VertexColor = aColor;
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "AppContext.hpp"
+#include "GBuffer.hpp"
+#include "TraceScene.hpp"
 
 
 AppContext::AppContext(unsigned int screen_width, unsigned int screen_height, glm::vec3 backgroundColor, glm::vec3 lightColor) :
@@ -7,11 +9,20 @@ AppContext::AppContext(unsigned int screen_width, unsigned int screen_height, gl
     m_backgroundColor(backgroundColor),
     m_lightColor(lightColor),
     m_displayMode(STANDARD_DISPLAY_MODE),
+    m_rayMode(RAY_MODE_SINGLE),
     m_activeObjectIndex(-1),
     m_camera(Camera(glm::vec3(-3.0f, 0.5f, 6.0f))),
     m_projection(glm::mat4(1.0f)),
     m_view(glm::mat4(1.0f)),
-    m_cursor({SCR_WIDTH / 2.0f, SCR_HEIGHT / 2.0f})
+    m_cursor({SCR_WIDTH / 2.0f, SCR_HEIGHT / 2.0f}),
+    m_traceAcceleration(TRACE_ACCEL_BVH),
+    m_traceShadows(true),
+    m_traceBounces(TRACE_DEFAULT_BOUNCES),
+    m_traceSamples(TRACE_DEFAULT_SAMPLES),
+    m_traceSampler(SAMPLER_SOBOL),
+    m_tracePhotons(TRACE_DEFAULT_PHOTONS),
+    m_traceIntegrator(TRACE_INTEGRATOR_MIRROR),
+    m_tracePrimary(TRACE_PRIMARY_RAYS)
 {}
 
 
@@ -30,6 +41,9 @@ Object *AppContext::getActiveAsObject()
 
 void AppContext::addObject(AppContext::uniqueObject new_object)
 {
+    // Les rayons ne sont pas dans la scène du lancer de rayons, inutile de la reconstruire
+    if(dynamic_cast<Ray*>(new_object.get()) == nullptr) m_traceScene.reset();
+
     m_objects.push_back(std::move(new_object));
     if(m_activeObjectIndex == -1) m_activeObjectIndex++;
     return;
@@ -60,12 +74,9 @@ void AppContext::previousObject()
 unsigned int AppContext::size() const {return m_objects.size();}
 
 
-void AppContext::clearRays()
-{
-    m_objects.erase(std::remove_if(m_objects.begin(), m_objects.end(), [](const std::unique_ptr<Object>& obj) {
-        return dynamic_cast<Ray*>(obj.get()) != nullptr;
-    }), m_objects.end());
-}
+void AppContext::clearRays() {m_rayBatch.clear();}
+
+RayBatch* AppContext::getRayBatch() {return &m_rayBatch;}
 
 
 Object* AppContext::getObject(size_t index) {
@@ -80,6 +91,9 @@ glm::vec3 AppContext::getLightColor() {return m_lightColor;}
 unsigned int AppContext::getDisplayMode() const {return m_displayMode;}
 void AppContext::setDisplayMode(unsigned int value) {m_displayMode = value;}
 
+unsigned int AppContext::getRayMode() const {return m_rayMode;}
+void AppContext::setRayMode(unsigned int value) {m_rayMode = value;}
+
 
 void AppContext::drawContext(Shader shader)
 {
@@ -106,6 +120,9 @@ void AppContext::drawContext(Shader shader)
 
         element->draw(shader);
     }
+
+    // Tous les rayons lancés, en un seul appel
+    m_rayBatch.draw(shader);
 }
 
 
@@ -134,3 +151,94 @@ float AppContext::getLastFrame() {return m_lastFrame;}
 void AppContext::setLastFrame(float value) {m_lastFrame = value;}
 
 unsigned int AppContext::getActiveIndex() {return m_activeObjectIndex;}
+
+
+std::shared_ptr<const TraceScene> AppContext::getTraceScene()
+{
+    if(!m_traceScene || !m_traceScene->update())
+        m_traceScene = std::make_shared<TraceScene>(*this, m_traceAcceleration);
+
+    // La lumière suit l'objet actif et sa position, les caustiques suivent la lumière et les objets
+    m_traceScene->setLight(getActiveAsObject());
+    m_traceScene->updateCaustics();
+    return m_traceScene;
+}
+
+
+GBuffer& AppContext::getCaptureCache()
+{
+    if(!m_captureCache) m_captureCache = std::make_shared<GBuffer>();
+    return *m_captureCache;
+}
+
+
+void AppContext::setTraceAcceleration(unsigned int value)
+{
+    if(value != m_traceAcceleration) m_traceScene.reset();
+    m_traceAcceleration = value;
+}
+
+unsigned int AppContext::getTraceAcceleration() const {return m_traceAcceleration;}
+
+
+void AppContext::setTraceShadows(bool value)
+{
+    if(value != m_traceShadows) m_traceScene.reset();
+    m_traceShadows = value;
+}
+
+bool AppContext::getTraceShadows() const {return m_traceShadows;}
+
+
+void AppContext::setTraceBounces(unsigned int value)
+{
+    if(value != m_traceBounces) m_traceScene.reset();
+    m_traceBounces = value;
+}
+
+unsigned int AppContext::getTraceBounces() const {return m_traceBounces;}
+
+
+void AppContext::setTraceSamples(unsigned int value)
+{
+    if(value != m_traceSamples) m_traceScene.reset();
+    m_traceSamples = value;
+}
+
+unsigned int AppContext::getTraceSamples() const {return m_traceSamples;}
+
+
+void AppContext::setTraceSampler(unsigned int value)
+{
+    if(value != m_traceSampler) m_traceScene.reset();
+    m_traceSampler = value;
+}
+
+unsigned int AppContext::getTraceSampler() const {return m_traceSampler;}
+
+
+void AppContext::setTracePhotons(unsigned int value)
+{
+    if(value != m_tracePhotons) m_traceScene.reset();
+    m_tracePhotons = value;
+}
+
+unsigned int AppContext::getTracePhotons() const {return m_tracePhotons;}
+
+
+void AppContext::setTraceIntegrator(unsigned int value)
+{
+    if(value != m_traceIntegrator) m_traceScene.reset();
+    m_traceIntegrator = value;
+}
+
+unsigned int AppContext::getTraceIntegrator() const {return m_traceIntegrator;}
+
+
+void AppContext::setTracePrimary(unsigned int value)
+{
+    if(value != m_tracePrimary) m_traceScene.reset();
+    m_tracePrimary = value;
+}
+
+unsigned int AppContext::getTracePrimary() const {return m_tracePrimary;}
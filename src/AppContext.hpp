@@ -19,12 +19,21 @@
 #include "ScalableElement.hpp"
 #include "Object.hpp"
 #include "Ray.hpp"
+#include "RayBatch.hpp"
 #include "../includes/camera.hpp"
 
 #define STANDARD_DISPLAY_MODE 0
 #define NORMAL_DISPLAY_MODE 1
 #define UV_DISPLAY_MODE 2
 
+#define RAY_MODE_SINGLE 0   // Un clic lance un seul rayon
+#define RAY_MODE_FAN_CONE 1 // Un clic lance un éventail de rayons en cône (cf. Intersection::rayFan())
+#define RAY_MODE_FAN_GRID 2 // Un clic lance un éventail de rayons en grille carrée
+#define RAY_MODE_COUNT 3
+
+class TraceScene;
+class GBuffer;
+
 /**
  * @class AppContext
  * @brief Objet englobant les éléments du contexte de la fenetre.
@@ -107,9 +116,15 @@ public:
 
     /**
      * @brief Supprime tous les rayons qui ont été lancés dans la scène (et leur réflexion s'ils
-     * en ont une).
+     * en ont une), en temps constant (cf. RayBatch::clear()).
      */
     void clearRays();
+
+    /**
+     * @brief Retourne le tampon des rayons lancés dans la scène, dessiné après les objets par
+     * drawContext().
+     */
+    RayBatch* getRayBatch();
     
     /**
      * @brief Retourne un pointeur vers l'objet d'index égal à celui passé en paramètre. S'il n y a
@@ -131,6 +146,13 @@ public:
     unsigned int getDisplayMode() const;
     void setDisplayMode(unsigned int value);
 
+    /**
+     * @brief Rayons lancés par un clic : RAY_MODE_SINGLE (par défaut), RAY_MODE_FAN_CONE ou
+     * RAY_MODE_FAN_GRID.
+     */
+    unsigned int getRayMode() const;
+    void setRayMode(unsigned int value);
+
     void drawContext(Shader shader);
     
     /**
@@ -223,14 +245,80 @@ public:
      */
     unsigned int getActiveIndex();
 
+    /**
+     * @brief Renvoie la scène utilisée par le lancer de rayons. Elle est gardée d'un appel à
+     * l'autre : reconstruite après l'ajout d'un objet (autre qu'un rayon) ou si la géométrie d'un
+     * objet a changé, seulement mise à jour si des objets ont été déplacés.
+     */
+    std::shared_ptr<const TraceScene> getTraceScene();
+
+    /**
+     * @brief Renvoie le cache des captures d'écran (cf. Intersection::raySavePNG()), créé au premier
+     * appel.
+     */
+    GBuffer& getCaptureCache();
+
+    /**
+     * @brief Choisit la structure d'accélération de la scène du lancer de rayons (TRACE_ACCEL_BVH
+     * par défaut, TRACE_ACCEL_GRID pour les scènes animées, cf. TraceScene.hpp).
+     */
+    void setTraceAcceleration(unsigned int value);
+    unsigned int getTraceAcceleration() const;
+
+    /**
+     * @brief Active les ombres du lancer de rayons (rayons d'ombre vers l'objet actif, qui sert de
+     * lumière comme dans draw()). Actives par défaut.
+     */
+    void setTraceShadows(bool value);
+    bool getTraceShadows() const;
+
+    /**
+     * @brief Nombre de rebonds suivis par le lancer de rayons après le rayon primaire
+     * (TRACE_DEFAULT_BOUNCES par défaut, 0 pour la seule couleur des objets touchés).
+     */
+    void setTraceBounces(unsigned int value);
+    unsigned int getTraceBounces() const;
+
+    /**
+     * @brief Nombre d'échantillons par pixel des captures (TRACE_DEFAULT_SAMPLES par défaut) et
+     * suite qui les place dans le pixel (SAMPLER_SOBOL par défaut, cf. Sampler.hpp).
+     */
+    void setTraceSamples(unsigned int value);
+    unsigned int getTraceSamples() const;
+    void setTraceSampler(unsigned int value);
+    unsigned int getTraceSampler() const;
+
+    /**
+     * @brief Nombre de photons émis pour les caustiques du lancer de rayons (TRACE_DEFAULT_PHOTONS
+     * par défaut, 0 pour ne pas calculer de caustiques, cf. TraceScene::updateCaustics()).
+     */
+    void setTracePhotons(unsigned int value);
+    unsigned int getTracePhotons() const;
+
+    /**
+     * @brief Intégrateur du lancer de rayons (TRACE_INTEGRATOR_MIRROR par défaut, chemins aléatoires
+     * avec TRACE_INTEGRATOR_PATH_*, cf. TraceScene::traceRadiance()).
+     */
+    void setTraceIntegrator(unsigned int value);
+    unsigned int getTraceIntegrator() const;
+
+    /**
+     * @brief Origine des points vus par la caméra dans les captures (TRACE_PRIMARY_RAYS par défaut,
+     * maillages rastérisés avec TRACE_PRIMARY_RASTER, cf. GBuffer).
+     */
+    void setTracePrimary(unsigned int value);
+    unsigned int getTracePrimary() const;
+
 private:
 
     uniqueObjectsList m_objects;
+    RayBatch m_rayBatch;
     size_t m_activeObjectIndex;
 
     glm::vec3 m_backgroundColor;
     glm::vec3 m_lightColor;
     unsigned int m_displayMode;
+    unsigned int m_rayMode;
     
     glm::mat4 m_projection;
     glm::mat4 m_view;
@@ -243,6 +331,17 @@ private:
 
     float m_deltaTime = 0.0f;
     float m_lastFrame = 0.0f;
+
+    std::shared_ptr<TraceScene> m_traceScene; // Construite au premier lancer de rayons
+    std::shared_ptr<GBuffer> m_captureCache;  // Créé à la première capture d'écran
+    unsigned int m_traceAcceleration;
+    bool m_traceShadows;
+    unsigned int m_traceBounces;
+    unsigned int m_traceSamples;
+    unsigned int m_traceSampler;
+    unsigned int m_tracePhotons;
+    unsigned int m_traceIntegrator;
+    unsigned int m_tracePrimary;
 };
 
 #endif //APP_CONTEXT_HPP
\ No newline at end of file
@@ -0,0 +1,345 @@
+#include "BVHBuilder.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+#define BVH_BINNING_CHUNK 16384 // Primitives réparties par tâche lors de la répartition parallèle
+
+
+namespace {
+
+typedef struct s_Bounds {
+    glm::vec3 min;
+    glm::vec3 max;
+} Bounds;
+
+typedef struct s_Bin {
+    Bounds bounds;
+    unsigned int count;
+} Bin;
+
+typedef struct s_BinSet {
+    Bin bins[3][BVH_SAH_BINS];
+    int binCount; // Moins d'intervalles pour les petits noeuds, qui sont les plus nombreux
+} BinSet;
+
+/**
+ * @brief Primitive en cours de rangement : ce sont ces copies qui sont partagées entre les fils,
+ * pour que la répartition en intervalles lise la mémoire dans l'ordre.
+ */
+typedef struct s_BuildPrimitive {
+    glm::vec3 boundsMin;
+    unsigned int index;
+    glm::vec3 boundsMax;
+    glm::vec3 center;
+} BuildPrimitive;
+
+/**
+ * @brief Données partagées par toutes les tâches d'une construction.
+ */
+typedef struct s_BuildContext {
+    std::vector<BuildPrimitive> primitives;
+    std::vector<BVHNode> *nodes;
+    std::atomic<unsigned int> nodeCount;
+    unsigned int maxLeafSize;
+} BuildContext;
+
+
+inline Bounds emptyBounds()
+{
+    return {glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max())};
+}
+
+inline void grow(Bounds &bounds, const glm::vec3 &min, const glm::vec3 &max)
+{
+    bounds.min = glm::min(bounds.min, min);
+    bounds.max = glm::max(bounds.max, max);
+}
+
+inline float area(const Bounds &bounds)
+{
+    glm::vec3 e = glm::max(bounds.max - bounds.min, glm::vec3(0.0f));
+    return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+inline float nodeArea(const BVHNode &node)
+{
+    return area({node.boundsMin, node.boundsMax});
+}
+
+
+/**
+ * @brief Intervalle du centre c sur l'axe axis (même calcul pour la répartition et le partage).
+ */
+inline int binIndex(const glm::vec3 &c, int axis, const Bounds &centers, float scale, int binCount)
+{
+    int bin = (int)((c[axis] - centers.min[axis]) * scale);
+    return std::min(std::max(bin, 0), binCount - 1);
+}
+
+
+void fillBins(const BuildContext &ctx, unsigned int begin, unsigned int end, const Bounds &centers,
+    const glm::vec3 &scale, BinSet &set)
+{
+    for(int axis = 0; axis < 3; ++axis)
+        for(int b = 0; b < set.binCount; ++b)
+            set.bins[axis][b] = {emptyBounds(), 0};
+
+    for(unsigned int i = begin; i < end; ++i) {
+        const BuildPrimitive &prim = ctx.primitives[i];
+        for(int axis = 0; axis < 3; ++axis) {
+            Bin &bin = set.bins[axis][binIndex(prim.center, axis, centers, scale[axis], set.binCount)];
+            grow(bin.bounds, prim.boundsMin, prim.boundsMax);
+            bin.count++;
+        }
+    }
+}
+
+
+void mergeBins(BinSet &into, const BinSet &from)
+{
+    for(int axis = 0; axis < 3; ++axis) {
+        for(int b = 0; b < into.binCount; ++b) {
+            Bin &dst = into.bins[axis][b];
+            const Bin &src = from.bins[axis][b];
+            grow(dst.bounds, src.bounds.min, src.bounds.max);
+            dst.count += src.count;
+        }
+    }
+}
+
+
+/**
+ * @brief Boîte des primitives order[begin, end[ et boîte de leurs centres.
+ */
+void rangeBounds(const BuildContext &ctx, unsigned int begin, unsigned int end, Bounds &bounds,
+    Bounds &centers)
+{
+    bounds = centers = emptyBounds();
+    for(unsigned int i = begin; i < end; ++i) {
+        const BuildPrimitive &prim = ctx.primitives[i];
+        grow(bounds, prim.boundsMin, prim.boundsMax);
+        grow(centers, prim.center, prim.center);
+    }
+}
+
+
+/**
+ * @brief Plus petit k tel que 2^k >= n : profondeur d'un arbre coupé à la médiane sur n primitives.
+ */
+inline unsigned int ceilLog2(unsigned int n)
+{
+    unsigned int k = 0;
+    while(k < 32 && (1ull << k) < n) ++k;
+    return k;
+}
+
+
+/**
+ * @brief Construit le noeud nodeIndex, à la profondeur depth, sur les primitives order[begin, end[,
+ * dont la boîte et la boîte des centres sont déjà connues (calculées par le parent).
+ */
+void buildNode(BuildContext &ctx, unsigned int nodeIndex, unsigned int depth, unsigned int begin,
+    unsigned int end, const Bounds &bounds, const Bounds &centers)
+{
+    BVHNode &node = (*ctx.nodes)[nodeIndex];
+    node.boundsMin = bounds.min;
+    node.boundsMax = bounds.max;
+    node.first = begin;
+    node.count = end - begin;
+
+    unsigned int count = end - begin;
+    if(count == 1) return;
+
+    // Répartition des centres en intervalles sur les trois axes
+    int binCount = std::min<unsigned int>(BVH_SAH_BINS, std::max(4u, count));
+    glm::vec3 extent = centers.max - centers.min;
+    glm::vec3 scale;
+    for(int axis = 0; axis < 3; ++axis)
+        scale[axis] = (extent[axis] > 0.0f) ? binCount / extent[axis] : 0.0f;
+
+    BinSet set;
+    set.binCount = binCount;
+    if(count >= BVH_PARALLEL_BINNING_THRESHOLD) {
+        unsigned int chunks = (count + BVH_BINNING_CHUNK - 1) / BVH_BINNING_CHUNK;
+        std::vector<BinSet> partial(chunks);
+        {
+            TaskGroup group;
+            for(unsigned int c = 0; c < chunks; ++c) {
+                partial[c].binCount = binCount;
+                group.run([&, c]() {
+                    unsigned int first = begin + c * BVH_BINNING_CHUNK;
+                    fillBins(ctx, first, std::min(first + BVH_BINNING_CHUNK, end), centers, scale, partial[c]);
+                });
+            }
+        }
+        set = partial[0];
+        for(unsigned int c = 1; c < chunks; ++c) mergeBins(set, partial[c]);
+    }
+    else {
+        fillBins(ctx, begin, end, centers, scale, set);
+    }
+
+    // Meilleur plan : balayage des intervalles de droite à gauche puis de gauche à droite
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1, bestSplit = 0;
+    unsigned int bestLeftCount = 0;
+
+    for(int axis = 0; axis < 3; ++axis) {
+        if(extent[axis] <= 0.0f) continue;
+        const Bin *bins = set.bins[axis];
+
+        float rightArea[BVH_SAH_BINS];
+        unsigned int rightCount[BVH_SAH_BINS];
+        Bounds right = emptyBounds();
+        unsigned int n = 0;
+        for(int b = binCount - 1; b > 0; --b) {
+            if(bins[b].count) grow(right, bins[b].bounds.min, bins[b].bounds.max);
+            n += bins[b].count;
+            rightArea[b] = area(right);
+            rightCount[b] = n;
+        }
+
+        Bounds left = emptyBounds();
+        n = 0;
+        for(int b = 0; b < binCount - 1; ++b) {
+            if(bins[b].count) grow(left, bins[b].bounds.min, bins[b].bounds.max);
+            n += bins[b].count;
+            if(n == 0 || rightCount[b + 1] == 0) continue;
+
+            float cost = area(left) * n + rightArea[b + 1] * rightCount[b + 1];
+            if(cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b + 1;
+                bestLeftCount = n;
+            }
+        }
+    }
+
+    float splitCost = BVH_TRAVERSAL_COST + BVH_INTERSECTION_COST * bestCost / area(bounds);
+    float leafCost = BVH_INTERSECTION_COST * count;
+    if(count <= ctx.maxLeafSize && (bestAxis < 0 || leafCost <= splitCost)) return;
+
+    // Un fils SAH peut garder presque toutes les primitives : s'il risque de ne plus tenir dans
+    // BVH_MAX_DEPTH en coupant ensuite à la médiane, on coupe à la médiane dès maintenant
+    bool median = depth + 1 + ceilLog2(count) > BVH_MAX_DEPTH;
+
+    unsigned int middle;
+    if(median && bestAxis >= 0) {
+        int axis = (extent.x > extent.y) ? ((extent.x > extent.z) ? 0 : 2) : ((extent.y > extent.z) ? 1 : 2);
+        middle = begin + count / 2;
+        std::nth_element(ctx.primitives.begin() + begin, ctx.primitives.begin() + middle,
+            ctx.primitives.begin() + end, [axis](const BuildPrimitive &a, const BuildPrimitive &b) {
+                return a.center[axis] < b.center[axis];
+            });
+    }
+    else if(bestAxis >= 0) {
+        const Bounds centersCopy = centers;
+        const float axisScale = scale[bestAxis];
+        std::partition(ctx.primitives.begin() + begin, ctx.primitives.begin() + end,
+            [&](const BuildPrimitive &prim) {
+                return binIndex(prim.center, bestAxis, centersCopy, axisScale, binCount) < bestSplit;
+            });
+        middle = begin + bestLeftCount;
+    }
+    else {
+        // Tous les centres sont confondus : coupe au milieu de la liste
+        middle = begin + count / 2;
+    }
+
+    // Boîtes des deux fils, pour lesquels elles ne seront plus recalculées
+    Bounds childBounds[2], childCenters[2];
+    rangeBounds(ctx, begin, middle, childBounds[0], childCenters[0]);
+    rangeBounds(ctx, middle, end, childBounds[1], childCenters[1]);
+
+    unsigned int left = ctx.nodeCount.fetch_add(2);
+    node.first = left;
+    node.count = 0;
+
+    // Le fils gauche est confié à un autre thread, le thread courant construit le droit
+    if(count >= BVH_TASK_THRESHOLD) {
+        TaskGroup group;
+        group.run([&ctx, left, depth, begin, middle, childBounds, childCenters]() {
+            buildNode(ctx, left, depth + 1, begin, middle, childBounds[0], childCenters[0]);
+        });
+        buildNode(ctx, left + 1, depth + 1, middle, end, childBounds[1], childCenters[1]);
+    }
+    else {
+        buildNode(ctx, left, depth + 1, begin, middle, childBounds[0], childCenters[0]);
+        buildNode(ctx, left + 1, depth + 1, middle, end, childBounds[1], childCenters[1]);
+    }
+}
+
+} // namespace
+
+
+BVHBuildStats BVHBuilder::build(const std::vector<BVHPrimitive> &primitives, unsigned int maxLeafSize,
+    std::vector<BVHNode> &nodes, std::vector<unsigned int> &order)
+{
+    auto start = std::chrono::steady_clock::now();
+    BVHBuildStats stats = {0.0, (unsigned int)primitives.size(), 0, 0, 0.0f};
+
+    nodes.clear();
+    order.resize(primitives.size());
+    if(primitives.empty()) return stats;
+
+    BuildContext ctx;
+    ctx.nodes = &nodes;
+    ctx.nodeCount = 1;
+    ctx.maxLeafSize = std::max(maxLeafSize, 1u);
+    ctx.primitives.resize(primitives.size());
+
+    // Un arbre binaire avec des feuilles d'au moins une primitive a au plus 2n - 1 noeuds
+    nodes.resize(2 * primitives.size() - 1);
+
+    Bounds bounds = emptyBounds(), centers = emptyBounds();
+    for(size_t i = 0; i < primitives.size(); ++i) {
+        BuildPrimitive &prim = ctx.primitives[i];
+        prim.boundsMin = primitives[i].boundsMin;
+        prim.boundsMax = primitives[i].boundsMax;
+        prim.center = 0.5f * (prim.boundsMin + prim.boundsMax);
+        prim.index = i;
+        grow(bounds, prim.boundsMin, prim.boundsMax);
+        grow(centers, prim.center, prim.center);
+    }
+
+    buildNode(ctx, 0, 0, 0, primitives.size(), bounds, centers);
+    nodes.resize(ctx.nodeCount);
+    for(size_t i = 0; i < primitives.size(); ++i) order[i] = ctx.primitives[i].index;
+    nodes.shrink_to_fit();
+
+    stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.nodes = nodes.size();
+    stats.leaves = (nodes.size() + 1) / 2;
+    stats.sahCost = sahCost(nodes);
+    return stats;
+}
+
+
+float BVHBuilder::sahCost(const std::vector<BVHNode> &nodes)
+{
+    if(nodes.empty()) return 0.0f;
+
+    float rootArea = nodeArea(nodes[0]);
+    if(rootArea <= 0.0f) return 0.0f;
+
+    double cost = 0.0;
+    for(const BVHNode &node : nodes) {
+        float a = nodeArea(node) / rootArea;
+        cost += (node.count == 0) ? BVH_TRAVERSAL_COST * a : BVH_INTERSECTION_COST * a * node.count;
+    }
+    return (float)cost;
+}
+
+
+void BVHBuilder::printStats(const std::string &name, const BVHBuildStats &stats)
+{
+    double rate = (stats.milliseconds > 0.0) ? stats.primitives / (stats.milliseconds * 1000.0) : 0.0;
+    std::cout << "BVH " << name << " : " << stats.primitives << " primitives, " << stats.nodes
+        << " noeuds, " << stats.leaves << " feuilles, coût SAH " << stats.sahCost << ", "
+        << stats.milliseconds << " ms (" << rate << " M primitives/s)" << std::endl;
+}
@@ -0,0 +1,123 @@
+#ifndef BVH_BUILDER_HPP
+#define BVH_BUILDER_HPP
+
+/**
+ * @file BVHBuilder.hpp
+ * @brief Définition de la classe BVHBuilder.
+ * 
+ * Ce fichier contient les noeuds des hiérarchies de volumes englobants (BVH) et leur construction
+ * par l'heuristique des aires (SAH) sur des intervalles ("bins"), en parallèle.
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <limits>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#define BVH_SAH_BINS 16                      // Intervalles testés par axe
+#define BVH_TRAVERSAL_COST 1.0f              // Coût relatif de la visite d'un noeud
+#define BVH_INTERSECTION_COST 1.0f           // Coût relatif d'un test de primitive
+#define BVH_TASK_THRESHOLD 4096              // En dessous, un sous-arbre est construit d'un bloc
+#define BVH_PARALLEL_BINNING_THRESHOLD 65536 // Au-dessus, la répartition en bins est parallèle
+#define BVH_MAX_DEPTH 40                     // Profondeur maximale d'une feuille (piles des parcours)
+
+
+/**
+ * @brief Noeud de la hiérarchie (32 octets, deux noeuds par ligne de cache).
+ * 
+ * Pour une feuille, first désigne ses primitives et count est leur nombre. Pour un noeud interne,
+ * count vaut 0 et first est l'indice du fils gauche, le fils droit le suit.
+ */
+typedef struct s_BVHNode {
+    glm::vec3 boundsMin;
+    unsigned int first;
+    glm::vec3 boundsMax;
+    unsigned int count;
+} BVHNode;
+
+
+/**
+ * @brief Boîte englobante d'une primitive à ranger dans la hiérarchie.
+ */
+typedef struct s_BVHPrimitive {
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+} BVHPrimitive;
+
+
+/**
+ * @brief Bilan d'une construction.
+ */
+typedef struct s_BVHBuildStats {
+    double milliseconds;
+    unsigned int primitives;
+    unsigned int nodes;
+    unsigned int leaves;
+    float sahCost; // Coût SAH de l'arbre, relatif à la boîte racine
+} BVHBuildStats;
+
+
+/**
+ * @brief Test rayon / boîte d'un noeud (méthode des "slabs"), renvoie la distance d'entrée ou
+ * l'infini si la boîte n'est pas touchée avant tMax.
+ */
+inline float intersectBounds(const BVHNode &node, const glm::vec3 &origin, const glm::vec3 &invDir,
+    float tMax)
+{
+    glm::vec3 t0 = (node.boundsMin - origin) * invDir;
+    glm::vec3 t1 = (node.boundsMax - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+
+    float enter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+    float exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, tMax));
+
+    return (enter <= exit) ? enter : std::numeric_limits<float>::infinity();
+}
+
+
+/**
+ * @class BVHBuilder
+ * @brief Construction d'une hiérarchie de volumes englobants.
+ * 
+ * Chaque noeud est coupé selon le plan qui minimise le coût SAH parmi BVH_SAH_BINS intervalles
+ * réguliers des centres des primitives, sur les trois axes. Les sous-arbres assez grands sont
+ * construits en parallèle sur ThreadPool, et la répartition des primitives en intervalles des
+ * premiers niveaux (les plus grands) est elle-même découpée en tâches.
+ *
+ * Les parcours rangent les noeuds mis de côté dans des piles de taille fixe : aucune feuille n'est
+ * à plus de BVH_MAX_DEPTH niveaux de la racine. Un noeud assez profond pour que le plan SAH risque
+ * de dépasser cette limite (primitives très regroupées ou en progression géométrique) est coupé à
+ * la médiane des centres, ce qui divise par deux le nombre de primitives à chaque niveau.
+ */
+class BVHBuilder
+{
+public:
+
+    /**
+     * @brief Construit la hiérarchie.
+     * @param primitives boîtes englobantes des primitives.
+     * @param maxLeafSize nombre maximal de primitives par feuille.
+     * @param nodes noeuds construits, la racine en premier.
+     * @param order ordre des primitives : la feuille (first, count) contient les primitives
+     * order[first] à order[first + count - 1].
+     * @return le bilan de la construction.
+     */
+    static BVHBuildStats build(const std::vector<BVHPrimitive> &primitives, unsigned int maxLeafSize,
+        std::vector<BVHNode> &nodes, std::vector<unsigned int> &order);
+
+    /**
+     * @brief Calcule le coût SAH d'une hiérarchie, relatif à l'aire de sa racine.
+     */
+    static float sahCost(const std::vector<BVHNode> &nodes);
+
+    /**
+     * @brief Affiche le bilan d'une construction dans le terminal.
+     */
+    static void printStats(const std::string &name, const BVHBuildStats &stats);
+};
+
+#endif // BVH_BUILDER_HPP
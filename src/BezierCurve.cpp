@@ -3,6 +3,7 @@
 
 BezierCurve::BezierCurve(ptsTab controlPoints) :
     m_controlPoints(controlPoints),
+    m_tube(std::make_shared<const BezierTube>(controlPoints)),
     m_nbCurvePoints(MIN_DISCRETE_POINTS),
     Object(false, false)
 {
@@ -34,6 +35,9 @@ glm::vec3 BezierCurve::curveValue(float u)
 }
 
 
+std::shared_ptr<const BezierTube> BezierCurve::getTube() const {return m_tube;}
+
+
 ptsTab BezierCurve::normalDiscretization()
 {
     ptsTab discretizedValues;
@@ -21,6 +21,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "utils.hpp"
+#include "BezierTube.hpp"
 #include "Object.hpp"
 #include "ScalableElement.hpp"
 
@@ -58,6 +59,12 @@ public:
      * valeur de u comprise dans l'intervalle [0;1].
      */
     glm::vec3 curveValue(float u);
+
+    /**
+     * @brief Renvoie le tube de rayon BEZIER_TUBE_RADIUS autour de la courbe, utilisé par le lancer
+     * de rayons (clic sur la courbe, captures).
+     */
+    std::shared_ptr<const BezierTube> getTube() const;
     
     // ------------------------ FONCTIONS VIRTUELLES DE LA CLASSE "OBJECT" ------------------------
 
@@ -98,6 +105,7 @@ private:
 
     ptsTab m_controlPoints;
     ptsTab m_curvePoints;
+    std::shared_ptr<const BezierTube> m_tube;
     unsigned int m_nbCurvePoints;
 
     GLuint controlVAO, controlVBO;
@@ -0,0 +1,221 @@
+#include "BezierPatch.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+BezierPatch::BezierPatch(const ptsGrid &controlPoints) :
+    m_orderU(controlPoints.size()),
+    m_orderV(controlPoints.empty() ? 0 : controlPoints[0].size())
+{
+    m_points.reserve(m_orderU * m_orderV);
+    for(const std::vector<glm::vec3> &row : controlPoints)
+        m_points.insert(m_points.end(), row.begin(), row.end());
+}
+
+
+bool BezierPatch::isValid() const
+{
+    return m_orderU >= 2 && m_orderV >= 2 &&
+        m_orderU <= BEZIER_PATCH_MAX_ORDER && m_orderV <= BEZIER_PATCH_MAX_ORDER;
+}
+
+
+void BezierPatch::getBounds(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const
+{
+    boundsMin = boundsMax = m_points.empty() ? glm::vec3(0.0f) : m_points[0];
+    for(const glm::vec3 &point : m_points) {
+        boundsMin = glm::min(boundsMin, point);
+        boundsMax = glm::max(boundsMax, point);
+    }
+}
+
+
+/**
+ * @brief Algorithme de de Casteljau sur une ligne de points de contrôle, renvoie le point au
+ * paramètre t et, si demandé, la dérivée en ce point.
+ */
+static glm::vec3 deCasteljau(glm::vec3 *points, unsigned int order, float t, glm::vec3 *derivative)
+{
+    for(unsigned int k = order - 1; k > 0; --k) {
+        if(k == 1 && derivative) *derivative = float(order - 1) * (points[1] - points[0]);
+        for(unsigned int i = 0; i < k; ++i) points[i] = glm::mix(points[i], points[i + 1], t);
+    }
+    return points[0];
+}
+
+
+glm::vec3 BezierPatch::evaluate(float u, float v, glm::vec3 *Su, glm::vec3 *Sv) const
+{
+    glm::vec3 column[BEZIER_PATCH_MAX_ORDER]; // S(u, v) = courbe en u des points des courbes en v
+    glm::vec3 columnDv[BEZIER_PATCH_MAX_ORDER];
+    glm::vec3 row[BEZIER_PATCH_MAX_ORDER];
+
+    for(unsigned int i = 0; i < m_orderU; ++i) {
+        std::copy(m_points.begin() + i * m_orderV, m_points.begin() + (i + 1) * m_orderV, row);
+        column[i] = deCasteljau(row, m_orderV, v, &columnDv[i]);
+    }
+
+    if(Sv) *Sv = deCasteljau(columnDv, m_orderU, u, nullptr);
+    return deCasteljau(column, m_orderU, u, Su);
+}
+
+
+glm::vec3 BezierPatch::normal(float u, float v) const
+{
+    glm::vec3 Su, Sv;
+    evaluate(u, v, &Su, &Sv);
+    glm::vec3 n = glm::cross(Su, Sv);
+    float length = glm::length(n);
+    return (length > 0.f) ? n / length : glm::vec3(0.f);
+}
+
+
+void BezierPatch::splitU(const Net &net, Net &left, Net &right) const
+{
+    for(unsigned int j = 0; j < m_orderV; ++j) {
+        glm::vec3 points[BEZIER_PATCH_MAX_ORDER];
+        for(unsigned int i = 0; i < m_orderU; ++i) points[i] = net.p[i][j];
+
+        // Les premiers et derniers points de chaque étape forment les deux moitiés
+        for(unsigned int k = 0; k < m_orderU; ++k) {
+            left.p[k][j] = points[0];
+            right.p[m_orderU - 1 - k][j] = points[m_orderU - 1 - k];
+            for(unsigned int i = 0; i + k + 1 < m_orderU; ++i) points[i] = 0.5f * (points[i] + points[i + 1]);
+        }
+    }
+
+    float middle = 0.5f * (net.u0 + net.u1);
+    left.u0 = net.u0; left.u1 = middle; left.v0 = net.v0; left.v1 = net.v1;
+    right.u0 = middle; right.u1 = net.u1; right.v0 = net.v0; right.v1 = net.v1;
+}
+
+
+void BezierPatch::splitV(const Net &net, Net &left, Net &right) const
+{
+    for(unsigned int i = 0; i < m_orderU; ++i) {
+        glm::vec3 points[BEZIER_PATCH_MAX_ORDER];
+        for(unsigned int j = 0; j < m_orderV; ++j) points[j] = net.p[i][j];
+
+        for(unsigned int k = 0; k < m_orderV; ++k) {
+            left.p[i][k] = points[0];
+            right.p[i][m_orderV - 1 - k] = points[m_orderV - 1 - k];
+            for(unsigned int j = 0; j + k + 1 < m_orderV; ++j) points[j] = 0.5f * (points[j] + points[j + 1]);
+        }
+    }
+
+    float middle = 0.5f * (net.v0 + net.v1);
+    left.u0 = net.u0; left.u1 = net.u1; left.v0 = net.v0; left.v1 = middle;
+    right.u0 = net.u0; right.u1 = net.u1; right.v0 = middle; right.v1 = net.v1;
+}
+
+
+bool BezierPatch::intersect(const glm::vec3 &origin, const glm::vec3 &direction, float &t, float &u,
+    float &v) const
+{
+    if(!isValid()) return false;
+
+    // Repère du rayon : deux plans orthogonaux qui le contiennent
+    RayFrame frame;
+    frame.origin = origin;
+    frame.direction = direction;
+    glm::vec3 d = glm::normalize(direction);
+    glm::vec3 axis = (std::fabs(d.x) < 0.9f) ? glm::vec3(1.f, 0.f, 0.f) : glm::vec3(0.f, 1.f, 0.f);
+    frame.n1 = glm::normalize(glm::cross(d, axis));
+    frame.n2 = glm::cross(d, frame.n1);
+
+    // La projection est affine : subdiviser le réseau projeté revient à projeter le réseau subdivisé
+    Net net;
+    float invLength2 = 1.f / glm::dot(direction, direction);
+    for(unsigned int i = 0; i < m_orderU; ++i) {
+        for(unsigned int j = 0; j < m_orderV; ++j) {
+            glm::vec3 p = m_points[i * m_orderV + j] - origin;
+            net.p[i][j] = glm::vec3(glm::dot(p, frame.n1), glm::dot(p, frame.n2),
+                glm::dot(p, direction) * invLength2);
+        }
+    }
+    net.u0 = 0.f; net.u1 = 1.f; net.v0 = 0.f; net.v1 = 1.f;
+
+    return search(frame, net, BEZIER_PATCH_EPSILON, t, u, v);
+}
+
+
+bool BezierPatch::search(const RayFrame &frame, const Net &net, float tMin, float &t, float &u,
+    float &v) const
+{
+    // Enveloppe convexe : le carreau est dans la boîte de son réseau de contrôle
+    glm::vec3 boundsMin = net.p[0][0], boundsMax = net.p[0][0];
+    for(unsigned int i = 0; i < m_orderU; ++i) {
+        for(unsigned int j = 0; j < m_orderV; ++j) {
+            boundsMin = glm::min(boundsMin, net.p[i][j]);
+            boundsMax = glm::max(boundsMax, net.p[i][j]);
+        }
+    }
+
+    if(boundsMin.x > 0.f || boundsMax.x < 0.f || boundsMin.y > 0.f || boundsMax.y < 0.f) return false;
+    if(boundsMax.z < tMin || boundsMin.z > t) return false;
+
+    // Sous-carreau assez petit : presque plan, Newton converge depuis son centre
+    if(net.u1 - net.u0 <= BEZIER_PATCH_NEWTON_SIZE && net.v1 - net.v0 <= BEZIER_PATCH_NEWTON_SIZE)
+        return newton(frame, net, tMin, t, u, v);
+
+    Net first, second;
+    if(net.u1 - net.u0 >= net.v1 - net.v0) splitU(net, first, second);
+    else splitV(net, first, second);
+
+    // La moitié la plus proche d'abord : la seconde est souvent rejetée par la distance trouvée
+    float firstDistance = first.p[0][0].z + first.p[m_orderU - 1][m_orderV - 1].z;
+    float secondDistance = second.p[0][0].z + second.p[m_orderU - 1][m_orderV - 1].z;
+    if(secondDistance < firstDistance) std::swap(first, second);
+
+    bool hit = search(frame, first, tMin, t, u, v);
+    hit |= search(frame, second, tMin, t, u, v);
+    return hit;
+}
+
+
+bool BezierPatch::newton(const RayFrame &frame, const Net &net, float tMin, float &t, float &u,
+    float &v) const
+{
+    float pu = 0.5f * (net.u0 + net.u1);
+    float pv = 0.5f * (net.v0 + net.v1);
+    glm::vec3 S, Su, Sv;
+
+    for(int step = 0; step < BEZIER_PATCH_NEWTON_STEPS; ++step)
+    {
+        // F(u, v) = position de S(u, v) dans les deux plans du rayon, nulle sur le rayon
+        S = evaluate(pu, pv, &Su, &Sv) - frame.origin;
+        float f1 = glm::dot(S, frame.n1);
+        float f2 = glm::dot(S, frame.n2);
+
+        float a = glm::dot(Su, frame.n1), b = glm::dot(Sv, frame.n1);
+        float c = glm::dot(Su, frame.n2), d = glm::dot(Sv, frame.n2);
+        float det = a * d - b * c;
+        if(det == 0.f) return false;
+
+        float du = (d * f1 - b * f2) / det;
+        float dv = (a * f2 - c * f1) / det;
+        pu -= du;
+        pv -= dv;
+
+        if(std::fabs(du) < 1e-7f && std::fabs(dv) < 1e-7f) break;
+    }
+
+    // La racine doit être sur le carreau et dans le sous-carreau (sinon un voisin la trouvera)
+    float margin = 0.5f * BEZIER_PATCH_NEWTON_SIZE;
+    if(pu < std::max(0.f, net.u0 - margin) || pu > std::min(1.f, net.u1 + margin)) return false;
+    if(pv < std::max(0.f, net.v0 - margin) || pv > std::min(1.f, net.v1 + margin)) return false;
+
+    S = evaluate(pu, pv) - frame.origin;
+    float scale = std::max(glm::length(S), 1.f);
+    if(std::fabs(glm::dot(S, frame.n1)) > 1e-4f * scale || std::fabs(glm::dot(S, frame.n2)) > 1e-4f * scale)
+        return false;
+
+    float distance = glm::dot(S, frame.direction) / glm::dot(frame.direction, frame.direction);
+    if(distance < tMin || distance >= t) return false;
+
+    t = distance;
+    u = pu;
+    v = pv;
+    return true;
+}
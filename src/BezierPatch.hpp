@@ -0,0 +1,105 @@
+#ifndef BEZIER_PATCH_HPP
+#define BEZIER_PATCH_HPP
+
+/**
+ * @file BezierPatch.hpp
+ * @brief Définition de la classe BezierPatch.
+ * 
+ * Ce fichier contient l'intersection directe d'un rayon avec un carreau de Bézier, sans passer par
+ * sa discrétisation en triangles.
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#define BEZIER_PATCH_MAX_ORDER 8           // Nombre maximal de points de contrôle par direction
+#define BEZIER_PATCH_NEWTON_SIZE (1.f / 16) // Taille (paramétrique) des sous-carreaux où l'on passe à Newton
+#define BEZIER_PATCH_NEWTON_STEPS 8
+#define BEZIER_PATCH_EPSILON 0.00001f      // Distance minimale d'une intersection
+
+using ptsGrid = std::vector<std::vector<glm::vec3>>;
+
+
+/**
+ * @class BezierPatch
+ * @brief Carreau de Bézier réduit à ses points de contrôle, sans ressource OpenGL.
+ * 
+ * L'intersection projette le réseau de contrôle sur deux plans qui contiennent le rayon : le rayon
+ * devient l'origine du plan et le carreau est touché là où ses deux coordonnées projetées s'annulent.
+ * Le réseau est subdivisé (de Casteljau) en rejetant tout sous-carreau dont l'enveloppe convexe
+ * (approchée par sa boîte englobante) ne contient pas l'origine ou est plus loin que le meilleur
+ * point trouvé, puis quelques pas de Newton sur (u, v) donnent le point exact. Seuls les points de
+ * contrôle sont gardés : quelques centaines d'octets par carreau.
+ */
+class BezierPatch
+{
+public:
+
+    /**
+     * @brief Constructeur.
+     * @param controlPoints points de contrôle, controlPoints[i][j] avec i selon u et j selon v
+     * (même convention que BezierSurface).
+     */
+    BezierPatch(const ptsGrid &controlPoints);
+
+    /**
+     * @brief Renvoie true si le carreau peut être intersecté (au plus BEZIER_PATCH_MAX_ORDER points de
+     * contrôle par direction).
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Cherche le point du carreau le plus proche touché par le rayon.
+     * @param origin, direction rayon en coordonnées locales (direction non nécessairement normée).
+     * @param t en entrée, distance maximale ; en sortie, distance du point touché.
+     * @param u, v paramètres du point touché.
+     * @return true si le carreau a été touché avant t.
+     */
+    bool intersect(const glm::vec3 &origin, const glm::vec3 &direction, float &t, float &u,
+        float &v) const;
+
+    /**
+     * @brief Renvoie le point S(u, v) du carreau et ses dérivées partielles.
+     */
+    glm::vec3 evaluate(float u, float v, glm::vec3 *Su = nullptr, glm::vec3 *Sv = nullptr) const;
+
+    /**
+     * @brief Renvoie la normale (normée) au point S(u, v).
+     */
+    glm::vec3 normal(float u, float v) const;
+
+    /**
+     * @brief Renvoie la boîte englobante des points de contrôle (qui contient le carreau).
+     */
+    void getBounds(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const;
+
+private:
+    unsigned int m_orderU;
+    unsigned int m_orderV;
+    std::vector<glm::vec3> m_points; // m_points[i * m_orderV + j]
+
+    /**
+     * @brief Réseau de contrôle projeté dans le repère du rayon : (x, y) dans le plan orthogonal au
+     * rayon, z la distance le long du rayon.
+     */
+    typedef struct s_Net {
+        glm::vec3 p[BEZIER_PATCH_MAX_ORDER][BEZIER_PATCH_MAX_ORDER];
+        float u0, u1, v0, v1;
+    } Net;
+
+    typedef struct s_RayFrame {
+        glm::vec3 origin;
+        glm::vec3 direction;
+        glm::vec3 n1, n2; // Plans qui contiennent le rayon
+    } RayFrame;
+
+    void splitU(const Net &net, Net &left, Net &right) const;
+    void splitV(const Net &net, Net &left, Net &right) const;
+    bool search(const RayFrame &frame, const Net &net, float tMin, float &t, float &u, float &v) const;
+    bool newton(const RayFrame &frame, const Net &net, float tMin, float &t, float &u, float &v) const;
+};
+
+#endif // BEZIER_PATCH_HPP
@@ -2,6 +2,7 @@
 
 BezierSurface::BezierSurface(ptsGrid control_points) :
     m_controlPoints(control_points),
+    m_patch(std::make_shared<const BezierPatch>(control_points)),
     m_nbCurvePointsU(100),
     m_nbCurvePointsV(100)
 {
@@ -17,7 +18,15 @@ BezierSurface::BezierSurface(ptsGrid control_points) :
     m_nbVertices = tableEBO.size();
     updateVertices(tableVBO);
 
+    // Les triangles ne sont gardés pour le lancer de rayons que si le carreau ne peut pas être
+    // intersecté directement (trop de points de contrôle)
+    if(!m_patch->isValid()) setTriangles(tableVBO, tableEBO);
+    setTriangleIndexes(tableEBO);
+
     // Completing Object constructor with EBO init
+    EBO = 0;
+    if(!hasOpenGL()) return;
+
     glGenBuffers(1, &EBO);
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
@@ -47,6 +56,9 @@ glm::vec3 BezierSurface::surfaceValue(float u, float v)
 }
 
 
+std::shared_ptr<const BezierPatch> BezierSurface::getPatch() const {return m_patch;}
+
+
 void BezierSurface::draw(Shader shader)
 {
     glm::mat4 model = glm::translate(glm::mat4(1.0f), m_origin);
@@ -12,6 +12,7 @@
  * @date 2025-03-01
  */
 
+#include "BezierPatch.hpp"
 #include "Object.hpp"
 #include "utils.hpp"
 
@@ -38,8 +39,15 @@ public:
 
     void draw(Shader shader) override;
 
+    /**
+     * @brief Renvoie le carreau utilisé par le lancer de rayons (intersection directe, sans passer
+     * par la discrétisation affichée).
+     */
+    std::shared_ptr<const BezierPatch> getPatch() const;
+
 private:
     ptsGrid m_controlPoints;
+    std::shared_ptr<const BezierPatch> m_patch;
     unsigned int m_sizeU;
     unsigned int m_sizeV;
     unsigned int m_nbCurvePointsU;
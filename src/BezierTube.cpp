@@ -0,0 +1,244 @@
+#include "BezierTube.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+/**
+ * @brief Coupe une courbe de Bézier en deux au paramètre 1/2 (de Casteljau).
+ */
+static void splitCurve(const glm::vec3 *points, unsigned int order, glm::vec3 *left, glm::vec3 *right)
+{
+    glm::vec3 work[BEZIER_TUBE_MAX_ORDER];
+    std::copy(points, points + order, work);
+
+    for(unsigned int k = 0; k < order; ++k) {
+        left[k] = work[0];
+        right[order - 1 - k] = work[order - 1 - k];
+        for(unsigned int i = 0; i + k + 1 < order; ++i) work[i] = 0.5f * (work[i] + work[i + 1]);
+    }
+}
+
+
+/**
+ * @brief Boîte englobante des points de contrôle élargie du rayon du tube.
+ */
+static void tubeBounds(const glm::vec3 *points, unsigned int count, float radius, glm::vec3 &boundsMin,
+    glm::vec3 &boundsMax)
+{
+    boundsMin = boundsMax = points[0];
+    for(unsigned int i = 1; i < count; ++i) {
+        boundsMin = glm::min(boundsMin, points[i]);
+        boundsMax = glm::max(boundsMax, points[i]);
+    }
+    boundsMin -= glm::vec3(radius);
+    boundsMax += glm::vec3(radius);
+}
+
+
+/**
+ * @brief Test rayon / boîte (méthode des "slabs") sur [tMin; tMax].
+ */
+static bool hitBounds(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax, const glm::vec3 &origin,
+    const glm::vec3 &invDir, float tMax)
+{
+    glm::vec3 t0 = (boundsMin - origin) * invDir;
+    glm::vec3 t1 = (boundsMax - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+    return enter <= exit;
+}
+
+
+/**
+ * @brief Intersection rayon / capsule [a; b] de rayon radius (I. Quilez), direction normée.
+ * Renvoie la distance ou -1.
+ */
+static float hitCapsule(const glm::vec3 &origin, const glm::vec3 &direction, const glm::vec3 &a,
+    const glm::vec3 &b, float radius)
+{
+    glm::vec3 ba = b - a;
+    glm::vec3 oa = origin - a;
+    float baba = glm::dot(ba, ba);
+    float bard = glm::dot(ba, direction);
+    float baoa = glm::dot(ba, oa);
+    float rdoa = glm::dot(direction, oa);
+    float oaoa = glm::dot(oa, oa);
+
+    // Cylindre infini d'axe (ab)
+    float qa = baba - bard * bard;
+    float qb = baba * rdoa - baoa * bard;
+    float qc = baba * oaoa - baoa * baoa - radius * radius * baba;
+    float h = qb * qb - qa * qc;
+    if(h < 0.0f) return -1.0f;
+
+    if(qa > 0.0f) {
+        float t = (-qb - std::sqrt(h)) / qa;
+        float y = baoa + t * bard;
+        if(y > 0.0f && y < baba) return t;
+    }
+
+    // Demi-sphères aux extrémités
+    float best = -1.0f;
+    for(const glm::vec3 *center : {&a, &b}) {
+        glm::vec3 oc = origin - *center;
+        float sb = glm::dot(direction, oc);
+        float sc = glm::dot(oc, oc) - radius * radius;
+        float sh = sb * sb - sc;
+        if(sh < 0.0f) continue;
+        float t = -sb - std::sqrt(sh);
+        if(t >= 0.0f && (best < 0.0f || t < best)) best = t;
+    }
+    return best;
+}
+
+
+BezierTube::BezierTube(const std::vector<glm::vec3> &controlPoints, float radius) :
+    m_order(controlPoints.size()),
+    m_radius(radius)
+{
+    if(!isValid()) return;
+
+    // Morceaux obtenus par coupes successives en deux : BEZIER_TUBE_SEGMENTS doit être une puissance de 2
+    m_segments = controlPoints;
+    for(unsigned int count = 1; count < BEZIER_TUBE_SEGMENTS; count *= 2) {
+        std::vector<glm::vec3> halves(2 * m_segments.size());
+        for(unsigned int s = 0; s < count; ++s) {
+            splitCurve(&m_segments[s * m_order], m_order, &halves[2 * s * m_order],
+                &halves[(2 * s + 1) * m_order]);
+        }
+        m_segments.swap(halves);
+    }
+
+    // Les morceaux se suivent le long de la courbe : couper leur liste en deux suffit à grouper
+    // des morceaux proches
+    m_nodes.reserve(2 * BEZIER_TUBE_SEGMENTS);
+    m_nodes.push_back(BVHNode());
+    buildNode(0, 0, BEZIER_TUBE_SEGMENTS);
+}
+
+
+void BezierTube::buildNode(unsigned int nodeIndex, unsigned int first, unsigned int count)
+{
+    glm::vec3 boundsMin, boundsMax;
+    tubeBounds(&m_segments[first * m_order], count * m_order, m_radius, boundsMin, boundsMax);
+    m_nodes[nodeIndex].boundsMin = boundsMin;
+    m_nodes[nodeIndex].boundsMax = boundsMax;
+
+    if(count == 1) {
+        m_nodes[nodeIndex].first = first;
+        m_nodes[nodeIndex].count = 1;
+        return;
+    }
+
+    unsigned int left = m_nodes.size();
+    m_nodes[nodeIndex].first = left;
+    m_nodes[nodeIndex].count = 0;
+    m_nodes.push_back(BVHNode());
+    m_nodes.push_back(BVHNode());
+
+    buildNode(left, first, count / 2);
+    buildNode(left + 1, first + count / 2, count - count / 2);
+}
+
+
+bool BezierTube::isValid() const
+{
+    return m_order >= 2 && m_order <= BEZIER_TUBE_MAX_ORDER;
+}
+
+
+float BezierTube::getRadius() const {return m_radius;}
+
+
+void BezierTube::getBounds(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const
+{
+    boundsMin = m_nodes.empty() ? glm::vec3(0.0f) : m_nodes[0].boundsMin;
+    boundsMax = m_nodes.empty() ? glm::vec3(0.0f) : m_nodes[0].boundsMax;
+}
+
+
+bool BezierTube::intersect(const glm::vec3 &origin, const glm::vec3 &direction, float &t,
+    glm::vec3 &normal) const
+{
+    if(m_nodes.empty()) return false;
+
+    // Le test des capsules suppose une direction normée : les distances sont converties à la fin
+    float length = glm::length(direction);
+    glm::vec3 dir = direction / length;
+    glm::vec3 invDir = 1.0f / dir;
+    float tMax = t * length;
+    bool hit = false;
+
+    unsigned int stack[BVH_STACK_SIZE];
+    unsigned int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while(stackSize > 0)
+    {
+        const BVHNode &node = m_nodes[stack[--stackSize]];
+        if(!hitBounds(node.boundsMin, node.boundsMax, origin, invDir, tMax)) continue;
+
+        if(node.count > 0) {
+            hit |= refine(&m_segments[node.first * m_order], 0, origin, dir, invDir, tMax, normal);
+        }
+        else {
+            stack[stackSize++] = node.first + 1;
+            stack[stackSize++] = node.first;
+        }
+    }
+
+    if(hit) t = tMax / length;
+    return hit;
+}
+
+
+bool BezierTube::refine(const glm::vec3 *points, unsigned int depth, const glm::vec3 &origin,
+    const glm::vec3 &direction, const glm::vec3 &invDir, float &t, glm::vec3 &normal) const
+{
+    glm::vec3 boundsMin, boundsMax;
+    tubeBounds(points, m_order, m_radius, boundsMin, boundsMax);
+    if(!hitBounds(boundsMin, boundsMax, origin, invDir, t)) return false;
+
+    // Morceau presque droit : ses points de contrôle sont proches de la corde
+    const glm::vec3 &a = points[0];
+    const glm::vec3 &b = points[m_order - 1];
+    glm::vec3 chord = b - a;
+    float chordLength2 = glm::dot(chord, chord);
+    float deviation2 = 0.0f;
+    for(unsigned int i = 1; i + 1 < m_order; ++i) {
+        glm::vec3 p = points[i] - a;
+        float along = (chordLength2 > 0.0f) ? glm::clamp(glm::dot(p, chord) / chordLength2, 0.0f, 1.0f) : 0.0f;
+        glm::vec3 offset = p - along * chord;
+        deviation2 = std::max(deviation2, glm::dot(offset, offset));
+    }
+
+    float tolerance = BEZIER_TUBE_FLATNESS * m_radius;
+    if(deviation2 <= tolerance * tolerance || depth >= BEZIER_TUBE_MAX_DEPTH) {
+        float d = hitCapsule(origin, direction, a, b, m_radius);
+        if(d < BEZIER_TUBE_EPSILON || d >= t) return false;
+
+        t = d;
+        glm::vec3 p = origin + d * direction;
+        float along = (chordLength2 > 0.0f) ? glm::clamp(glm::dot(p - a, chord) / chordLength2, 0.0f, 1.0f) : 0.0f;
+        normal = glm::normalize(p - (a + along * chord));
+        return true;
+    }
+
+    glm::vec3 left[BEZIER_TUBE_MAX_ORDER], right[BEZIER_TUBE_MAX_ORDER];
+    splitCurve(points, m_order, left, right);
+
+    // La moitié la plus proche de l'origine du rayon d'abord
+    bool leftFirst = glm::dot(left[0] + left[m_order - 1], direction) <=
+        glm::dot(right[0] + right[m_order - 1], direction);
+    const glm::vec3 *first = leftFirst ? left : right;
+    const glm::vec3 *second = leftFirst ? right : left;
+
+    bool hit = refine(first, depth + 1, origin, direction, invDir, t, normal);
+    hit |= refine(second, depth + 1, origin, direction, invDir, t, normal);
+    return hit;
+}
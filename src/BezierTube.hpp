@@ -0,0 +1,83 @@
+#ifndef BEZIER_TUBE_HPP
+#define BEZIER_TUBE_HPP
+
+/**
+ * @file BezierTube.hpp
+ * @brief Définition de la classe BezierTube.
+ * 
+ * Ce fichier contient l'intersection d'un rayon avec un tube de rayon fixe centré sur une courbe
+ * de Bézier, qui permet de cliquer sur les courbes et de les voir dans les captures.
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "BVHBuilder.hpp"
+#include "MeshBVH.hpp"
+
+#define BEZIER_TUBE_RADIUS 0.02f     // Rayon par défaut des tubes autour des courbes
+#define BEZIER_TUBE_MAX_ORDER 16     // Nombre maximal de points de contrôle
+#define BEZIER_TUBE_SEGMENTS 16      // Morceaux de courbe aux feuilles de la hiérarchie
+#define BEZIER_TUBE_FLATNESS 0.1f    // Écart toléré à la corde, en fraction du rayon
+#define BEZIER_TUBE_MAX_DEPTH 12     // Subdivisions maximales d'un morceau
+#define BEZIER_TUBE_EPSILON 0.00001f // Distance minimale d'une intersection
+
+
+/**
+ * @class BezierTube
+ * @brief Tube autour d'une courbe de Bézier, sans ressource OpenGL.
+ * 
+ * La courbe est découpée à la construction en BEZIER_TUBE_SEGMENTS morceaux (de Casteljau), rangés
+ * dans une petite hiérarchie de boîtes englobantes (leurs points de contrôle, élargis du rayon).
+ * Un rayon qui touche la boîte d'un morceau le subdivise, en commençant par la moitié la plus
+ * proche, jusqu'à ce que le morceau soit presque droit : le tube y est alors une capsule (cylindre
+ * fermé par deux demi-sphères) dont l'intersection est exacte.
+ */
+class BezierTube
+{
+public:
+
+    /**
+     * @brief Constructeur.
+     * @param controlPoints points de contrôle de la courbe.
+     * @param radius rayon du tube.
+     */
+    BezierTube(const std::vector<glm::vec3> &controlPoints, float radius = BEZIER_TUBE_RADIUS);
+
+    /**
+     * @brief Renvoie true si la courbe peut être intersectée (entre 2 et BEZIER_TUBE_MAX_ORDER
+     * points de contrôle).
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Cherche le point du tube le plus proche touché par le rayon.
+     * @param origin, direction rayon en coordonnées locales (direction non nécessairement normée).
+     * @param t en entrée, distance maximale ; en sortie, distance du point touché.
+     * @param normal normale (normée) au point touché.
+     * @return true si le tube a été touché avant t.
+     */
+    bool intersect(const glm::vec3 &origin, const glm::vec3 &direction, float &t, glm::vec3 &normal) const;
+
+    float getRadius() const;
+
+    /**
+     * @brief Renvoie la boîte englobante du tube.
+     */
+    void getBounds(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const;
+
+private:
+    unsigned int m_order;
+    float m_radius;
+    std::vector<glm::vec3> m_segments; // Points de contrôle des morceaux, m_order par morceau
+    std::vector<BVHNode> m_nodes;
+
+    void buildNode(unsigned int nodeIndex, unsigned int first, unsigned int count);
+    bool refine(const glm::vec3 *points, unsigned int depth, const glm::vec3 &origin,
+        const glm::vec3 &direction, const glm::vec3 &invDir, float &t, glm::vec3 &normal) const;
+};
+
+#endif // BEZIER_TUBE_HPP
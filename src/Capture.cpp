@@ -0,0 +1,61 @@
+#include "Capture.hpp"
+
+
+void Capture::applyPNGPreset(lodepng::State &state, unsigned int preset)
+{
+    LodePNGCompressSettings &zlib = state.encoder.zlibsettings;
+    zlib.numthreads = CAPTURE_COMPRESSION_THREADS;
+
+    switch(preset)
+    {
+    case PNG_PRESET_STORE:
+        zlib.btype = 0;
+        state.encoder.filter_strategy = LFS_ZERO;
+        state.encoder.auto_convert = 0;
+        break;
+
+    case PNG_PRESET_HUFFMAN:
+        zlib.use_lz77 = 0;
+        state.encoder.filter_strategy = LFS_TWO;
+        state.encoder.auto_convert = 0;
+        break;
+
+    case PNG_PRESET_RLE:
+        zlib.windowsize = 1; // Uniquement des répétitions de l'octet précédent
+        zlib.nicematch = 258;
+        zlib.lazymatching = 0;
+        state.encoder.filter_strategy = LFS_TWO;
+        state.encoder.auto_convert = 0;
+        break;
+
+    case PNG_PRESET_FAST:
+        zlib.windowsize = 512;
+        zlib.nicematch = 16;
+        zlib.lazymatching = 0;
+        state.encoder.filter_strategy = LFS_TWO;
+        state.encoder.auto_convert = 0;
+        break;
+
+    case PNG_PRESET_BEST:
+        zlib.windowsize = 32768;
+        zlib.nicematch = 258;
+        state.encoder.filter_strategy = LFS_ENTROPY;
+        break;
+
+    default: // PNG_PRESET_DEFAULT
+        break;
+    }
+}
+
+
+unsigned Capture::savePNG(const std::string &filename, const std::vector<unsigned char> &image,
+    unsigned int width, unsigned int height, unsigned int preset)
+{
+    lodepng::State state;
+    applyPNGPreset(state, preset);
+
+    std::vector<unsigned char> png;
+    unsigned error = lodepng::encode(png, image, width, height, state);
+    if(!error) error = lodepng::save_file(png, filename);
+    return error;
+}
@@ -0,0 +1,63 @@
+#ifndef CAPTURE_HPP
+#define CAPTURE_HPP
+
+/**
+ * @file Capture.hpp
+ * @brief Définition de la classe Capture.
+ * 
+ * Ce fichier contient les réglages d'encodage des captures d'écran calculées par lancer de rayons.
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <string>
+#include <vector>
+
+#include "lodepng.h"
+
+#define CAPTURE_COMPRESSION_THREADS 0 // 0 = un thread de compression par coeur
+
+/*
+ * Préréglages d'encodage PNG, du plus rapide au plus compact.
+ * Mesures : un seul thread, -O2, sur deux images 3840x2160 (agrandissements de screen_capture.png,
+ * aplats de couleurs, et de screenshot.png, rendu ombré). Débit en octets de pixels RGBA bruts par
+ * seconde, taille en pourcentage de ces pixels bruts.
+ */
+#define PNG_PRESET_STORE 0   // Aucune compression           : 135-160 Mo/s, 100 %
+#define PNG_PRESET_HUFFMAN 1 // Huffman seul, filtre "Up"    : 95-105 Mo/s,  12.5-13.2 %
+#define PNG_PRESET_RLE 2     // Répétitions seules (RLE)     : 480-600 Mo/s, 0.19-1.27 %
+#define PNG_PRESET_FAST 3    // LZ77 fenêtre 512, non lazy   : 165-175 Mo/s, 0.14-0.31 %
+#define PNG_PRESET_DEFAULT 4 // Réglages par défaut lodepng  : 60-135 Mo/s,  0.03-0.29 %
+#define PNG_PRESET_BEST 5    // Fenêtre 32K, filtre entropie : 15-60 Mo/s,   0.02-0.27 %
+
+
+/**
+ * @class Capture
+ * @brief Fonctions d'encodage des captures d'écran.
+ * 
+ * Les préréglages rapides désactivent la recherche du meilleur filtre par ligne et la conversion
+ * automatique de couleurs (le PNG reste en RGBA 8 bits), qui coûtent plus cher que la compression
+ * elle-même sur les images simples produites par le lancer de rayons.
+ */
+class Capture
+{
+public:
+
+    /**
+     * @brief Applique un préréglage PNG_PRESET_* aux réglages de l'encodeur. Un préréglage inconnu
+     * laisse les réglages par défaut de lodepng.
+     * @param state état lodepng à configurer.
+     * @param preset préréglage à appliquer.
+     */
+    static void applyPNGPreset(lodepng::State &state, unsigned int preset);
+
+    /**
+     * @brief Encode une image RGBA 8 bits en PNG avec le préréglage donné et l'enregistre.
+     * @return le code d'erreur lodepng (0 si tout s'est bien passé).
+     */
+    static unsigned savePNG(const std::string &filename, const std::vector<unsigned char> &image,
+        unsigned int width, unsigned int height, unsigned int preset);
+};
+
+#endif // CAPTURE_HPP
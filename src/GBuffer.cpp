@@ -0,0 +1,371 @@
+#include "GBuffer.hpp"
+#include "Parallel.hpp"
+#include "TriangleIntersection.hpp"
+#include "WavefrontTracer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+
+/**
+ * @brief Renvoie true si le segment [origin; origin + tMax * direction] traverse la boîte.
+ */
+static bool segmentCrossesBox(const glm::vec3 &origin, const glm::vec3 &direction, float tMax,
+    const glm::vec3 &boxMin, const glm::vec3 &boxMax)
+{
+    float t0 = 0.0f, t1 = tMax;
+    for(int axis = 0; axis < 3; ++axis) {
+        // Direction nulle sur un axe : divisions infinies, les comparaisons restent prudentes
+        float inverse = 1.0f / direction[axis];
+        float tNear = (boxMin[axis] - origin[axis]) * inverse;
+        float tFar = (boxMax[axis] - origin[axis]) * inverse;
+        if(tNear > tFar) std::swap(tNear, tFar);
+        t0 = std::max(t0, tNear);
+        t1 = std::min(t1, tFar);
+        if(t0 > t1) return false;
+    }
+    return true;
+}
+
+
+GBuffer::GBuffer() :
+    m_valid(false),
+    m_geometryVersion(0),
+    m_causticsVersion(0),
+    m_light(nullptr),
+    m_lightPosition(0.0f),
+    m_vertices(0),
+    m_rasterShapes(false)
+{}
+
+
+GBufferStats GBuffer::render(const TraceScene &scene, const TraceCamera &camera, float* radiance)
+{
+    auto start = std::chrono::steady_clock::now();
+    unsigned int width = camera.getWidth();
+    unsigned int height = camera.getHeight();
+    GBufferStats stats = {(size_t)width * height, 0, 0, 0, 0, 0.0};
+
+    // Chemins aléatoires ou plusieurs échantillons par pixel : rien à réutiliser d'une capture à l'autre
+    if(scene.getIntegrator() != TRACE_INTEGRATOR_MIRROR || scene.getSamples() != 1) {
+        invalidate();
+        WavefrontTracer tracer(scene);
+        tracer.renderRows(camera, 0, height, radiance);
+        stats.tracedPixels = stats.pixels;
+        stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+
+    bool full = !m_valid || !m_camera->sameView(camera) || m_geometryVersion != scene.getGeometryVersion();
+    if(full) {
+        m_camera = std::make_unique<TraceCamera>(camera);
+        m_geometryVersion = scene.getGeometryVersion();
+        m_vertices = scene.getBounces() + 1;
+
+        size_t count = stats.pixels * m_vertices;
+        m_instance.resize(count);
+        m_distance.resize(count);
+        m_direction.resize(count);
+        m_normal.resize(count);
+        m_shadow.resize(count);
+        m_uv.resize(stats.pixels);
+    }
+
+    // Les pixels relancés plus tard (objets déplacés) ne se servent plus de la rastérisation
+    bool raster = full && scene.getPrimary() == TRACE_PRIMARY_RASTER;
+    if(raster) rasterize(scene);
+
+    // Anciennes et nouvelles boîtes des instances déplacées, un peu agrandies pour les points de leur
+    // bord. Celles de la lumière viennent en dernier : elle n'arrête pas les rayons d'ombre
+    std::vector<glm::vec3> boxes;
+    std::vector<glm::vec3> lightBoxes;
+    for(unsigned int i = 0; !full && i < scene.getInstanceCount(); ++i) {
+        const TraceInstance &instance = scene.getInstance(i);
+        if(instance.origin == m_origins[i]) continue;
+        std::vector<glm::vec3> &moved = (instance.object == scene.getLight()) ? lightBoxes : boxes;
+        for(glm::vec3 origin : {m_origins[i], instance.origin}) {
+            moved.push_back(origin + instance.localMin - glm::vec3(TRACE_RAY_EPSILON));
+            moved.push_back(origin + instance.localMax + glm::vec3(TRACE_RAY_EPSILON));
+        }
+    }
+    size_t shadowBoxes = boxes.size();
+    boxes.insert(boxes.end(), lightBoxes.begin(), lightBoxes.end());
+
+    bool lightMoved = !full && (scene.getLight() != m_light || scene.getLightPosition() != m_lightPosition);
+    bool caustics = !scene.getCaustics().empty();
+    bool regather = !full && caustics && scene.getCausticsVersion() != m_causticsVersion;
+    if(!caustics) m_caustics.clear();
+    else if(m_caustics.size() != stats.pixels * m_vertices) {
+        m_caustics.assign(stats.pixels * m_vertices, glm::vec3(0.0f));
+        regather = !full;
+    }
+
+    // Chaque ligne compte ce qu'elle a relancé, les threads n'écrivent jamais dans le même pixel
+    std::vector<GBufferStats> rows(height, GBufferStats{0, 0, 0, 0, 0, 0.0});
+    parallelFor(0, height, [&](size_t y) {
+        GBufferStats &row = rows[y];
+        for(unsigned int x = 0; x < width; ++x)
+        {
+            size_t pixel = y * width + x;
+
+            if(full || (!boxes.empty() && crosses(pixel, boxes, shadowBoxes))) {
+                row.rasterPixels += tracePixel(scene, x, y, raster);
+                row.tracedPixels++;
+            }
+            else {
+                for(unsigned int bounce = 0; bounce < m_vertices; ++bounce) {
+                    size_t index = pixel * m_vertices + bounce;
+                    if(m_instance[index] == TRACE_MISS) break;
+
+                    if(lightMoved) {
+                        traceShadow(scene, index, bounce);
+                        row.shadowRays += (m_shadow[index] != GBUFFER_SHADOW_NONE);
+                    }
+                    if(regather) {
+                        glm::vec3 point = rayOrigin(index, bounce) + m_distance[index] * m_direction[index];
+                        m_caustics[index] = scene.getCaustics().irradiance(point, m_normal[index],
+                            TRACE_PHOTON_GATHER, TRACE_PHOTON_RADIUS);
+                        row.gathers++;
+                    }
+                }
+            }
+
+            glm::vec3 color = shadePixel(scene, pixel);
+            radiance[3 * pixel] = color.x;
+            radiance[3 * pixel + 1] = color.y;
+            radiance[3 * pixel + 2] = color.z;
+        }
+    });
+
+    for(const GBufferStats &row : rows) {
+        stats.tracedPixels += row.tracedPixels;
+        stats.rasterPixels += row.rasterPixels;
+        stats.shadowRays += row.shadowRays;
+        stats.gathers += row.gathers;
+    }
+
+    m_origins.resize(scene.getInstanceCount());
+    for(unsigned int i = 0; i < scene.getInstanceCount(); ++i) m_origins[i] = scene.getInstance(i).origin;
+    m_light = scene.getLight();
+    m_lightPosition = scene.getLightPosition();
+    m_causticsVersion = scene.getCausticsVersion();
+    m_valid = true;
+
+    stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+
+void GBuffer::invalidate()
+{
+    m_valid = false;
+}
+
+
+bool GBuffer::isValid() const {return m_valid;}
+unsigned int GBuffer::getWidth() const {return m_valid ? m_camera->getWidth() : 0;}
+unsigned int GBuffer::getHeight() const {return m_valid ? m_camera->getHeight() : 0;}
+unsigned int GBuffer::getInstance(unsigned int x, unsigned int y) const {return m_instance[vertex(x, y)];}
+float GBuffer::getDepth(unsigned int x, unsigned int y) const {return m_distance[vertex(x, y)];}
+glm::vec3 GBuffer::getNormal(unsigned int x, unsigned int y) const {return m_normal[vertex(x, y)];}
+glm::vec2 GBuffer::getUV(unsigned int x, unsigned int y) const {return m_uv[y * m_camera->getWidth() + x];}
+
+
+void GBuffer::printStats(const std::string &name, const GBufferStats &stats)
+{
+    std::cout << "G-buffer " << name << " : " << stats.tracedPixels << " pixels relances sur " << stats.pixels
+        << " (" << stats.rasterPixels << " rasterises), " << stats.shadowRays << " rayons d'ombre, " << stats.gathers
+        << " estimations des caustiques, " << stats.milliseconds << " ms" << std::endl;
+}
+
+
+size_t GBuffer::vertex(unsigned int x, unsigned int y) const
+{
+    return ((size_t)y * m_camera->getWidth() + x) * m_vertices;
+}
+
+
+glm::vec3 GBuffer::rayOrigin(size_t index, unsigned int bounce) const
+{
+    // Chaque rayon réfléchi part du point précédent, décalé le long de sa normale
+    glm::vec3 origin = m_camera->getPosition();
+    for(size_t i = index - bounce; i < index; ++i)
+        origin = origin + m_distance[i] * m_direction[i] + TRACE_RAY_EPSILON * m_normal[i];
+    return origin;
+}
+
+
+void GBuffer::rasterize(const TraceScene &scene)
+{
+    m_raster.begin(m_camera->getWidth(), m_camera->getHeight(), m_camera->getViewProjection());
+    m_rasterShapes = false;
+
+    for(unsigned int i = 0; i < scene.getInstanceCount(); ++i)
+    {
+        const MeshBVH* mesh = scene.getMesh(i);
+        if(mesh == nullptr) {
+            m_rasterShapes = true;
+            continue;
+        }
+
+        // Triangles tels que les voit MeshBVH (éventuellement compressés), placés à l'origine
+        glm::vec3 origin = scene.getInstance(i).origin;
+        for(unsigned int primitive = 0; primitive < mesh->getTriangleCount(); ++primitive) {
+            Triangle triangle = mesh->getTriangle(primitive);
+            m_raster.addTriangle(triangle.a + origin, triangle.b + origin, triangle.c + origin, i, primitive);
+        }
+    }
+
+    m_raster.rasterize();
+}
+
+
+bool GBuffer::primaryHit(const TraceScene &scene, const TraceRay &ray, unsigned int x, unsigned int y,
+    TraceHit &hit, bool &rasterized) const
+{
+    rasterized = false;
+    unsigned int id = m_raster.getId(x, y);
+
+    // Au bord d'un objet, l'échantillon peut être sur une arête : le rayon décide
+    unsigned int width = m_raster.getWidth();
+    unsigned int height = m_raster.getHeight();
+    if((x > 0 && m_raster.getId(x - 1, y) != id) || (x + 1 < width && m_raster.getId(x + 1, y) != id)
+        || (y > 0 && m_raster.getId(x, y - 1) != id) || (y + 1 < height && m_raster.getId(x, y + 1) != id))
+        return scene.intersect(ray, hit);
+
+    bool found = false;
+    if(id != RASTER_NO_ID) {
+        // Même test que MeshBVH::intersect() sur le seul triangle rastérisé
+        const TraceInstance &instance = scene.getInstance(id);
+        const MeshBVH* mesh = scene.getMesh(id);
+        unsigned int primitive = m_raster.getPrimitive(x, y);
+        glm::vec3 origin = ray.origin - instance.origin;
+        float t = hit.t, u, v;
+        if(!TriangleIntersection::intersect(TriangleIntersection::prepare(origin, ray.direction),
+            mesh->getTriangle(primitive), BVH_EPSILON, t, u, v))
+            return scene.intersect(ray, hit);
+
+        // Un maillage replié peut se cacher lui-même sans changer d'identifiant autour du pixel : si
+        // un de ses triangles est touché avant, le rayon décide
+        if(mesh->occluded(origin, ray.direction, t)) return scene.intersect(ray, hit);
+
+        hit.t = t;
+        hit.instance = id;
+        hit.primitive = primitive;
+        found = true;
+    }
+
+    rasterized = true;
+    if(m_rasterShapes) found |= scene.intersect(ray, hit, false);
+    return found;
+}
+
+
+bool GBuffer::tracePixel(const TraceScene &scene, unsigned int x, unsigned int y, bool raster)
+{
+    size_t first = vertex(x, y);
+    TraceRay ray = scene.cameraRay(*m_camera, x, y, 0);
+    m_uv[first / m_vertices] = glm::vec2(0.0f);
+    bool rasterized = false;
+
+    // Mêmes rayons que TraceScene::traceColor()
+    for(unsigned int bounce = 0; bounce < m_vertices; ++bounce)
+    {
+        size_t index = first + bounce;
+        TraceHit hit = TraceScene::emptyHit();
+        m_direction[index] = ray.direction;
+
+        bool found = (raster && bounce == 0) ? primaryHit(scene, ray, x, y, hit, rasterized) : scene.intersect(ray, hit);
+        if(!found) {
+            std::fill(m_instance.begin() + index, m_instance.begin() + first + m_vertices, TRACE_MISS);
+            m_distance[index] = hit.t;
+            return rasterized;
+        }
+
+        glm::vec3 normal = scene.hitNormal(ray, hit);
+        if(glm::dot(normal, ray.direction) > 0.0f) normal = -normal;
+        m_instance[index] = hit.instance;
+        m_distance[index] = hit.t;
+        m_normal[index] = normal;
+        if(bounce == 0) m_uv[first / m_vertices] = glm::vec2(hit.u, hit.v);
+
+        glm::vec3 irradiance;
+        if(!m_caustics.empty() && scene.caustics(ray, hit, irradiance)) m_caustics[index] = irradiance;
+
+        TraceRay shadow;
+        float distance;
+        m_shadow[index] = GBUFFER_SHADOW_NONE;
+        if(scene.shadowRay(ray, hit, shadow, distance))
+            m_shadow[index] = scene.occluded(shadow, distance) ? GBUFFER_SHADOW_BLOCKED : GBUFFER_SHADOW_LIT;
+
+        ray = scene.reflect(ray, hit);
+    }
+    return rasterized;
+}
+
+
+void GBuffer::traceShadow(const TraceScene &scene, size_t index, unsigned int bounce)
+{
+    TraceRay ray = {rayOrigin(index, bounce), m_direction[index]};
+    TraceHit hit = TraceScene::emptyHit();
+    hit.t = m_distance[index];
+    hit.instance = m_instance[index];
+
+    TraceRay shadow;
+    float distance;
+    m_shadow[index] = GBUFFER_SHADOW_NONE;
+    if(scene.shadowRay(ray, hit, shadow, distance))
+        m_shadow[index] = scene.occluded(shadow, distance) ? GBUFFER_SHADOW_BLOCKED : GBUFFER_SHADOW_LIT;
+}
+
+
+bool GBuffer::crosses(size_t pixel, const std::vector<glm::vec3> &boxes, size_t shadowBoxes) const
+{
+    glm::vec3 origin = m_camera->getPosition();
+
+    for(unsigned int bounce = 0; bounce < m_vertices; ++bounce)
+    {
+        size_t index = pixel * m_vertices + bounce;
+        const glm::vec3 &direction = m_direction[index];
+        float distance = m_distance[index];
+        glm::vec3 point = origin + distance * direction;
+
+        for(size_t box = 0; box < boxes.size(); box += 2) {
+            if(segmentCrossesBox(origin, direction, distance, boxes[box], boxes[box + 1])) return true;
+            if(box < shadowBoxes && m_instance[index] != TRACE_MISS && m_shadow[index] != GBUFFER_SHADOW_NONE
+                && segmentCrossesBox(point, m_lightPosition - point, 1.0f, boxes[box], boxes[box + 1])) return true;
+        }
+
+        // Un rayon qui ne touche rien n'a pas de suite
+        if(m_instance[index] == TRACE_MISS) return false;
+        origin = point + TRACE_RAY_EPSILON * m_normal[index];
+    }
+    return false;
+}
+
+
+glm::vec3 GBuffer::shadePixel(const TraceScene &scene, size_t pixel) const
+{
+    // Même somme, dans le même ordre, que TraceScene::traceColor()
+    glm::vec3 radiance(0.0f);
+    float throughput = 1.0f;
+    unsigned int bounces = m_vertices - 1;
+
+    for(unsigned int bounce = 0; ; ++bounce)
+    {
+        size_t index = pixel * m_vertices + bounce;
+        if(m_instance[index] == TRACE_MISS) return radiance + throughput * scene.getBackgroundColor();
+
+        const TraceInstance &instance = scene.getInstance(m_instance[index]);
+        float weight = (bounce == bounces) ? throughput : throughput * (1.0f - TRACE_REFLECTANCE);
+        if(!m_caustics.empty()) radiance += weight * instance.color * m_caustics[index];
+
+        glm::vec3 color = weight * instance.color;
+        if(m_shadow[index] == GBUFFER_SHADOW_BLOCKED) color *= scene.getShadowFactor();
+        radiance += color;
+
+        if(bounce == bounces) return radiance;
+        throughput *= TRACE_REFLECTANCE;
+    }
+}
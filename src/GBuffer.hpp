@@ -0,0 +1,188 @@
+#ifndef GBUFFER_HPP
+#define GBUFFER_HPP
+
+/**
+ * @file GBuffer.hpp
+ * @brief Définition de la classe GBuffer.
+ *
+ * Ce fichier contient le cache des captures d'écran : les points touchés par les rayons de la
+ * dernière capture, qui permettent de recalculer les couleurs de la suivante sans relancer de
+ * rayons quand seule l'apparence des objets a changé.
+ *
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Rasterizer.hpp"
+#include "TraceScene.hpp"
+
+#define GBUFFER_SHADOW_NONE 0    // Pas de rayon d'ombre (ombres inactives, point de la lumière)
+#define GBUFFER_SHADOW_LIT 1     // Rayon d'ombre arrivé jusqu'à la lumière
+#define GBUFFER_SHADOW_BLOCKED 2 // Rayon d'ombre arrêté avant la lumière
+
+
+/**
+ * @brief Bilan d'une capture calculée par GBuffer::render().
+ */
+typedef struct s_GBufferStats {
+    size_t pixels;        // Pixels de l'image
+    size_t tracedPixels;  // Pixels dont le chemin a été relancé (rayon primaire et reflets)
+    size_t rasterPixels;  // Parmi eux, pixels dont le point vu vient de la rastérisation
+    size_t shadowRays;    // Rayons d'ombre relancés seuls, depuis les points gardés
+    size_t gathers;       // Éclairements des caustiques recalculés, sans rayon
+    double milliseconds;
+} GBufferStats;
+
+
+/**
+ * @class GBuffer
+ * @brief Garde, pour chaque pixel de la dernière capture, le chemin suivi par
+ * TraceScene::traceColor() : instance touchée, distance, normale, direction et ombre de chaque
+ * point, plus les paramètres (u, v) du point primaire.
+ *
+ * La couleur d'un pixel est une somme des couleurs des instances de son chemin, avec des poids qui
+ * ne dépendent que des rebonds : tant que la caméra (TraceCamera::sameView()) et la géométrie
+ * (TraceScene::getGeometryVersion()) n'ont pas changé, render() recalcule l'image à partir du cache
+ * seul, sans lancer de rayon. Sinon :
+ * - si des objets ont bougé, seuls les pixels dont un segment du chemin (rayon primaire, reflets,
+ *   rayons d'ombre) traverse l'ancienne ou la nouvelle boîte d'un objet déplacé sont relancés. Pour
+ *   le rayon primaire, c'est la zone de l'écran couverte par la projection de ces boîtes. Les autres
+ *   chemins ne peuvent pas avoir changé ;
+ * - si la lumière a bougé, seuls les rayons d'ombre des points gardés sont relancés ;
+ * - si la carte des caustiques a été reconstruite, leur éclairement est recalculé en chaque point.
+ *
+ * Avec TRACE_PRIMARY_RASTER (cf. TraceScene::getPrimary()), les maillages sont rastérisés à chaque
+ * capture complète (cf. Rasterizer) : le triangle vu en chaque pixel est vérifié par un test rayon /
+ * triangle, qui donne la même distance que le rayon primaire, puis par une recherche limitée à cette
+ * distance dans le même maillage, qui s'arrête au premier triangle touché avant (un maillage replié
+ * qui se cache lui-même) : le rayon primaire est alors lancé. Les pixels au bord d'un objet (un
+ * voisin voit une autre instance ou rien), trop près d'une arête pour que les deux calculs soient
+ * sûrs de donner le même triangle, lancent aussi leur rayon primaire. Les objets qui ne
+ * sont pas des maillages (sphères, carreaux et tubes) sont toujours cherchés par un rayon, limité
+ * au point rastérisé. Les reflets et les rayons d'ombre partent ensuite des points trouvés.
+ *
+ * Seul l'intégrateur TRACE_INTEGRATOR_MIRROR à un échantillon par pixel donne des chemins fixes :
+ * les autres captures passent par WavefrontTracer et vident le cache.
+ */
+class GBuffer
+{
+public:
+
+    GBuffer();
+
+    /**
+     * @brief Calcule la radiance linéaire (RGB flottant) de toute l'image de camera dans radiance,
+     * comme Intersection::rayRenderRows(), en réutilisant le cache de la capture précédente.
+     */
+    GBufferStats render(const TraceScene &scene, const TraceCamera &camera, float* radiance);
+
+    /**
+     * @brief Vide le cache : la prochaine capture relance tous les rayons.
+     */
+    void invalidate();
+
+    bool isValid() const;
+    unsigned int getWidth() const;
+    unsigned int getHeight() const;
+
+    /**
+     * @brief Renvoie l'instance touchée par le rayon primaire du pixel (x, y) (cf.
+     * TraceScene::getInstance()), TRACE_MISS si le rayon ne touche rien.
+     */
+    unsigned int getInstance(unsigned int x, unsigned int y) const;
+
+    /**
+     * @brief Renvoie la distance du point primaire à la caméra, le long du rayon du pixel.
+     */
+    float getDepth(unsigned int x, unsigned int y) const;
+
+    /**
+     * @brief Renvoie la normale au point primaire, tournée vers la caméra.
+     */
+    glm::vec3 getNormal(unsigned int x, unsigned int y) const;
+
+    /**
+     * @brief Renvoie les paramètres du point primaire sur un carreau de Bézier (0 sinon).
+     */
+    glm::vec2 getUV(unsigned int x, unsigned int y) const;
+
+    /**
+     * @brief Affiche un bilan dans le terminal.
+     */
+    static void printStats(const std::string &name, const GBufferStats &stats);
+
+private:
+    bool m_valid;
+    std::unique_ptr<TraceCamera> m_camera;
+    unsigned int m_geometryVersion;
+    unsigned int m_causticsVersion;
+    const Object* m_light;
+    glm::vec3 m_lightPosition;
+    std::vector<glm::vec3> m_origins; // Origine de chaque instance à la dernière capture
+    unsigned int m_vertices;          // Points gardés par pixel : rebonds + 1
+
+    // Un élément par point gardé (pixel * m_vertices + rebond), rangés par composante
+    std::vector<unsigned int> m_instance; // TRACE_MISS pour un rayon qui ne touche rien et la suite
+    std::vector<float> m_distance;        // Distance en multiples de m_direction
+    std::vector<glm::vec3> m_direction;   // Direction du rayon qui arrive au point
+    std::vector<glm::vec3> m_normal;      // Normale tournée vers le rayon
+    std::vector<unsigned char> m_shadow;  // GBUFFER_SHADOW_*
+    std::vector<glm::vec3> m_caustics;    // Éclairement des caustiques, vide sans carte de photons
+
+    std::vector<glm::vec2> m_uv; // Un élément par pixel
+
+    Rasterizer m_raster;  // Maillages de la dernière capture complète avec TRACE_PRIMARY_RASTER
+    bool m_rasterShapes;  // La scène a aussi des instances qui ne sont pas des maillages
+
+    size_t vertex(unsigned int x, unsigned int y) const;
+
+    /**
+     * @brief Renvoie l'origine du rayon qui arrive au point index (même calcul que TraceScene::reflect()).
+     */
+    glm::vec3 rayOrigin(size_t index, unsigned int bounce) const;
+
+    /**
+     * @brief Rastérise les maillages de la scène vus par m_camera.
+     */
+    void rasterize(const TraceScene &scene);
+
+    /**
+     * @brief Cherche le point vu par le rayon primaire du pixel (x, y) à partir de m_raster, comme
+     * TraceScene::intersect().
+     * @param rasterized reçoit false si le rayon primaire a dû être lancé.
+     */
+    bool primaryHit(const TraceScene &scene, const TraceRay &ray, unsigned int x, unsigned int y,
+        TraceHit &hit, bool &rasterized) const;
+
+    /**
+     * @brief Suit le chemin du pixel et remplace ses points gardés.
+     * @param raster prendre le point vu dans m_raster plutôt que lancer le rayon primaire.
+     * @return true si le point vu vient de la rastérisation.
+     */
+    bool tracePixel(const TraceScene &scene, unsigned int x, unsigned int y, bool raster);
+
+    /**
+     * @brief Relance le rayon d'ombre du point gardé index vers la position actuelle de la lumière.
+     */
+    void traceShadow(const TraceScene &scene, size_t index, unsigned int bounce);
+
+    /**
+     * @brief Renvoie true si un segment du chemin du pixel traverse une des boîtes (deux coins
+     * consécutifs par boîte). Les rayons d'ombre ne sont testés qu'avec les shadowBoxes premières
+     * valeurs de boxes.
+     */
+    bool crosses(size_t pixel, const std::vector<glm::vec3> &boxes, size_t shadowBoxes) const;
+
+    /**
+     * @brief Calcule la couleur du pixel à partir de ses points gardés (même somme que
+     * TraceScene::traceColor()).
+     */
+    glm::vec3 shadePixel(const TraceScene &scene, size_t pixel) const;
+};
+
+#endif // GBUFFER_HPP
@@ -1,4 +1,9 @@
 #include "Intersections.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 bool Intersection::Ray_Sphere(const Ray &ray, const Sphere &sphere, Ray &reflexion)
 {
@@ -32,43 +37,183 @@ bool Intersection::Ray_Sphere(const Ray &ray, const Sphere &sphere, Ray &reflexi
 
 bool Intersection::Ray_Triangle(const Ray &ray, const Triangle &triangle, Ray &reflexion)
 {
-    glm::vec3 e1 = triangle.b - triangle.a;
-    glm::vec3 e2 = triangle.c - triangle.a;
-    
-    glm::vec3 N = e1 * e2;
-    glm::vec3 P = ray.getDirection() * e2;
+    WatertightRay wray = TriangleIntersection::prepare(ray.getOrigin(), ray.getDirection());
+    float t = std::numeric_limits<float>::max();
+    float u, v;
+    // Si t est inférieur à ZERO_THRESHOLD alors l'intersection est derrière le rayon
+    if(!TriangleIntersection::intersect(wray, triangle, ZERO_THRESHOLD, t, u, v)) return false;
 
-    float det = glm::dot(e1, P);
-    // Le rayon est parallèle au plan 
-    if(det <= ZERO_THRESHOLD && det >= -ZERO_THRESHOLD) return false;
+    // Sinon, rayon ok donc on met a jour et on renvoie true
+    reflexion.setOrigin(ray.getPoint(t));
+    glm::vec3 N = glm::normalize(glm::cross(triangle.b - triangle.a, triangle.c - triangle.a));
+    glm::vec3 new_dir = ray.getDirection() - 2 * glm::dot(ray.getDirection(), N) * N;
+    reflexion.setDirection(new_dir);
 
-    float invDet = 1 / det;
+    return true;
+}
 
-    glm::vec3 T = ray.getOrigin() - triangle.a;
-    float u = glm::dot(T, P) * invDet;
-    // Si u n'est pas compris dans [0;1] alors le point d'intersection est hors du triangle
-    if(u < 0 || u > 1) return false;
 
-    glm::vec3 Q = T * e1;
-    float v = glm::dot(ray.getDirection(), Q) * invDet;
-    // Si v n'est pas compris dans [0;1] alors le point d'intersection est hors du triangle
-    if(v < 0 || u > 1) return false;
+bool Intersection::Ray_Mesh(const Ray &ray, const Object &object, Ray &reflexion)
+{
+    std::shared_ptr<const MeshBVH> mesh = object.getMesh();
+    if(!mesh) return false;
 
-    float t = glm::dot(e2, Q) * invDet;
-    // Si t est inférieur à 0 alors l'intersection est derrière le rayon
-    if(t < 0) return false;
+    // Le maillage est en coordonnées locales : c'est le rayon qui est déplacé
+    float t = std::numeric_limits<float>::max();
+    unsigned int index;
+    if(!mesh->intersect(ray.getOrigin() - object.getOrigin(), ray.getDirection(), t, index)) return false;
 
-    // Sinon, rayon ok donc on met a jour et on renvoie true
     reflexion.setOrigin(ray.getPoint(t));
-    glm::vec3 new_dir = ray.getDirection() - 2 * glm::dot(ray.getDirection(), N) * N;
-    reflexion.setDirection(new_dir);
 
+    Triangle triangle = mesh->getTriangle(index);
+    glm::vec3 norm = glm::normalize(glm::cross(triangle.b - triangle.a, triangle.c - triangle.a));
+    glm::vec3 dir = ray.getDirection();
+    reflexion.setDirection(dir - 2 * glm::dot(dir, norm) * norm);
+
+    return true;
+}
+
+
+bool Intersection::Ray_Patch(const Ray &ray, const BezierSurface &surface, Ray &reflexion)
+{
+    std::shared_ptr<const BezierPatch> patch = surface.getPatch();
+    if(!patch->isValid()) return Ray_Mesh(ray, surface, reflexion);
+
+    float t = std::numeric_limits<float>::max();
+    float u, v;
+    if(!patch->intersect(ray.getOrigin() - surface.getOrigin(), ray.getDirection(), t, u, v)) return false;
 
+    reflexion.setOrigin(ray.getPoint(t));
+
+    glm::vec3 norm = patch->normal(u, v);
+    glm::vec3 dir = ray.getDirection();
+    reflexion.setDirection(dir - 2 * glm::dot(dir, norm) * norm);
 
     return true;
 }
 
 
+bool Intersection::Ray_Curve(const Ray &ray, const BezierCurve &curve, Ray &reflexion)
+{
+    std::shared_ptr<const BezierTube> tube = curve.getTube();
+
+    float t = std::numeric_limits<float>::max();
+    glm::vec3 norm;
+    if(!tube->intersect(ray.getOrigin() - curve.getOrigin(), ray.getDirection(), t, norm)) return false;
+
+    reflexion.setOrigin(ray.getPoint(t));
+
+    glm::vec3 dir = ray.getDirection();
+    reflexion.setDirection(dir - 2 * glm::dot(dir, norm) * norm);
+
+    return true;
+}
+
+
+bool Intersection::Ray_Object(const Ray &ray, Object &object, Ray &reflexion)
+{
+    HitRecord hit = emptyHit();
+    if(!Hit_Object(ray, object, 0, hit)) return false;
+
+    hitReflexion(ray, object, hit, reflexion);
+    return true;
+}
+
+
+HitRecord Intersection::emptyHit()
+{
+    HitRecord hit;
+    hit.t = std::numeric_limits<float>::max();
+    hit.object = HIT_NONE;
+    hit.primitive = 0;
+    hit.u = hit.v = 0.0f;
+    hit.normal = glm::vec3(0.0f);
+    return hit;
+}
+
+
+bool Intersection::Hit_Object(const Ray &ray, const Object &object, int objectIndex, HitRecord &hit)
+{
+    // Les sphères, surfaces et courbes sont testées directement, les autres objets par leur maillage
+    float t = hit.t;
+    unsigned int primitive = 0;
+    float u = 0.0f, v = 0.0f;
+    glm::vec3 normal(0.0f);
+    bool found;
+
+    const Sphere* sphere = dynamic_cast<const Sphere*>(&object);
+    const BezierSurface* surface = dynamic_cast<const BezierSurface*>(&object);
+    const BezierCurve* curve = dynamic_cast<const BezierCurve*>(&object);
+
+    if(sphere != nullptr) {
+        // Même calcul que Ray_Sphere(), jusqu'à la distance seulement
+        float t0, t1;
+        glm::vec3 L = ray.getOrigin() - sphere->getOrigin();
+        float a = glm::dot(ray.getDirection(), ray.getDirection());
+        float b = 2 * glm::dot(ray.getDirection(), L);
+        float c = glm::dot(L, L) - sphere->getRadius() * sphere->getRadius();
+        found = solveQuadratic(a, b, c, t0, t1);
+        if(found) {
+            if(t0 < 0) t0 = t1;
+            found = (t0 >= 0 && t0 < t);
+            if(found) t = t0;
+        }
+    }
+    else if(surface != nullptr && surface->getPatch()->isValid()) {
+        found = surface->getPatch()->intersect(ray.getOrigin() - object.getOrigin(), ray.getDirection(), t, u, v);
+    }
+    else if(curve != nullptr) {
+        found = curve->getTube()->intersect(ray.getOrigin() - object.getOrigin(), ray.getDirection(), t, normal);
+    }
+    else {
+        std::shared_ptr<const MeshBVH> mesh = object.getMesh();
+        found = mesh && mesh->intersect(ray.getOrigin() - object.getOrigin(), ray.getDirection(), t, primitive);
+    }
+
+    if(!found) return false;
+
+    hit.t = t;
+    hit.object = objectIndex;
+    hit.primitive = primitive;
+    hit.u = u;
+    hit.v = v;
+    hit.normal = normal;
+    return true;
+}
+
+
+bool Intersection::closestHit(AppContext &context, const Ray &ray, int skipObject, HitRecord &hit)
+{
+    hit = emptyHit();
+    for(int i = 0; i < context.size(); ++i) {
+        if(i != skipObject) Hit_Object(ray, *context.getObject(i), i, hit);
+    }
+    return hit.object != HIT_NONE;
+}
+
+
+void Intersection::hitReflexion(const Ray &ray, const Object &object, const HitRecord &hit, Ray &reflexion)
+{
+    glm::vec3 point = ray.getPoint(hit.t);
+    glm::vec3 norm;
+
+    const Sphere* sphere = dynamic_cast<const Sphere*>(&object);
+    const BezierSurface* surface = dynamic_cast<const BezierSurface*>(&object);
+
+    if(sphere != nullptr) norm = glm::normalize(point - sphere->getOrigin());
+    else if(surface != nullptr && surface->getPatch()->isValid()) norm = surface->getPatch()->normal(hit.u, hit.v);
+    else if(dynamic_cast<const BezierCurve*>(&object) != nullptr) norm = hit.normal;
+    else {
+        Triangle triangle = object.getMesh()->getTriangle(hit.primitive);
+        norm = glm::normalize(glm::cross(triangle.b - triangle.a, triangle.c - triangle.a));
+    }
+
+    glm::vec3 dir = ray.getDirection();
+    reflexion.setOrigin(point);
+    reflexion.setDirection(dir - 2 * glm::dot(dir, norm) * norm);
+}
+
+
 void Intersection::cameraRay(AppContext &context, double xPos, double yPos, Ray &ray)
 {
     // Calcul des valeurs de position du rayon lancé
@@ -91,106 +236,185 @@ void Intersection::cameraRay(AppContext &context, double xPos, double yPos, Ray
 }
 
 
+std::vector<TraceRay> Intersection::rayFan(const TraceRay &center, unsigned int shape, unsigned int size,
+    float angle)
+{
+    // Repère orthonormé autour de la direction cliquée
+    glm::vec3 forward = glm::normalize(center.direction);
+    glm::vec3 up = (std::abs(forward.y) < 0.99f) ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+    glm::vec3 right = glm::normalize(glm::cross(forward, up));
+    up = glm::cross(right, forward);
+    float extent = std::tan(glm::radians(angle));
+
+    std::vector<TraceRay> rays;
+    rays.reserve((size_t)size * size);
+
+    for(unsigned int j = 0; j < size; ++j) {
+        for(unsigned int i = 0; i < size; ++i) {
+            // Centre de la case (i, j) dans [-1; 1]²
+            float a = 2.0f * (i + 0.5f) / size - 1.0f;
+            float b = 2.0f * (j + 0.5f) / size - 1.0f;
+            if(shape == RAY_FAN_CONE && a * a + b * b > 1.0f) continue;
+
+            rays.push_back({center.origin, glm::normalize(forward + extent * (a * right + b * up))});
+        }
+    }
+
+    return rays;
+}
+
+
 void Intersection::rayContextPath(AppContext &context, const Ray &ray, ptsTab &intersections,
     glm::vec3 &reflexion)
 {
 
     unsigned int bouncesCount = 0;
-    int objectIdBounceFrom = -1; // Pour ne pas regarder les collision avec l'objet courant
+    int objectIdBounceFrom = HIT_NONE; // Pour ne pas regarder les collision avec l'objet courant
     Ray currentRay = ray;
     Ray nextRay(glm::vec3(0.0f), glm::vec3(0.0f));
+    HitRecord hit;
 
     while(bouncesCount < MAX_RAY_BOUNCES)
     {
-        std::vector<float> interDist;
-        std::vector<unsigned int> interInd;
-
-        // Compute all intersections for this ray
-        for(int i = 0; i < context.size(); ++i)
-        {
-            if(i == objectIdBounceFrom) continue;
-
-            // SPHERE -----------------------------------------------------------------------------
-            Sphere* item = dynamic_cast<Sphere*>(context.getObject(i));
-            if(item != nullptr) {
-                bool intersect = Ray_Sphere(currentRay, *item, nextRay);
-
-                if(intersect) {
-                    interDist.push_back(glm::length(nextRay.getOrigin() - currentRay.getOrigin()));
-                    interInd.push_back(i);
-                }
-                
-                continue;
-            }
-        }
-
-        // No intersections = finished
-        if(interInd.size() == 0) {
+        // Seule la distance des candidats est calculée, le rebond l'est pour le plus proche
+        if(!closestHit(context, currentRay, objectIdBounceFrom, hit)) {
             if(intersections.size() == 0) reflexion = ray.getDirection();
             return;
         }
 
-        // Choose closest one
-        unsigned int minIndex = std::min_element(interDist.begin(), interDist.end()) - interDist.begin();
-        unsigned int closestIndex = interInd[minIndex];
+        hitReflexion(currentRay, *context.getObject(hit.object), hit, nextRay);
 
-        // Re-compute intersection
-        Sphere* item = dynamic_cast<Sphere*>(context.getObject(closestIndex));
-        Ray_Sphere(currentRay, *item, nextRay);
-        
         // Update variables
         intersections.push_back(nextRay.getOrigin());
         reflexion = nextRay.getDirection();
         currentRay = nextRay;
-        objectIdBounceFrom = closestIndex;
+        objectIdBounceFrom = hit.object;
         bouncesCount++;
     }
 }
 
 
+void Intersection::rayScenePaths(const TraceScene &scene, const std::vector<TraceRay> &rays,
+    unsigned int maxBounces, RayPaths &paths)
+{
+    paths.maxBounces = maxBounces;
+    paths.points.resize((size_t)maxBounces * rays.size());
+    paths.bounces.resize(rays.size());
+    paths.exits.resize(rays.size());
+
+    // Chaque chemin n'écrit que dans ses propres emplacements
+    parallelFor(0, rays.size(), [&](size_t i) {
+        paths.bounces[i] = scene.tracePath(rays[i], maxBounces, paths.points.data() + i * maxBounces,
+            paths.exits[i]);
+    });
+}
+
+
 glm::vec3 Intersection::rayColorPoint(AppContext &context, const Ray &ray)
 {
-    float minDistance = -1.f;
-    glm::vec3 minColor = context.getBackgroundColor();
+    HitRecord hit;
+    if(!closestHit(context, ray, HIT_NONE, hit)) return context.getBackgroundColor();
+    return context.getObject(hit.object)->getColor();
+}
 
-    for(int i = 0; i < context.size(); ++i) {
-        // SPHERE ---------------------------------------------------------------------------------
-        Sphere* item = dynamic_cast<Sphere*>(context.getObject(i));
-        if(item != nullptr) {
-            Ray dumb;
-            if(Ray_Sphere(ray, *item, dumb) &&
-                (minDistance < 0 || glm::length(dumb.getOrigin() - ray.getOrigin()) < minDistance))
-            {
-                minColor = item->getColor();
-                minDistance = glm::length(dumb.getOrigin() - ray.getOrigin());
-            }
-        }
-    }
 
-    return minColor;
+void Intersection::rayRenderRows(const TraceScene &scene, const TraceCamera &camera, unsigned int firstRow,
+    unsigned int rowCount, float* radiance)
+{
+    // Toutes les lignes avancent ensemble, rebond par rebond (cf. WavefrontTracer)
+    WavefrontTracer tracer(scene);
+    tracer.renderRows(camera, firstRow, rowCount, radiance);
 }
 
 
-void Intersection::raySavePNG(AppContext &context, std::string filename)
+void Intersection::raySavePNG(AppContext &context, std::string filename, unsigned int preset)
 {
+    std::shared_ptr<const TraceScene> scene = context.getTraceScene();
+    TraceCamera camera(context, context.SCR_WIDTH, context.SCR_HEIGHT);
+
+    // Seuls les rayons touchés par ce qui a changé depuis la capture précédente sont relancés
+    std::vector<float> radiance(3 * (size_t)context.SCR_WIDTH * context.SCR_HEIGHT);
+    GBuffer::printStats("capture", context.getCaptureCache().render(*scene, camera, radiance.data()));
+
     std::vector<unsigned char> image;
     image.resize(context.SCR_WIDTH * context.SCR_HEIGHT * 4);
+    Resolve::resolveRows(radiance.data(), image.data(), context.SCR_WIDTH, 0, context.SCR_HEIGHT,
+        Resolve::defaultSettings());
+
+    unsigned error = Capture::savePNG(filename, image, context.SCR_WIDTH, context.SCR_HEIGHT, preset);
+    if(!error) std::cout << "Image saved as '" << filename << "'" << std::endl;
+}
 
-    for(unsigned int y = 0; y < context.SCR_HEIGHT; ++y)
+
+void Intersection::rayStreamPNG(AppContext &context, std::string filename, unsigned int width,
+    unsigned int height, unsigned int preset, unsigned int bandHeight)
+{
+    std::shared_ptr<const TraceScene> scene = context.getTraceScene();
+    TraceCamera camera(context, width, height);
+    PNGStreamWriter writer(filename, width, height, preset);
+
+    // Seule la bande en cours est en mémoire, elle est réutilisée pour chaque bande
+    std::vector<float> radiance(3 * (size_t)width * bandHeight);
+    std::vector<unsigned char> band(4 * (size_t)width * bandHeight);
+    ResolveSettings settings = Resolve::defaultSettings();
+
+    for(unsigned int y = 0; y < height && !writer.getError(); y += bandHeight)
     {
-        for(unsigned int x = 0; x < context.SCR_WIDTH; ++x)
+        unsigned int rows = std::min(bandHeight, height - y);
+        rayRenderRows(*scene, camera, y, rows, radiance.data());
+        Resolve::resolveRows(radiance.data(), band.data(), width, y, rows, settings);
+        writer.writeRows(band.data(), rows);
+    }
+
+    unsigned error = writer.close();
+    if(!error) std::cout << "Image saved as '" << filename << "' (" << width << "x" << height << ")" << std::endl;
+    else std::cout << "Erreur de capture : " << lodepng_error_text(error) << std::endl;
+}
+
+
+void Intersection::raySaveRaw(AppContext &context, std::string filename, unsigned int width,
+    unsigned int height, unsigned int format)
+{
+    std::shared_ptr<const TraceScene> scene = context.getTraceScene();
+    TraceCamera camera(context, width, height);
+    MappedImage image(filename, width, height, format);
+    if(!image.isValid()) return;
+    ResolveSettings settings = Resolve::defaultSettings();
+
+    // Découpage en tuiles : chaque thread écrit ses pixels directement dans le fichier projeté
+    unsigned int tilesX = (width + CAPTURE_TILE_SIZE - 1) / CAPTURE_TILE_SIZE;
+    unsigned int tilesY = (height + CAPTURE_TILE_SIZE - 1) / CAPTURE_TILE_SIZE;
+
+    parallelFor(0, tilesX * tilesY, [&](size_t tile) {
+        unsigned int x0 = (tile % tilesX) * CAPTURE_TILE_SIZE;
+        unsigned int y0 = (tile / tilesX) * CAPTURE_TILE_SIZE;
+        unsigned int x1 = std::min(x0 + CAPTURE_TILE_SIZE, width);
+        unsigned int y1 = std::min(y0 + CAPTURE_TILE_SIZE, height);
+
+        float tileRadiance[3 * CAPTURE_TILE_SIZE];
+
+        for(unsigned int y = y0; y < y1; ++y)
         {
-            Ray tmp;
-            cameraRay(context, x, y, tmp);
-            glm::vec3 color = rayColorPoint(context, tmp);
-
-            image[4 * context.SCR_WIDTH * y + 4 * x + 0] = 255 * color.x;
-            image[4 * context.SCR_WIDTH * y + 4 * x + 1] = 255 * color.y;
-            image[4 * context.SCR_WIDTH * y + 4 * x + 2] = 255 * color.z;
-            image[4 * context.SCR_WIDTH * y + 4 * x + 3] = 255;
+            // Au format RGB32F, la radiance est écrite telle quelle, sans borne, dans le fichier
+            float* row = (format == RAW_FORMAT_RGB32F) ? image.pixelRGB32F(x0, y) : tileRadiance;
+
+            for(unsigned int x = x0; x < x1; ++x)
+            {
+                glm::vec3 color(0.0f);
+                for(unsigned int sample = 0; sample < scene->getSamples(); ++sample)
+                    color += scene->traceSample(camera, x, y, sample);
+                color /= (float)scene->getSamples();
+                float* pixel = row + 3 * (x - x0);
+                pixel[0] = color.x;
+                pixel[1] = color.y;
+                pixel[2] = color.z;
+            }
+
+            if(format != RAW_FORMAT_RGB32F) {
+                Resolve::resolveSpan(tileRadiance, image.pixelRGBA8(x0, y), x1 - x0, x0, y, settings);
+            }
         }
-    }
+    });
 
-    unsigned error = lodepng::encode(filename, image, context.SCR_WIDTH, context.SCR_HEIGHT);
-    if(!error) std::cout << "Image saved as '" << filename << "'" << std::endl;
+    std::cout << "Image saved as '" << filename << "' (" << width << "x" << height << ")" << std::endl;
 }
@@ -1,14 +1,44 @@
 #ifndef INTERSECTIONS_HPP
 #define INTERSECTIONS_HPP
 
+#include "BezierCurve.hpp"
+#include "BezierSurface.hpp"
 #include "Sphere.hpp"
 #include "Ray.hpp"
 #include "AppContext.hpp"
 
-#include "lodepng.h"
+#include "Capture.hpp"
+#include "GBuffer.hpp"
+#include "MappedImage.hpp"
+#include "MeshBVH.hpp"
+#include "PNGStreamWriter.hpp"
+#include "Resolve.hpp"
+#include "TraceScene.hpp"
+#include "WavefrontTracer.hpp"
 
 #define MAX_RAY_BOUNCES 100
 #define ZERO_THRESHOLD 0.00001
+#define CAPTURE_TILE_SIZE 32u // Côté des tuiles calculées par un thread
+#define CAPTURE_BAND_HEIGHT 64 // Nombre de lignes calculées avant d'être envoyées à l'encodeur
+#define HIT_NONE -1 // object d'un HitRecord sans intersection
+
+#define RAY_FAN_CONE 0      // Directions dans un cône autour du rayon cliqué
+#define RAY_FAN_GRID 1      // Directions sur toute la grille carrée (pyramide) autour du rayon cliqué
+#define RAY_FAN_SIZE 64     // Directions par côté de la grille d'un éventail
+#define RAY_FAN_ANGLE 10.0f // Demi-angle d'ouverture d'un éventail, en degrés
+
+
+/**
+ * @brief Intersection retenue pendant la recherche : seulement ce qu'il faut pour comparer les
+ * candidats et, pour le plus proche, retrouver ses attributs (cf. Intersection::hitReflexion()).
+ */
+typedef struct s_HitRecord {
+    float t;                // Distance en multiples de la direction du rayon
+    int object;             // Indice de l'objet dans le contexte, HIT_NONE si rien n'a été touché
+    unsigned int primitive; // Triangle touché pour un maillage (cf. MeshBVH::getTriangle())
+    float u, v;             // Paramètres du point touché pour une surface de Bézier
+    glm::vec3 normal;       // Normale pour une courbe de Bézier, donnée par le test du tube
+} HitRecord;
 
 
 class Intersection
@@ -17,11 +47,100 @@ public:
     static bool Ray_Sphere(const Ray &ray, const Sphere &sphere, Ray &reflexion);
     static bool Ray_Triangle(const Ray &ray, const Triangle &triangle, Ray &reflexion);
 
+    /**
+     * @brief Intersection avec le maillage d'un objet (parcours de sa hiérarchie englobante).
+     */
+    static bool Ray_Mesh(const Ray &ray, const Object &object, Ray &reflexion);
+
+    /**
+     * @brief Intersection directe avec une surface de Bézier (cf. BezierPatch).
+     */
+    static bool Ray_Patch(const Ray &ray, const BezierSurface &surface, Ray &reflexion);
+
+    /**
+     * @brief Intersection avec le tube de rayon BEZIER_TUBE_RADIUS autour d'une courbe de Bézier.
+     */
+    static bool Ray_Curve(const Ray &ray, const BezierCurve &curve, Ray &reflexion);
+
+    /**
+     * @brief Intersection avec un objet quelconque : directe pour les sphères, les surfaces et les
+     * courbes de Bézier, par le maillage pour les autres objets, toujours fausse pour les objets
+     * sans maillage.
+     */
+    static bool Ray_Object(const Ray &ray, Object &object, Ray &reflexion);
+
+    /**
+     * @brief Renvoie un HitRecord vide (t maximal, aucun objet).
+     */
+    static HitRecord emptyHit();
+
+    /**
+     * @brief Teste un objet comme Ray_Object() mais sans calculer le point, la normale ni le rayon
+     * réfléchi : si l'objet est touché avant hit.t, hit est mis à jour avec la distance, objectIndex
+     * et la primitive touchée.
+     * @return true si hit a été mis à jour.
+     */
+    static bool Hit_Object(const Ray &ray, const Object &object, int objectIndex, HitRecord &hit);
+
+    /**
+     * @brief Cherche l'objet du contexte le plus proche touché par le rayon.
+     * @param skipObject indice d'un objet à ignorer (celui d'où part le rayon), ou HIT_NONE.
+     * @return true si un objet a été touché.
+     */
+    static bool closestHit(AppContext &context, const Ray &ray, int skipObject, HitRecord &hit);
+
+    /**
+     * @brief Calcule le point touché et le rayon réfléchi d'une intersection trouvée par
+     * Hit_Object(), une seule fois pour l'intersection retenue.
+     */
+    static void hitReflexion(const Ray &ray, const Object &object, const HitRecord &hit, Ray &reflexion);
+
     static void cameraRay(AppContext &context, double xPos, double yPos, Ray &ray);
+
+    /**
+     * @brief Renvoie les rayons d'un éventail autour de center : size x size directions réparties
+     * régulièrement dans un demi-angle de angle degrés.
+     * @param shape RAY_FAN_CONE ou RAY_FAN_GRID.
+     */
+    static std::vector<TraceRay> rayFan(const TraceRay &center, unsigned int shape,
+        unsigned int size = RAY_FAN_SIZE, float angle = RAY_FAN_ANGLE);
     static void rayContextPath(AppContext &context, const Ray &ray, ptsTab &intersections, glm::vec3 &reflexion);
 
+    /**
+     * @brief Calcule en parallèle les chemins de tout un lot de rayons (cf. TraceScene::tracePath()),
+     * maxBounces points au plus par chemin.
+     */
+    static void rayScenePaths(const TraceScene &scene, const std::vector<TraceRay> &rays,
+        unsigned int maxBounces, RayPaths &paths);
+
     static glm::vec3 rayColorPoint(AppContext &context, const Ray &ray);
-    static void raySavePNG(AppContext &context, std::string filename);
+    static void raySavePNG(AppContext &context, std::string filename,
+        unsigned int preset = PNG_PRESET_DEFAULT);
+
+    /**
+     * @brief Calcule une capture à une résolution indépendante de la fenêtre et l'écrit bande par
+     * bande : la mémoire utilisée dépend de la largeur de l'image et de bandHeight, pas de sa
+     * hauteur, ce qui permet des images bien plus grandes que la mémoire disponible.
+     */
+    static void rayStreamPNG(AppContext &context, std::string filename, unsigned int width,
+        unsigned int height, unsigned int preset = PNG_PRESET_DEFAULT,
+        unsigned int bandHeight = CAPTURE_BAND_HEIGHT);
+
+    /**
+     * @brief Calcule une capture au format brut (cf. MappedImage.hpp). Les threads de rendu
+     * écrivent leurs tuiles directement dans le fichier projeté en mémoire. Au format
+     * RAW_FORMAT_RGB32F, la radiance est écrite sans être bornée ni convertie.
+     */
+    static void raySaveRaw(AppContext &context, std::string filename, unsigned int width,
+        unsigned int height, unsigned int format = RAW_FORMAT_RGB32F);
+
+    /**
+     * @brief Calcule rowCount lignes de l'image à partir de la ligne firstRow, en parallèle et par
+     * vagues (cf. WavefrontTracer), et écrit leur radiance linéaire (RGB flottant, non bornée) dans
+     * radiance. La conversion en pixels 8 bits est faite ensuite par Resolve.
+     */
+    static void rayRenderRows(const TraceScene &scene, const TraceCamera &camera, unsigned int firstRow,
+        unsigned int rowCount, float* radiance);
 
 };
 
@@ -0,0 +1,75 @@
+#include "MappedImage.hpp"
+
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+MappedImage::MappedImage(const std::string &filename, unsigned int width, unsigned int height,
+    unsigned int format) :
+    m_mapping(nullptr),
+    m_size(0),
+    m_width(width),
+    m_height(height),
+    m_format(format),
+    m_pixelSize((format == RAW_FORMAT_RGB32F) ? 3 * sizeof(float) : 4)
+{
+    m_size = RAW_HEADER_SIZE + m_pixelSize * width * height;
+
+    int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) {
+        std::cout << "Impossible de créer le fichier '" << filename << "'" << std::endl;
+        return;
+    }
+
+    // Le fichier doit avoir sa taille finale avant d'être projeté
+    if(ftruncate(fd, m_size) == 0) {
+        void* mapping = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(mapping != MAP_FAILED) m_mapping = static_cast<unsigned char*>(mapping);
+    }
+    ::close(fd); // La projection reste valide après la fermeture du descripteur
+
+    if(!m_mapping) {
+        std::cout << "Impossible de projeter le fichier '" << filename << "' en mémoire" << std::endl;
+        return;
+    }
+
+    RawHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.signature, RAW_SIGNATURE, 8);
+    header.width = width;
+    header.height = height;
+    header.format = format;
+    header.pixelSize = m_pixelSize;
+    header.dataOffset = RAW_HEADER_SIZE;
+    std::memcpy(m_mapping, &header, sizeof(header));
+}
+
+
+MappedImage::~MappedImage()
+{
+    if(m_mapping) munmap(m_mapping, m_size);
+}
+
+
+bool MappedImage::isValid() const {return m_mapping != nullptr;}
+
+
+unsigned char* MappedImage::pixelRGBA8(unsigned int x, unsigned int y)
+{
+    return m_mapping + RAW_HEADER_SIZE + m_pixelSize * ((size_t)m_width * y + x);
+}
+
+
+float* MappedImage::pixelRGB32F(unsigned int x, unsigned int y)
+{
+    return reinterpret_cast<float*>(pixelRGBA8(x, y));
+}
+
+
+unsigned int MappedImage::getWidth() const {return m_width;}
+unsigned int MappedImage::getHeight() const {return m_height;}
+unsigned int MappedImage::getFormat() const {return m_format;}
@@ -0,0 +1,100 @@
+#ifndef MAPPED_IMAGE_HPP
+#define MAPPED_IMAGE_HPP
+
+/**
+ * @file MappedImage.hpp
+ * @brief Définition de la classe MappedImage.
+ * 
+ * Ce fichier contient un format d'image brut (en-tête + pixels non compressés) écrit directement
+ * en mémoire à travers une projection du fichier (mmap). Il est destiné aux outils qui
+ * post-traitent les rendus et pour lesquels l'encodage PNG est du travail inutile.
+ * 
+ * Format du fichier (petit boutiste) :
+ * - octets 0 à 7   : signature "IGAIRAW1"
+ * - octets 8 à 11  : largeur (uint32)
+ * - octets 12 à 15 : hauteur (uint32)
+ * - octets 16 à 19 : format des pixels (RAW_FORMAT_*)
+ * - octets 20 à 23 : taille d'un pixel en octets (uint32)
+ * - octets 24 à 27 : position des pixels dans le fichier (uint32, RAW_HEADER_SIZE)
+ * - octets 28 à 63 : réservés (à 0)
+ * - puis les pixels, ligne par ligne, de haut en bas.
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#define RAW_FORMAT_RGBA8 0   // 4 octets par pixel, sRGB (cf. Resolve)
+#define RAW_FORMAT_RGB32F 1  // 3 float par pixel, radiance linéaire non bornée
+
+#define RAW_HEADER_SIZE 64   // Les pixels commencent sur une ligne de cache
+#define RAW_SIGNATURE "IGAIRAW1"
+
+
+typedef struct s_RawHeader {
+    char signature[8];
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+    uint32_t pixelSize;
+    uint32_t dataOffset;
+    uint8_t reserved[RAW_HEADER_SIZE - 28];
+} RawHeader;
+
+
+/**
+ * @class MappedImage
+ * @brief Fichier image brut projeté en mémoire.
+ * 
+ * Le fichier est créé à sa taille finale puis projeté en mémoire : les threads de rendu écrivent
+ * leurs pixels directement dans les pages du fichier, sans copie intermédiaire, et c'est le
+ * système qui les écrit sur le disque.
+ */
+class MappedImage
+{
+public:
+
+    /**
+     * @brief Crée (ou écrase) le fichier et le projette en mémoire.
+     * @param filename chemin du fichier.
+     * @param width, height dimensions de l'image.
+     * @param format RAW_FORMAT_RGBA8 ou RAW_FORMAT_RGB32F.
+     */
+    MappedImage(const std::string &filename, unsigned int width, unsigned int height, unsigned int format);
+
+    /**
+     * @brief Termine la projection, les pixels restent dans le fichier.
+     */
+    ~MappedImage();
+
+    MappedImage(const MappedImage&) = delete;
+    MappedImage& operator=(const MappedImage&) = delete;
+
+    /**
+     * @brief Renvoie true si le fichier a bien été créé et projeté en mémoire.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Renvoie l'adresse du pixel (x, y) dans la projection.
+     */
+    unsigned char* pixelRGBA8(unsigned int x, unsigned int y);
+    float* pixelRGB32F(unsigned int x, unsigned int y);
+
+    unsigned int getWidth() const;
+    unsigned int getHeight() const;
+    unsigned int getFormat() const;
+
+private:
+    unsigned char* m_mapping;
+    size_t m_size;
+    unsigned int m_width;
+    unsigned int m_height;
+    unsigned int m_format;
+    size_t m_pixelSize;
+};
+
+#endif // MAPPED_IMAGE_HPP
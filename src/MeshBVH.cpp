@@ -0,0 +1,234 @@
+#include "MeshBVH.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+
+/**
+ * @brief Empreinte (FNV-1a 64 bits) des triangles et du stockage, qui identifie un maillage.
+ */
+static unsigned long long meshHash(const std::vector<Triangle> &triangles, unsigned int storage)
+{
+    unsigned long long hash = 14695981039346656037ull ^ storage;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(triangles.data());
+    for(size_t i = 0; i < triangles.size() * sizeof(Triangle); ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash ^ triangles.size();
+}
+
+
+MeshBVH::MeshBVH(std::vector<Triangle> triangles, unsigned int storage) :
+    m_storage(storage),
+    m_boundsMin(0.0f),
+    m_boundsMax(0.0f)
+{
+    std::vector<BVHPrimitive> primitives(triangles.size());
+    for(size_t i = 0; i < triangles.size(); ++i) {
+        const Triangle &tri = triangles[i];
+        primitives[i] = {glm::min(tri.a, glm::min(tri.b, tri.c)), glm::max(tri.a, glm::max(tri.b, tri.c))};
+    }
+
+    std::vector<unsigned int> order;
+    m_stats = BVHBuilder::build(primitives, BVH_LEAF_SIZE, m_nodes, order);
+    if(!m_nodes.empty()) {
+        m_boundsMin = m_nodes[0].boundsMin;
+        m_boundsMax = m_nodes[0].boundsMax;
+    }
+
+    // Les triangles d'une feuille sont rangés côte à côte
+    m_triangles.resize(triangles.size());
+    for(size_t i = 0; i < order.size(); ++i) m_triangles[i] = triangles[order[i]];
+
+    if(m_storage == MESH_STORAGE_QUANTIZED) {
+        std::vector<unsigned int> quantizedOrder;
+        m_quantized = QuantizedBVH(m_nodes, m_triangles, &quantizedOrder);
+        m_quantized.getBounds(m_boundsMin, m_boundsMax);
+        m_nodes = std::vector<BVHNode>();
+        m_triangles = std::vector<Triangle>();
+
+        m_order.resize(quantizedOrder.size());
+        for(size_t i = 0; i < quantizedOrder.size(); ++i) m_order[i] = order[quantizedOrder[i]];
+        return;
+    }
+
+    m_order = std::move(order);
+    buildPackets();
+}
+
+
+std::shared_ptr<const MeshBVH> MeshBVH::create(std::vector<Triangle> triangles, unsigned int storage)
+{
+    // Maillages encore utilisés, par empreinte
+    static std::mutex mutex;
+    static std::unordered_multimap<unsigned long long, std::weak_ptr<const MeshBVH>> meshes;
+
+    unsigned long long hash = meshHash(triangles, storage);
+
+    // Les candidats sont relevés sous le verrou, mais comparés en dehors
+    std::vector<std::shared_ptr<const MeshBVH>> candidates;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto range = meshes.equal_range(hash);
+        for(auto it = range.first; it != range.second; ++it)
+            if(auto mesh = it->second.lock()) candidates.push_back(mesh);
+    }
+    for(const auto& mesh : candidates)
+        if(mesh->sameTriangles(triangles, storage)) return mesh;
+
+    // Construction sans verrou : des maillages différents se construisent en même temps
+    std::shared_ptr<const MeshBVH> mesh = std::make_shared<const MeshBVH>(triangles, storage);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Un autre thread a pu construire le même maillage entre temps : le premier rangé est gardé
+    auto range = meshes.equal_range(hash);
+    for(auto it = range.first; it != range.second; ++it) {
+        std::shared_ptr<const MeshBVH> other = it->second.lock();
+        if(other && std::find(candidates.begin(), candidates.end(), other) == candidates.end()
+            && other->sameTriangles(triangles, storage)) return other;
+    }
+
+    // Les maillages qui ne sont plus utilisés sont oubliés
+    for(auto it = meshes.begin(); it != meshes.end();)
+        it = it->second.expired() ? meshes.erase(it) : std::next(it);
+
+    meshes.insert({hash, mesh});
+    return mesh;
+}
+
+
+bool MeshBVH::sameTriangles(const std::vector<Triangle> &triangles, unsigned int storage) const
+{
+    if(storage != m_storage || triangles.size() != m_order.size()) return false;
+    if(m_storage == MESH_STORAGE_QUANTIZED) return m_quantized.matches(triangles, m_order);
+
+    for(size_t i = 0; i < m_order.size(); ++i)
+        if(std::memcmp(&triangles[m_order[i]], &m_triangles[i], sizeof(Triangle)) != 0) return false;
+    return true;
+}
+
+
+void MeshBVH::buildPackets()
+{
+    for(BVHNode &node : m_nodes) {
+        if(node.count == 0) continue;
+
+        // Les emplacements libres répètent le dernier triangle : ils ne changent pas le résultat
+        TrianglePacket packet;
+        for(unsigned int lane = 0; lane < TRIANGLE_PACKET_SIZE; ++lane) {
+            unsigned int index = node.first + std::min(lane, node.count - 1);
+            TriangleIntersection::setPacketTriangle(packet, lane, m_triangles[index], index);
+        }
+
+        node.first = m_packets.size();
+        m_packets.push_back(packet);
+    }
+}
+
+
+bool MeshBVH::intersect(const glm::vec3 &origin, const glm::vec3 &direction, float &t,
+    unsigned int &triangle, bool anyHit) const
+{
+    if(m_storage == MESH_STORAGE_QUANTIZED) {
+        return m_quantized.intersect(origin, direction, BVH_EPSILON, t, triangle, anyHit);
+    }
+    if(m_nodes.empty()) return false;
+
+    glm::vec3 invDir = 1.0f / direction;
+    WatertightRay wray = TriangleIntersection::prepare(origin, direction);
+    bool hit = false;
+
+    if(intersectBounds(m_nodes[0], origin, invDir, t) == std::numeric_limits<float>::infinity()) return false;
+
+    unsigned int stack[BVH_STACK_SIZE];
+    float stackDistance[BVH_STACK_SIZE];
+    unsigned int stackSize = 0;
+    unsigned int current = 0;
+
+    while(true)
+    {
+        const BVHNode &node = m_nodes[current];
+
+        if(node.count > 0) {
+            float u, v;
+            const TrianglePacket &packet = m_packets[node.first];
+            int lane = TriangleIntersection::intersectPacket(wray, packet, BVH_EPSILON, t, u, v);
+            if(lane >= 0) {
+                triangle = packet.triangles[lane];
+                if(anyHit) return true;
+                hit = true;
+            }
+        }
+        else {
+            // Le fils le plus proche d'abord, le plus lointain est gardé pour plus tard
+            float dLeft = intersectBounds(m_nodes[node.first], origin, invDir, t);
+            float dRight = intersectBounds(m_nodes[node.first + 1], origin, invDir, t);
+            unsigned int near = node.first, far = node.first + 1;
+            if(dRight < dLeft) {
+                std::swap(dLeft, dRight);
+                std::swap(near, far);
+            }
+
+            if(dLeft != std::numeric_limits<float>::infinity()) {
+                if(dRight != std::numeric_limits<float>::infinity()) {
+                    stack[stackSize] = far;
+                    stackDistance[stackSize++] = dRight;
+                }
+                current = near;
+                continue;
+            }
+        }
+
+        // Les noeuds mis de côté qui sont derrière le triangle trouvé depuis sont ignorés
+        do {
+            if(stackSize == 0) return hit;
+            --stackSize;
+        } while(stackDistance[stackSize] > t);
+        current = stack[stackSize];
+    }
+}
+
+
+bool MeshBVH::occluded(const glm::vec3 &origin, const glm::vec3 &direction, float tMax) const
+{
+    unsigned int triangle;
+    return intersect(origin, direction, tMax, triangle, true);
+}
+
+
+Triangle MeshBVH::getTriangle(unsigned int index) const
+{
+    return (m_storage == MESH_STORAGE_QUANTIZED) ? m_quantized.getTriangle(index) : m_triangles[index];
+}
+
+
+const std::vector<Triangle>& MeshBVH::getTriangles() const {return m_triangles;}
+const std::vector<BVHNode>& MeshBVH::getNodes() const {return m_nodes;}
+const BVHBuildStats& MeshBVH::getBuildStats() const {return m_stats;}
+unsigned int MeshBVH::getStorage() const {return m_storage;}
+
+
+void MeshBVH::getBounds(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const
+{
+    boundsMin = m_boundsMin;
+    boundsMax = m_boundsMax;
+}
+
+
+unsigned int MeshBVH::getTriangleCount() const
+{
+    return (m_storage == MESH_STORAGE_QUANTIZED) ? m_quantized.getTriangleCount() : m_triangles.size();
+}
+
+
+size_t MeshBVH::memoryUsage() const
+{
+    return m_triangles.size() * sizeof(Triangle) + m_nodes.size() * sizeof(BVHNode)
+        + m_packets.size() * sizeof(TrianglePacket) + m_order.size() * sizeof(unsigned int)
+        + m_quantized.memoryUsage();
+}
@@ -0,0 +1,135 @@
+#ifndef MESH_BVH_HPP
+#define MESH_BVH_HPP
+
+/**
+ * @file MeshBVH.hpp
+ * @brief Définition de la classe MeshBVH.
+ * 
+ * Ce fichier contient la hiérarchie de volumes englobants (BVH) construite sur les triangles d'un
+ * maillage, qui permet de trouver le triangle touché par un rayon sans tester tous les triangles.
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "BVHBuilder.hpp"
+#include "Object.hpp"
+#include "QuantizedBVH.hpp"
+#include "TriangleIntersection.hpp"
+
+#define BVH_LEAF_SIZE TRIANGLE_PACKET_SIZE // Une feuille = un paquet de triangles
+#define BVH_STACK_SIZE 64      // Profondeur maximale du parcours
+#define BVH_EPSILON 0.00001f   // Distance minimale d'une intersection (évite l'auto-intersection)
+
+// Un fils au plus mis de côté par niveau, plus la racine (cf. BVHBuilder)
+static_assert(BVH_STACK_SIZE >= BVH_MAX_DEPTH + 1, "BVH_STACK_SIZE trop petit pour BVH_MAX_DEPTH");
+
+#define MESH_STORAGE_FLOAT 0         // Triangles et boîtes en précision flottante complète
+#define MESH_STORAGE_QUANTIZED 1     // Version compressée (cf. QuantizedBVH)
+#define MESH_QUANTIZE_THRESHOLD 262144 // Nombre de triangles à partir duquel un objet est compressé
+
+
+/**
+ * @class MeshBVH
+ * @brief Triangles d'un maillage (en coordonnées locales) et leur hiérarchie englobante.
+ * 
+ * Les triangles sont réordonnés à la construction pour que chaque feuille désigne une suite
+ * contiguë du tableau, puis copiés par feuille dans un paquet (TrianglePacket) testé en une fois
+ * par le test étanche de TriangleIntersection. Un MeshBVH n'est jamais modifié après sa
+ * construction : il peut donc être partagé entre l'objet et les copies de scène utilisées par le
+ * lancer de rayons.
+ * 
+ * En mode MESH_STORAGE_QUANTIZED, seule la version compressée est gardée : trois à quatre fois plus
+ * petite, au prix d'un décodage à chaque noeud et à chaque feuille visités. Les indices de
+ * triangles renvoyés sont alors ceux de la version compressée (cf. getTriangle()).
+ */
+class MeshBVH
+{
+public:
+
+    /**
+     * @brief Construit la hiérarchie (cf. BVHBuilder).
+     * @param triangles triangles du maillage, en coordonnées locales.
+     * @param storage MESH_STORAGE_FLOAT ou MESH_STORAGE_QUANTIZED.
+     */
+    MeshBVH(std::vector<Triangle> triangles, unsigned int storage = MESH_STORAGE_FLOAT);
+
+    /**
+     * @brief Renvoie le maillage construit sur ces triangles : un maillage identique (mêmes
+     * triangles, même stockage) encore utilisé par un autre objet est partagé plutôt que
+     * reconstruit, si bien qu'une géométrie répétée n'est gardée qu'une fois en mémoire. Les
+     * triangles sont comparés à ceux du maillage trouvé par l'empreinte avant de le réutiliser (cf.
+     * sameTriangles()). La construction se fait hors du verrou : plusieurs objets peuvent créer
+     * leurs maillages en même temps.
+     */
+    static std::shared_ptr<const MeshBVH> create(std::vector<Triangle> triangles,
+        unsigned int storage = MESH_STORAGE_FLOAT);
+
+    /**
+     * @brief Cherche le triangle le plus proche touché par le rayon.
+     * @param origin, direction rayon en coordonnées locales (direction non nécessairement normée).
+     * @param t en entrée, distance maximale (en multiples de direction) ; en sortie, distance du
+     * point touché si un triangle plus proche a été trouvé.
+     * @param triangle indice du triangle touché (cf. getTriangle()).
+     * @param anyHit s'arrêter au premier triangle touché avant t, pas forcément le plus proche.
+     * @return true si un triangle a été touché avant t.
+     */
+    bool intersect(const glm::vec3 &origin, const glm::vec3 &direction, float &t,
+        unsigned int &triangle, bool anyHit = false) const;
+
+    /**
+     * @brief Renvoie true si un triangle est touché avant tMax (rayons d'ombre) : le parcours
+     * s'arrête au premier trouvé.
+     */
+    bool occluded(const glm::vec3 &origin, const glm::vec3 &direction, float tMax) const;
+
+    /**
+     * @brief Renvoie le triangle d'indice index, décodé si le maillage est compressé.
+     */
+    Triangle getTriangle(unsigned int index) const;
+
+    /**
+     * @brief Renvoie les triangles en précision complète (vide si le maillage est compressé).
+     */
+    const std::vector<Triangle>& getTriangles() const;
+    const std::vector<BVHNode>& getNodes() const;
+    const BVHBuildStats& getBuildStats() const;
+    unsigned int getTriangleCount() const;
+    unsigned int getStorage() const;
+
+    /**
+     * @brief Renvoie la boîte englobante du maillage, en coordonnées locales.
+     */
+    void getBounds(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const;
+
+    /**
+     * @brief Renvoie la mémoire occupée par les triangles et la hiérarchie, en octets.
+     */
+    size_t memoryUsage() const;
+
+private:
+    std::vector<Triangle> m_triangles;
+    std::vector<BVHNode> m_nodes;
+    std::vector<TrianglePacket> m_packets;
+    QuantizedBVH m_quantized;
+    std::vector<unsigned int> m_order; // Indice, parmi les triangles reçus, de chaque triangle gardé
+    unsigned int m_storage;
+    BVHBuildStats m_stats;
+    glm::vec3 m_boundsMin;
+    glm::vec3 m_boundsMax;
+
+    void buildPackets();
+
+    /**
+     * @brief Renvoie true si ce maillage a été construit sur ces triangles avec ce stockage : mêmes
+     * triangles bit à bit (retrouvés par m_order), ou, en version compressée, mêmes sommets
+     * quantifiés et mêmes indices.
+     */
+    bool sameTriangles(const std::vector<Triangle> &triangles, unsigned int storage) const;
+};
+
+#endif // MESH_BVH_HPP
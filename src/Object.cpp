@@ -1,9 +1,17 @@
 #include "Object.hpp"
+#include "MeshBVH.hpp"
 
 
 Object::Object(bool enableNormal, bool enableUV) :
-    m_origin(glm::vec3(0.0f)), m_color(glm::vec3(1.0f)), m_ambient(OBJECT_AMBIENT_STRENGTH)
+    VAO(0), VBO(0), m_origin(glm::vec3(0.0f)), m_color(glm::vec3(1.0f)), m_ambient(OBJECT_AMBIENT_STRENGTH)
 {
+    unsigned int nbVec = (enableNormal) ? 2 : 1; // Si on a la normale alors on a 2 vec3
+    nbVec += (enableUV) ? 1 : 0;                 // Si on a les UVs alors on a un vec3 de plus
+    m_vertexStride = nbVec;
+
+    // Sans contexte OpenGL, les sommets ne sont gardés que côté CPU
+    if(!hasOpenGL()) return;
+
     // Création du VAO et du VBO
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
@@ -13,9 +21,6 @@ Object::Object(bool enableNormal, bool enableUV) :
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STATIC_DRAW);
 
-    unsigned int nbVec = (enableNormal) ? 2 : 1; // Si on a la normale alors on a 2 vec3
-    nbVec += (enableUV) ? 1 : 0;                 // Si on a les UVs alors on a un vec3 de plus
-
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, nbVec * sizeof(glm::vec3), (void*)0);
     glEnableVertexAttribArray(0);
 
@@ -37,6 +42,7 @@ Object::Object(bool enableNormal, bool enableUV) :
 
 Object::~Object()
 {
+    if(VAO == 0) return;
     glDeleteBuffers(1, &VBO);
     glDeleteVertexArrays(1, &VAO);
 }
@@ -45,6 +51,11 @@ Object::~Object()
 
 void Object::updateVertices(ptsTab points)
 {
+    if(!hasOpenGL()) {
+        m_vertexData = std::move(points);
+        return;
+    }
+
     // "Connexion" au VAO
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
@@ -59,8 +70,13 @@ void Object::updateVertices(ptsTab points)
     // Optionnel : on se "déconnecte" du VAO et du VBO
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
+
+    m_vertexData = std::move(points);
 }
 
+
+void Object::setTriangleIndexes(const std::vector<unsigned int> &indexes) {m_triangleIndexes = indexes;}
+
 glm::vec3 Object::getOrigin() const {return m_origin;}
 
 void Object::setOrigin(glm::vec3 value) {m_origin = value;}
@@ -73,4 +89,35 @@ float Object::getAmbient() const {return m_ambient;}
 
 void Object::setAmbient(float value) {m_ambient = value;}
 
-// const std::vector<Triangle>* Object::getTriangles() {return &m_triangles;}
+const std::vector<Triangle>* Object::getTriangles() const
+{
+    return m_mesh ? &m_mesh->getTriangles() : nullptr;
+}
+
+std::shared_ptr<const MeshBVH> Object::getMesh() const {return m_mesh;}
+
+const ptsTab& Object::getVertexData() const {return m_vertexData;}
+unsigned int Object::getVertexStride() const {return m_vertexStride;}
+const std::vector<unsigned int>& Object::getTriangleIndexes() const {return m_triangleIndexes;}
+
+bool Object::hasOpenGL() {return GLAD_GL_VERSION_3_3 != 0;}
+
+
+void Object::setTriangles(const ptsTab &vertices, const std::vector<unsigned int> &indexes,
+    unsigned int stride)
+{
+    std::vector<Triangle> triangles;
+    triangles.reserve(indexes.size() / 3);
+
+    for(size_t i = 0; i + 2 < indexes.size(); i += 3) {
+        triangles.push_back({
+            vertices[stride * indexes[i]],
+            vertices[stride * indexes[i + 1]],
+            vertices[stride * indexes[i + 2]]
+        });
+    }
+
+    // Les très grands maillages (surfaces finement discrétisées) sont compressés
+    unsigned int storage = (triangles.size() >= MESH_QUANTIZE_THRESHOLD) ? MESH_STORAGE_QUANTIZED : MESH_STORAGE_FLOAT;
+    m_mesh = MeshBVH::create(std::move(triangles), storage);
+}
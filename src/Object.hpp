@@ -14,6 +14,7 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtx/string_cast.hpp>
@@ -32,6 +33,8 @@ typedef struct s_Triangle {
 
 using ptsTab = std::vector<glm::vec3>;
 
+class MeshBVH;
+
 
 /**
  * @class Object
@@ -71,8 +74,38 @@ public:
     float getAmbient() const;
     void setAmbient(float value);
 
-    const std::vector<Triangle>* getTriangles();
-    // virtual void setTriangles() = 0;
+    /**
+     * @brief Renvoie les triangles de l'objet en coordonnées locales (nullptr si l'objet n'a pas de
+     * maillage), dans l'ordre de sa hiérarchie englobante. Vide si le maillage est compressé
+     * (cf. MeshBVH::getTriangle()).
+     */
+    const std::vector<Triangle>* getTriangles() const;
+
+    /**
+     * @brief Renvoie le maillage de l'objet et sa hiérarchie englobante, utilisés par le lancer de
+     * rayons (nullptr si l'objet n'a pas de maillage).
+     */
+    std::shared_ptr<const MeshBVH> getMesh() const;
+
+    /**
+     * @brief Renvoie les sommets de l'objet tels qu'envoyés au VBO, en coordonnées locales :
+     * getVertexStride() vec3 par sommet (position, puis normale et UV s'ils sont actifs).
+     */
+    const ptsTab& getVertexData() const;
+    unsigned int getVertexStride() const;
+
+    /**
+     * @brief Renvoie les indices des triangles tels qu'envoyés à l'EBO (vide pour les objets
+     * dessinés en lignes).
+     */
+    const std::vector<unsigned int>& getTriangleIndexes() const;
+
+    /**
+     * @brief Renvoie true si les fonctions OpenGL ont été chargées (cf. gladLoadGLLoader()). Sans
+     * contexte OpenGL (rendu sans fenêtre, cf. SoftwareRenderer), les objets ne créent aucun
+     * buffer et ne gardent que leurs sommets et leurs indices côté CPU.
+     */
+    static bool hasOpenGL();
 
 protected:
 
@@ -81,13 +114,31 @@ protected:
     glm::vec3 m_color;
     float m_ambient;
 
-    //std::vector<Triangle> m_triangles; TODO
+    std::shared_ptr<const MeshBVH> m_mesh; // Triangles gardés côté CPU pour le lancer de rayons
+
+    ptsTab m_vertexData;                         // Copie du VBO (cf. getVertexData())
+    unsigned int m_vertexStride;                 // vec3 par sommet dans m_vertexData
+    std::vector<unsigned int> m_triangleIndexes; // Copie de l'EBO des triangles
 
     /**
      * @brief Mets à jour le VBO et le VAO avec les nouvelles données en paramètre.
      * @param points Liste des nouveaux points qui seront stockées dans le buffer GPU.
      */
     void updateVertices(ptsTab points);
+
+    /**
+     * @brief Garde une copie des indices des triangles envoyés à l'EBO (cf. getTriangleIndexes()).
+     */
+    void setTriangleIndexes(const std::vector<unsigned int> &indexes);
+
+    /**
+     * @brief Construit les triangles de l'objet et leur hiérarchie englobante.
+     * @param vertices sommets entrelacés tels qu'envoyés au VBO (position en premier).
+     * @param indexes indices des triangles tels qu'envoyés à l'EBO.
+     * @param stride nombre de vec3 par sommet dans vertices.
+     */
+    void setTriangles(const ptsTab &vertices, const std::vector<unsigned int> &indexes,
+        unsigned int stride = 3);
 };
 
 #endif // OBJECT_HPP
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "PNGStreamWriter.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+
+static unsigned char paethPredictor(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if(pa <= pb && pa <= pc) return (unsigned char)a;
+    if(pb <= pc) return (unsigned char)b;
+    return (unsigned char)c;
+}
+
+
+/**
+ * @brief Applique le filtre PNG type (0 à 4) à une ligne, 4 octets par pixel.
+ */
+static void applyFilter(unsigned char* out, const unsigned char* row, const unsigned char* previous,
+    size_t length, unsigned char type)
+{
+    const size_t bpp = 4;
+    out[0] = type;
+    for(size_t i = 0; i < length; ++i) {
+        int a = (i >= bpp) ? row[i - bpp] : 0;
+        int b = previous[i];
+        int c = (i >= bpp) ? previous[i - bpp] : 0;
+
+        switch(type) {
+            case 0: out[i + 1] = row[i]; break;
+            case 1: out[i + 1] = (unsigned char)(row[i] - a); break;
+            case 2: out[i + 1] = (unsigned char)(row[i] - b); break;
+            case 3: out[i + 1] = (unsigned char)(row[i] - ((a + b) >> 1)); break;
+            default: out[i + 1] = (unsigned char)(row[i] - paethPredictor(a, b, c)); break;
+        }
+    }
+}
+
+
+PNGStreamWriter::PNGStreamWriter(const std::string &filename, unsigned int width, unsigned int height,
+    unsigned int preset) :
+    m_file(filename, std::ios::binary),
+    m_width(width),
+    m_height(height),
+    m_rowsWritten(0),
+    m_previousRow(4 * (size_t)width, 0),
+    m_adler(1),
+    m_error(0),
+    m_closed(false)
+{
+    lodepng::State state;
+    Capture::applyPNGPreset(state, preset);
+    m_zlib = state.encoder.zlibsettings;
+    m_filter = state.encoder.filter_strategy;
+
+    if(!m_file) {
+        m_error = 79; // failed to open file for writing
+        return;
+    }
+    if(width == 0 || height == 0) {
+        m_error = 93; // zero width or height is invalid
+        return;
+    }
+
+    // Signature et IHDR : RGBA 8 bits, sans entrelacement
+    const unsigned char signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+    m_file.write((const char*)signature, 8);
+
+    unsigned char header[13] = {
+        (unsigned char)(width >> 24), (unsigned char)(width >> 16), (unsigned char)(width >> 8), (unsigned char)width,
+        (unsigned char)(height >> 24), (unsigned char)(height >> 16), (unsigned char)(height >> 8), (unsigned char)height,
+        8, 6, 0, 0, 0
+    };
+    writeChunk("IHDR", header, 13);
+}
+
+
+PNGStreamWriter::~PNGStreamWriter()
+{
+    if(!m_closed) close();
+}
+
+
+unsigned PNGStreamWriter::writeRows(const unsigned char* rows, unsigned int count)
+{
+    if(m_error) return m_error;
+    if(m_closed || m_rowsWritten + count > m_height) return m_error = 84; // more pixels than the image
+
+    size_t rowBytes = 4 * (size_t)m_width;
+    size_t dictSize = m_stream.size();
+    m_stream.resize(dictSize + count * (rowBytes + 1));
+
+    for(unsigned int r = 0; r < count; ++r) {
+        const unsigned char* row = rows + r * rowBytes;
+        filterRow(&m_stream[dictSize + r * (rowBytes + 1)], row);
+        std::memcpy(m_previousRow.data(), row, rowBytes);
+    }
+    m_rowsWritten += count;
+    unsigned final = (m_rowsWritten == m_height);
+
+    // Compression de la bande à la suite du flux (compressée en parallèle si la bande est grande)
+    unsigned char* deflated = nullptr;
+    size_t deflatedSize = 0;
+    m_error = lodepng_deflate_chunk(&deflated, &deflatedSize, &m_adler, m_stream.data() + dictSize,
+        dictSize, m_stream.size() - dictSize, final, &m_zlib);
+
+    if(!m_error) {
+        // Les données des chunks IDAT mises bout à bout forment le flux zlib : en-tête zlib dans
+        // le premier chunk, somme adler32 dans le dernier
+        std::vector<unsigned char> idat;
+        idat.reserve(deflatedSize + 6);
+        if(dictSize == 0) {
+            idat.push_back(0x78);
+            idat.push_back(0x01);
+        }
+        idat.insert(idat.end(), deflated, deflated + deflatedSize);
+        if(final) {
+            for(int shift = 24; shift >= 0; shift -= 8) idat.push_back((unsigned char)(m_adler >> shift));
+        }
+        writeChunk("IDAT", idat.data(), idat.size());
+    }
+    free(deflated);
+
+    // On ne garde que la fenêtre LZ77 pour la bande suivante
+    if(m_stream.size() > PNG_STREAM_WINDOW)
+        m_stream.erase(m_stream.begin(), m_stream.end() - PNG_STREAM_WINDOW);
+
+    return m_error;
+}
+
+
+unsigned PNGStreamWriter::close()
+{
+    if(m_closed) return m_error;
+    m_closed = true;
+
+    if(!m_error && m_rowsWritten != m_height) m_error = 84; // not all pixels were given
+    if(!m_error) writeChunk("IEND", nullptr, 0);
+
+    m_file.close();
+    if(!m_error && m_file.fail()) m_error = 79;
+    return m_error;
+}
+
+
+unsigned PNGStreamWriter::getError() const {return m_error;}
+
+
+void PNGStreamWriter::filterRow(unsigned char* out, const unsigned char* row)
+{
+    size_t length = 4 * (size_t)m_width;
+
+    if(m_filter <= LFS_FOUR) {
+        applyFilter(out, row, m_previousRow.data(), length, (unsigned char)m_filter);
+        return;
+    }
+
+    // Heuristique "somme minimale" : on garde le filtre dont les valeurs sont les plus proches de 0
+    std::vector<unsigned char> candidate(length + 1);
+    size_t bestSum = (size_t)-1;
+    for(unsigned char type = 0; type <= 4; ++type) {
+        applyFilter(candidate.data(), row, m_previousRow.data(), length, type);
+
+        size_t sum = 0;
+        for(size_t i = 1; i <= length; ++i) sum += (candidate[i] < 128) ? candidate[i] : 256 - candidate[i];
+
+        if(sum < bestSum) {
+            bestSum = sum;
+            std::memcpy(out, candidate.data(), length + 1);
+        }
+    }
+}
+
+
+void PNGStreamWriter::writeChunk(const char* type, const unsigned char* data, size_t size)
+{
+    unsigned char* chunk = nullptr;
+    size_t chunkSize = 0;
+    unsigned error = lodepng_chunk_create(&chunk, &chunkSize, size, type, data);
+    if(error) m_error = error;
+    else m_file.write((const char*)chunk, chunkSize);
+    free(chunk);
+}
@@ -0,0 +1,92 @@
+#ifndef PNG_STREAM_WRITER_HPP
+#define PNG_STREAM_WRITER_HPP
+
+/**
+ * @file PNGStreamWriter.hpp
+ * @brief Définition de la classe PNGStreamWriter.
+ * 
+ * Ce fichier contient un encodeur PNG qui écrit l'image au fur et à mesure, par bandes de lignes,
+ * sans jamais avoir l'image entière en mémoire.
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Capture.hpp"
+
+#define PNG_STREAM_WINDOW 32768 // Taille de la fenêtre LZ77 conservée entre deux bandes
+
+
+/**
+ * @class PNGStreamWriter
+ * @brief Écrit un PNG RGBA 8 bits bande par bande.
+ * 
+ * Chaque bande de lignes reçue est filtrée, compressée à la suite du flux zlib (les 32 Ko
+ * précédents servent de dictionnaire) et écrite immédiatement dans un chunk IDAT. La mémoire
+ * utilisée ne dépend donc que de la taille des bandes et pas de la taille de l'image.
+ * 
+ * Les erreurs sont des codes d'erreur lodepng (cf. lodepng_error_text()).
+ */
+class PNGStreamWriter
+{
+public:
+
+    /**
+     * @brief Ouvre le fichier et écrit l'en-tête de l'image.
+     * @param filename chemin du fichier PNG à écrire.
+     * @param width, height dimensions de l'image.
+     * @param preset préréglage d'encodage PNG_PRESET_* (cf. Capture.hpp).
+     */
+    PNGStreamWriter(const std::string &filename, unsigned int width, unsigned int height,
+        unsigned int preset);
+
+    /**
+     * @brief Termine le fichier s'il ne l'a pas encore été.
+     */
+    ~PNGStreamWriter();
+
+    /**
+     * @brief Ajoute les lignes suivantes de l'image.
+     * @param rows count lignes RGBA 8 bits consécutives (4 * width octets par ligne).
+     * @param count nombre de lignes.
+     * @return le code d'erreur (0 si tout s'est bien passé).
+     */
+    unsigned writeRows(const unsigned char* rows, unsigned int count);
+
+    /**
+     * @brief Termine le fichier. Toutes les lignes de l'image doivent avoir été écrites.
+     * @return le code d'erreur (0 si tout s'est bien passé).
+     */
+    unsigned close();
+
+    unsigned getError() const;
+
+private:
+    std::ofstream m_file;
+    unsigned int m_width;
+    unsigned int m_height;
+    unsigned int m_rowsWritten;
+
+    LodePNGCompressSettings m_zlib;
+    LodePNGFilterStrategy m_filter;
+
+    std::vector<unsigned char> m_previousRow; // Ligne précédente non filtrée
+    std::vector<unsigned char> m_stream;      // Fin du flux déjà compressé (dictionnaire) + bande
+    unsigned m_adler;
+    unsigned m_error;
+    bool m_closed;
+
+    /**
+     * @brief Filtre une ligne (octet de type de filtre + données) d'après la stratégie du
+     * préréglage. Les stratégies adaptatives utilisent l'heuristique "somme minimale".
+     */
+    void filterRow(unsigned char* out, const unsigned char* row);
+
+    void writeChunk(const char* type, const unsigned char* data, size_t size);
+};
+
+#endif // PNG_STREAM_WRITER_HPP
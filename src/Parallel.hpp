@@ -0,0 +1,53 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+/**
+ * @file Parallel.hpp
+ * @brief Boucles parallèles.
+ * 
+ * Ce fichier contient les fonctions qui répartissent un calcul sur tous les coeurs de la machine
+ * (lancer de rayons, compression, etc).
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Renvoie le nombre de threads à utiliser pour les calculs parallèles (au moins 1).
+ */
+inline unsigned int threadCount()
+{
+    unsigned int count = std::thread::hardware_concurrency();
+    return (count == 0) ? 1 : count;
+}
+
+/**
+ * @brief Appelle func(i) pour chaque i de [begin; end[ sur threadCount() threads.
+ * 
+ * Les indices sont distribués un par un à la demande, ce qui équilibre la charge quand le coût
+ * varie d'un indice à l'autre (lignes d'image plus ou moins remplies d'objets par exemple).
+ * func doit donc pouvoir être appelée depuis plusieurs threads à la fois.
+ */
+template<typename Function>
+void parallelFor(size_t begin, size_t end, Function func)
+{
+    if(end <= begin) return;
+
+    std::atomic<size_t> next(begin);
+    auto worker = [&]() {
+        for(size_t i = next++; i < end; i = next++) func(i);
+    };
+
+    size_t count = std::min<size_t>(threadCount(), end - begin);
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < count; ++i) threads.emplace_back(worker);
+    worker();
+    for(std::thread &thread : threads) thread.join();
+}
+
+#endif // PARALLEL_HPP
@@ -0,0 +1,133 @@
+#include "PhotonMap.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <glm/gtc/constants.hpp>
+
+
+PhotonMap::PhotonMap() {}
+
+
+void PhotonMap::build(std::vector<Photon> photons)
+{
+    m_photons = std::move(photons);
+    balance(0, m_photons.size());
+}
+
+
+void PhotonMap::clear() {m_photons.clear();}
+bool PhotonMap::empty() const {return m_photons.empty();}
+size_t PhotonMap::size() const {return m_photons.size();}
+const std::vector<Photon>& PhotonMap::getPhotons() const {return m_photons;}
+
+
+void PhotonMap::balance(size_t begin, size_t end)
+{
+    if(end - begin <= 1) {
+        if(end > begin) m_photons[begin].axis = 0;
+        return;
+    }
+
+    // Axe le plus étendu de l'intervalle
+    glm::vec3 boundsMin(std::numeric_limits<float>::max());
+    glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+    for(size_t i = begin; i < end; ++i) {
+        boundsMin = glm::min(boundsMin, m_photons[i].position);
+        boundsMax = glm::max(boundsMax, m_photons[i].position);
+    }
+    glm::vec3 extent = boundsMax - boundsMin;
+    unsigned int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z) ? 1 : 2;
+
+    size_t middle = begin + (end - begin) / 2;
+    std::nth_element(m_photons.begin() + begin, m_photons.begin() + middle, m_photons.begin() + end,
+        [axis](const Photon &a, const Photon &b) {return a.position[axis] < b.position[axis];});
+    m_photons[middle].axis = axis;
+
+    // Les deux moitiés sont disjointes : la première est confiée à un autre thread
+    if(end - begin >= PHOTON_TASK_THRESHOLD) {
+        TaskGroup group;
+        group.run([this, begin, middle]() {balance(begin, middle);});
+        balance(middle + 1, end);
+    }
+    else {
+        balance(begin, middle);
+        balance(middle + 1, end);
+    }
+}
+
+
+void PhotonMap::gather(size_t begin, size_t end, const glm::vec3 &position, unsigned int k, Neighbour* heap,
+    unsigned int &count, float &radius2) const
+{
+    if(begin >= end) return;
+
+    size_t middle = begin + (end - begin) / 2;
+    const Photon &photon = m_photons[middle];
+    float delta = position[photon.axis] - photon.position[photon.axis];
+
+    // Côté du point d'abord, l'autre côté seulement si le plan est plus proche que le plus loin retenu
+    if(delta < 0.0f) gather(begin, middle, position, k, heap, count, radius2);
+    else gather(middle + 1, end, position, k, heap, count, radius2);
+
+    glm::vec3 offset = photon.position - position;
+    float distance2 = glm::dot(offset, offset);
+    if(distance2 < radius2) {
+        if(count < k) {
+            heap[count++] = {distance2, (unsigned int)middle};
+            std::push_heap(heap, heap + count);
+        }
+        else {
+            std::pop_heap(heap, heap + count);
+            heap[count - 1] = {distance2, (unsigned int)middle};
+            std::push_heap(heap, heap + count);
+        }
+        if(count == k) radius2 = heap[0].distance2;
+    }
+
+    if(delta * delta < radius2) {
+        if(delta < 0.0f) gather(middle + 1, end, position, k, heap, count, radius2);
+        else gather(begin, middle, position, k, heap, count, radius2);
+    }
+}
+
+
+unsigned int PhotonMap::search(const glm::vec3 &position, unsigned int k, float maxRadius, Neighbour* heap,
+    float &radius2) const
+{
+    unsigned int count = 0;
+    radius2 = maxRadius * maxRadius;
+    gather(0, m_photons.size(), position, std::min(k, (unsigned int)PHOTON_MAX_GATHER), heap, count, radius2);
+    return count;
+}
+
+
+void PhotonMap::nearest(const glm::vec3 &position, unsigned int k, float maxRadius,
+    std::vector<unsigned int> &neighbours, float &radius2) const
+{
+    Neighbour heap[PHOTON_MAX_GATHER];
+    unsigned int count = search(position, k, maxRadius, heap, radius2);
+
+    neighbours.resize(count);
+    for(unsigned int i = 0; i < count; ++i) neighbours[i] = heap[i].index;
+}
+
+
+glm::vec3 PhotonMap::irradiance(const glm::vec3 &position, const glm::vec3 &normal, unsigned int k,
+    float maxRadius) const
+{
+    Neighbour heap[PHOTON_MAX_GATHER];
+    float radius2;
+    unsigned int count = search(position, k, maxRadius, heap, radius2);
+    if(count == 0) return glm::vec3(0.0f);
+
+    glm::vec3 power(0.0f);
+    for(unsigned int i = 0; i < count; ++i) {
+        const Photon &photon = m_photons[heap[i].index];
+        if(glm::dot(photon.direction, normal) < 0.0f) power += photon.power;
+    }
+
+    // Disque du plus éloigné retenu, ou de maxRadius s'il y a moins de k photons
+    if(count < k) radius2 = maxRadius * maxRadius;
+    return power / (glm::pi<float>() * radius2);
+}
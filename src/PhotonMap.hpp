@@ -0,0 +1,104 @@
+#ifndef PHOTON_MAP_HPP
+#define PHOTON_MAP_HPP
+
+/**
+ * @file PhotonMap.hpp
+ * @brief Définition de la classe PhotonMap.
+ * 
+ * Ce fichier contient la carte de photons des caustiques : les photons déposés sur les surfaces
+ * après au moins un reflet, rangés dans un arbre kd pour retrouver rapidement les plus proches d'un
+ * point.
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#define PHOTON_TASK_THRESHOLD 16384 // En dessous, un sous-arbre est équilibré d'un bloc
+#define PHOTON_MAX_GATHER 128       // Nombre maximal de voisins d'une estimation
+
+
+/**
+ * @brief Photon déposé sur une surface.
+ */
+typedef struct s_Photon {
+    glm::vec3 position;
+    glm::vec3 power;     // Flux transporté, en unités de couleur
+    glm::vec3 direction; // Direction d'arrivée
+    unsigned int axis;   // Axe de séparation du noeud de l'arbre kd
+} Photon;
+
+
+/**
+ * @class PhotonMap
+ * @brief Arbre kd équilibré et implicite : dans chaque intervalle de photons, le photon du milieu
+ * est la médiane sur l'axe le plus étendu, ceux qui le précèdent sont d'un côté et ceux qui le
+ * suivent de l'autre. Aucun pointeur n'est stocké.
+ * 
+ * L'équilibrage (un std::nth_element par noeud) confie un des deux sous-arbres à un autre thread
+ * tant qu'il compte plus de PHOTON_TASK_THRESHOLD photons, comme la construction des hiérarchies
+ * englobantes (cf. BVHBuilder). La carte est ensuite en lecture seule et peut être interrogée
+ * depuis plusieurs threads à la fois.
+ */
+class PhotonMap
+{
+public:
+    PhotonMap();
+
+    /**
+     * @brief Remplace les photons de la carte et équilibre l'arbre.
+     */
+    void build(std::vector<Photon> photons);
+
+    void clear();
+    bool empty() const;
+    size_t size() const;
+
+    /**
+     * @brief Estime l'éclairement au point position à partir de ses k plus proches photons (au plus
+     * PHOTON_MAX_GATHER) dans un rayon de maxRadius : somme de leur flux divisée par l'aire du disque
+     * qui les contient. Seuls les photons arrivés du côté de normal sont comptés.
+     */
+    glm::vec3 irradiance(const glm::vec3 &position, const glm::vec3 &normal, unsigned int k,
+        float maxRadius) const;
+
+    /**
+     * @brief Renvoie dans neighbours les indices (dans getPhotons()) des k plus proches photons dans
+     * un rayon de maxRadius, et dans radius2 le carré de la distance du plus éloigné retenu.
+     */
+    void nearest(const glm::vec3 &position, unsigned int k, float maxRadius,
+        std::vector<unsigned int> &neighbours, float &radius2) const;
+
+    const std::vector<Photon>& getPhotons() const;
+
+private:
+    std::vector<Photon> m_photons;
+
+    /**
+     * @brief Voisin candidat d'une recherche (tas de distance maximale en tête).
+     */
+    typedef struct s_Neighbour {
+        float distance2;
+        unsigned int index;
+        bool operator<(const s_Neighbour &other) const {return distance2 < other.distance2;}
+    } Neighbour;
+
+    void balance(size_t begin, size_t end);
+
+    /**
+     * @brief Cherche les plus proches voisins dans l'intervalle [begin; end[ de l'arbre.
+     * @param radius2 carré de la distance de recherche, réduit dès que heap est plein.
+     */
+    void gather(size_t begin, size_t end, const glm::vec3 &position, unsigned int k, Neighbour* heap,
+        unsigned int &count, float &radius2) const;
+
+    /**
+     * @brief Remplit heap avec les k plus proches voisins et renvoie leur nombre.
+     */
+    unsigned int search(const glm::vec3 &position, unsigned int k, float maxRadius, Neighbour* heap,
+        float &radius2) const;
+};
+
+#endif // PHOTON_MAP_HPP
@@ -0,0 +1,490 @@
+#include "QuantizedBVH.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+#include "TriangleIntersection.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+/**
+ * @brief Clé de fusion des sommets : leurs trois coordonnées bit à bit.
+ */
+typedef struct s_VertexKey {
+    unsigned int bits[3];
+    bool operator==(const s_VertexKey &other) const
+    {
+        return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+    }
+} VertexKey;
+
+typedef struct s_VertexKeyHash {
+    size_t operator()(const VertexKey &key) const
+    {
+        return (size_t)key.bits[0] * 73856093u ^ (size_t)key.bits[1] * 19349663u ^ (size_t)key.bits[2] * 83492791u;
+    }
+} VertexKeyHash;
+
+
+/**
+ * @brief Coordonnée quantifiée d'un sommet sur la boîte du maillage (cf. encodeVertices()).
+ */
+static unsigned short quantize(float value, float origin, float scale)
+{
+    float q = (scale > 0.0f) ? std::round((value - origin) / scale) : 0.0f;
+    return (unsigned short)std::min(std::max(q, 0.0f), QBVH_VERTEX_STEPS);
+}
+
+
+/**
+ * @brief Demi-aire d'une boîte, pour choisir le noeud binaire à ouvrir.
+ */
+static float halfArea(const BVHNode &node)
+{
+    glm::vec3 extent = node.boundsMax - node.boundsMin;
+    return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+
+/**
+ * @brief Borne décodée (même calcul que le parcours).
+ */
+static inline float decodeBound(float origin, unsigned int q, float scale)
+{
+    return origin + (float)q * scale;
+}
+
+
+QuantizedBVH::QuantizedBVH() :
+    m_vertexOrigin(0.0f),
+    m_vertexScale(0.0f)
+{}
+
+
+QuantizedBVH::QuantizedBVH(const std::vector<BVHNode> &binaryNodes, const std::vector<Triangle> &triangles,
+    std::vector<unsigned int>* order) :
+    m_vertexOrigin(0.0f),
+    m_vertexScale(0.0f)
+{
+    if(binaryNodes.empty()) return;
+
+    std::vector<unsigned int> indexes;
+    encodeVertices(triangles, indexes);
+
+    // Boîtes recalculées sur les triangles décodés (les fils sont toujours après leur parent)
+    std::vector<BVHNode> nodes = binaryNodes;
+    for(size_t i = nodes.size(); i-- > 0;) {
+        BVHNode &node = nodes[i];
+        if(node.count == 0) {
+            node.boundsMin = glm::min(nodes[node.first].boundsMin, nodes[node.first + 1].boundsMin);
+            node.boundsMax = glm::max(nodes[node.first].boundsMax, nodes[node.first + 1].boundsMax);
+            continue;
+        }
+
+        node.boundsMin = glm::vec3(std::numeric_limits<float>::infinity());
+        node.boundsMax = glm::vec3(-std::numeric_limits<float>::infinity());
+        for(unsigned int j = 3 * node.first; j < 3 * (node.first + node.count); ++j) {
+            glm::vec3 vertex = decodeVertex(indexes[j]);
+            node.boundsMin = glm::min(node.boundsMin, vertex);
+            node.boundsMax = glm::max(node.boundsMax, vertex);
+        }
+    }
+
+    // Parcours en largeur : les fils d'un noeud sont créés côte à côte, et les triangles de ses
+    // feuilles sont recopiés côte à côte, dans l'ordre des fils
+    std::vector<unsigned int> pending(1, 0);
+    m_nodes.push_back(QuantizedBVHNode());
+    m_indexes.reserve(indexes.size());
+
+    for(size_t current = 0; current < m_nodes.size(); ++current)
+    {
+        // Les fils gardent l'ordre de la hiérarchie binaire : le fils droit d'un noeud ouvert
+        // prend la place qui suit son fils gauche
+        unsigned int children[QBVH_WIDTH];
+        unsigned int childCount = 1;
+        children[0] = pending[current];
+        if(nodes[children[0]].count == 0) {
+            children[0] = nodes[pending[current]].first;
+            children[1] = nodes[pending[current]].first + 1;
+            childCount = 2;
+        }
+
+        while(childCount < QBVH_WIDTH)
+        {
+            int largest = -1;
+            float largestArea = -1.0f;
+            for(unsigned int i = 0; i < childCount; ++i) {
+                const BVHNode &node = nodes[children[i]];
+                if(node.count == 0 && halfArea(node) > largestArea) {
+                    largest = i;
+                    largestArea = halfArea(node);
+                }
+            }
+            if(largest < 0) break;
+
+            unsigned int opened = children[largest];
+            for(unsigned int i = childCount; i > (unsigned int)largest + 1; --i) children[i] = children[i - 1];
+            children[largest] = nodes[opened].first;
+            children[largest + 1] = nodes[opened].first + 1;
+            ++childCount;
+        }
+
+        QuantizedBVHNode node;
+        node.firstNode = m_nodes.size();
+        node.firstTriangle = m_indexes.size() / 3;
+
+        const BVHNode* childNodes[QBVH_WIDTH];
+        for(unsigned int i = 0; i < QBVH_WIDTH; ++i)
+        {
+            if(i >= childCount) {
+                node.count[i] = QBVH_EMPTY;
+                continue;
+            }
+
+            const BVHNode &child = nodes[children[i]];
+            childNodes[i] = &child;
+            node.count[i] = child.count;
+
+            if(child.count == 0) {
+                m_nodes.push_back(QuantizedBVHNode());
+                pending.push_back(children[i]);
+            }
+            else {
+                m_indexes.insert(m_indexes.end(), indexes.begin() + 3 * child.first,
+                    indexes.begin() + 3 * (child.first + child.count));
+                if(order) for(unsigned int j = 0; j < child.count; ++j) order->push_back(child.first + j);
+            }
+        }
+
+        encodeNode(node, childNodes, childCount);
+        m_nodes[current] = node;
+    }
+
+    m_nodes.shrink_to_fit();
+}
+
+
+void QuantizedBVH::encodeVertices(const std::vector<Triangle> &triangles, std::vector<unsigned int> &indexes)
+{
+    // Fusion des sommets identiques
+    std::unordered_map<VertexKey, unsigned int, VertexKeyHash> vertexIndex;
+    std::vector<glm::vec3> vertices;
+    indexes.resize(3 * triangles.size());
+
+    glm::vec3 boundsMin(std::numeric_limits<float>::infinity());
+    glm::vec3 boundsMax(-std::numeric_limits<float>::infinity());
+
+    for(size_t i = 0; i < triangles.size(); ++i) {
+        const glm::vec3* corners[3] = {&triangles[i].a, &triangles[i].b, &triangles[i].c};
+        for(unsigned int k = 0; k < 3; ++k) {
+            VertexKey key;
+            std::memcpy(key.bits, corners[k], sizeof(key.bits));
+
+            auto inserted = vertexIndex.insert({key, (unsigned int)vertices.size()});
+            if(inserted.second) {
+                vertices.push_back(*corners[k]);
+                boundsMin = glm::min(boundsMin, *corners[k]);
+                boundsMax = glm::max(boundsMax, *corners[k]);
+            }
+            indexes[3 * i + k] = inserted.first->second;
+        }
+    }
+
+    if(vertices.empty()) return;
+
+    m_vertexOrigin = boundsMin;
+    m_vertexScale = (boundsMax - boundsMin) / QBVH_VERTEX_STEPS;
+
+    m_vertices.resize(3 * vertices.size());
+    for(size_t i = 0; i < vertices.size(); ++i) {
+        for(unsigned int axis = 0; axis < 3; ++axis)
+            m_vertices[3 * i + axis] = quantize(vertices[i][axis], m_vertexOrigin[axis], m_vertexScale[axis]);
+    }
+}
+
+
+void QuantizedBVH::encodeNode(QuantizedBVHNode &node, const BVHNode* children[QBVH_WIDTH],
+    unsigned int childCount)
+{
+    node.childCount = childCount;
+
+    for(unsigned int axis = 0; axis < 3; ++axis)
+    {
+        float lo = std::numeric_limits<float>::infinity(), hi = -std::numeric_limits<float>::infinity();
+        for(unsigned int i = 0; i < childCount; ++i) {
+            lo = std::min(lo, children[i]->boundsMin[axis]);
+            hi = std::max(hi, children[i]->boundsMax[axis]);
+        }
+
+        // Plus petite puissance de deux telle que 255 pas couvrent la boîte du parent
+        int exponent = -126;
+        if(hi > lo) exponent = std::max(exponent, (int)std::ceil(std::log2((hi - lo) / QBVH_NODE_STEPS)));
+        while(exponent < 127 && decodeBound(lo, 255, std::ldexp(1.0f, exponent)) < hi) ++exponent;
+        float scale = std::ldexp(1.0f, exponent);
+
+        node.origin[axis] = lo;
+        node.exponent[axis] = (signed char)exponent;
+
+        for(unsigned int i = 0; i < QBVH_WIDTH; ++i)
+        {
+            if(i >= childCount) {
+                // Boîte vide : jamais touchée, de toute façon écartée par son count
+                node.qMin[axis][i] = 255;
+                node.qMax[axis][i] = 0;
+                continue;
+            }
+
+            // Arrondi vers l'extérieur, vérifié avec le calcul du décodage
+            float cMin = children[i]->boundsMin[axis], cMax = children[i]->boundsMax[axis];
+            int qMin = std::min(std::max((int)std::floor((cMin - lo) / scale), 0), 255);
+            int qMax = std::min(std::max((int)std::ceil((cMax - lo) / scale), 0), 255);
+            while(qMin > 0 && decodeBound(lo, qMin, scale) > cMin) --qMin;
+            while(qMax < 255 && decodeBound(lo, qMax, scale) < cMax) ++qMax;
+
+            node.qMin[axis][i] = (unsigned char)qMin;
+            node.qMax[axis][i] = (unsigned char)qMax;
+        }
+    }
+}
+
+
+glm::vec3 QuantizedBVH::decodeVertex(unsigned int vertex) const
+{
+    return m_vertexOrigin + glm::vec3(m_vertices[3 * vertex], m_vertices[3 * vertex + 1],
+        m_vertices[3 * vertex + 2]) * m_vertexScale;
+}
+
+
+/**
+ * @brief Décode et teste les quatre boîtes d'un noeud (cf. WideBVH::intersectChildren()).
+ * @return masque des fils touchés.
+ */
+static unsigned int intersectQuantizedChildren(const QuantizedBVHNode &node, const glm::vec3 &origin,
+    const glm::vec3 &invDir, float tMax, float distances[QBVH_WIDTH])
+{
+#if defined(__SSE2__)
+    __m128 enter = _mm_setzero_ps();
+    __m128 exit = _mm_set1_ps(tMax);
+    __m128i zero = _mm_setzero_si128();
+
+    for(unsigned int axis = 0; axis < 3; ++axis)
+    {
+        int qMinBits, qMaxBits;
+        std::memcpy(&qMinBits, node.qMin[axis], sizeof(int));
+        std::memcpy(&qMaxBits, node.qMax[axis], sizeof(int));
+        __m128 qMin = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(qMinBits), zero), zero));
+        __m128 qMax = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(qMaxBits), zero), zero));
+
+        __m128 lo = _mm_set1_ps(node.origin[axis]);
+        __m128 scale = _mm_set1_ps(std::ldexp(1.0f, node.exponent[axis]));
+        __m128 o = _mm_set1_ps(origin[axis]);
+        __m128 inv = _mm_set1_ps(invDir[axis]);
+
+        __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(lo, _mm_mul_ps(qMin, scale)), o), inv);
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(lo, _mm_mul_ps(qMax, scale)), o), inv);
+        enter = _mm_max_ps(enter, _mm_min_ps(t0, t1));
+        exit = _mm_min_ps(exit, _mm_max_ps(t0, t1));
+    }
+
+    int countBits;
+    std::memcpy(&countBits, node.count, sizeof(int));
+    __m128i empty = _mm_cmpeq_epi32(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(countBits), zero), zero),
+        _mm_set1_epi32(QBVH_EMPTY));
+    __m128 hit = _mm_andnot_ps(_mm_castsi128_ps(empty), _mm_cmple_ps(enter, exit));
+
+    _mm_storeu_ps(distances, enter);
+    return (unsigned int)_mm_movemask_ps(hit);
+#else
+    unsigned int mask = 0;
+    for(unsigned int i = 0; i < QBVH_WIDTH; ++i) {
+        if(node.count[i] == QBVH_EMPTY) continue;
+
+        BVHNode box;
+        for(unsigned int axis = 0; axis < 3; ++axis) {
+            float scale = std::ldexp(1.0f, node.exponent[axis]);
+            box.boundsMin[axis] = decodeBound(node.origin[axis], node.qMin[axis][i], scale);
+            box.boundsMax[axis] = decodeBound(node.origin[axis], node.qMax[axis][i], scale);
+        }
+        distances[i] = intersectBounds(box, origin, invDir, tMax);
+        if(distances[i] != std::numeric_limits<float>::infinity()) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+
+bool QuantizedBVH::intersect(const glm::vec3 &origin, const glm::vec3 &direction, float tMin, float &t,
+    unsigned int &triangle, bool anyHit) const
+{
+    if(m_nodes.empty()) return false;
+
+    glm::vec3 invDir = 1.0f / direction;
+    WatertightRay wray = TriangleIntersection::prepare(origin, direction);
+    bool hit = false;
+
+    // Fils mis de côté : noeud ou feuille (first, count) et distance d'entrée
+    unsigned int stackFirst[QBVH_STACK_SIZE];
+    unsigned int stackCount[QBVH_STACK_SIZE];
+    float stackDistance[QBVH_STACK_SIZE];
+    unsigned int stackSize = 1;
+    stackFirst[0] = 0;
+    stackCount[0] = 0;
+    stackDistance[0] = 0.0f;
+
+    while(stackSize > 0)
+    {
+        --stackSize;
+        if(stackDistance[stackSize] > t) continue;
+
+        unsigned int first = stackFirst[stackSize];
+        unsigned int count = stackCount[stackSize];
+
+        while(count == 0)
+        {
+            const QuantizedBVHNode &node = m_nodes[first];
+            float distances[QBVH_WIDTH];
+            unsigned int mask = intersectQuantizedChildren(node, origin, invDir, t, distances);
+            if(mask == 0) break;
+
+            // Début de chaque fils : noeuds et triangles sont rangés dans l'ordre des fils
+            unsigned int childFirst[QBVH_WIDTH];
+            unsigned int nextNode = node.firstNode, nextTriangle = node.firstTriangle;
+            for(unsigned int i = 0; i < node.childCount; ++i) {
+                childFirst[i] = (node.count[i] == 0) ? nextNode++ : nextTriangle;
+                if(node.count[i] != 0) nextTriangle += node.count[i];
+            }
+
+            // Tri par insertion des fils touchés, du plus lointain au plus proche
+            unsigned int sorted[QBVH_WIDTH];
+            unsigned int sortedSize = 0;
+            for(unsigned int i = 0; i < QBVH_WIDTH; ++i) {
+                if(!(mask & (1u << i))) continue;
+                unsigned int j = sortedSize++;
+                while(j > 0 && distances[sorted[j - 1]] < distances[i]) {
+                    sorted[j] = sorted[j - 1];
+                    --j;
+                }
+                sorted[j] = i;
+            }
+
+            for(unsigned int j = 0; j + 1 < sortedSize; ++j) {
+                stackFirst[stackSize] = childFirst[sorted[j]];
+                stackCount[stackSize] = node.count[sorted[j]];
+                stackDistance[stackSize++] = distances[sorted[j]];
+            }
+
+            first = childFirst[sorted[sortedSize - 1]];
+            count = node.count[sorted[sortedSize - 1]];
+        }
+
+        if(count == 0) continue;
+
+        // Feuille décodée dans un paquet (les emplacements libres répètent le dernier triangle)
+        TrianglePacket packet;
+        for(unsigned int lane = 0; lane < TRIANGLE_PACKET_SIZE; ++lane) {
+            unsigned int index = first + std::min(lane, count - 1);
+            TriangleIntersection::setPacketTriangle(packet, lane, getTriangle(index), index);
+        }
+
+        float u, v;
+        int lane = TriangleIntersection::intersectPacket(wray, packet, tMin, t, u, v);
+        if(lane >= 0) {
+            triangle = packet.triangles[lane];
+            if(anyHit) return true;
+            hit = true;
+        }
+    }
+
+    return hit;
+}
+
+
+Triangle QuantizedBVH::getTriangle(unsigned int index) const
+{
+    return {decodeVertex(m_indexes[3 * index]), decodeVertex(m_indexes[3 * index + 1]),
+        decodeVertex(m_indexes[3 * index + 2])};
+}
+
+
+unsigned int QuantizedBVH::getTriangleCount() const {return m_indexes.size() / 3;}
+bool QuantizedBVH::empty() const {return m_nodes.empty();}
+
+
+bool QuantizedBVH::matches(const std::vector<Triangle> &triangles, const std::vector<unsigned int> &order) const
+{
+    if(triangles.size() != getTriangleCount() || order.size() != triangles.size()) return false;
+    if(triangles.empty()) return true;
+
+    // Même boîte, donc même quantification
+    glm::vec3 boundsMin(std::numeric_limits<float>::infinity());
+    glm::vec3 boundsMax(-std::numeric_limits<float>::infinity());
+    for(const Triangle &triangle : triangles) {
+        boundsMin = glm::min(boundsMin, glm::min(triangle.a, glm::min(triangle.b, triangle.c)));
+        boundsMax = glm::max(boundsMax, glm::max(triangle.a, glm::max(triangle.b, triangle.c)));
+    }
+    glm::vec3 scale = (boundsMax - boundsMin) / QBVH_VERTEX_STEPS;
+    if(std::memcmp(&boundsMin, &m_vertexOrigin, sizeof(glm::vec3)) != 0
+        || std::memcmp(&scale, &m_vertexScale, sizeof(glm::vec3)) != 0) return false;
+
+    // Chaque sommet distinct de triangles doit correspondre à un seul sommet gardé, et
+    // réciproquement, avec les mêmes coordonnées quantifiées
+    std::unordered_map<VertexKey, unsigned int, VertexKeyHash> vertexIndex;
+    std::vector<bool> used(m_vertices.size() / 3, false);
+
+    for(size_t i = 0; i < order.size(); ++i) {
+        const Triangle &triangle = triangles[order[i]];
+        const glm::vec3* corners[3] = {&triangle.a, &triangle.b, &triangle.c};
+        for(unsigned int k = 0; k < 3; ++k) {
+            unsigned int vertex = m_indexes[3 * i + k];
+            VertexKey key;
+            std::memcpy(key.bits, corners[k], sizeof(key.bits));
+
+            auto inserted = vertexIndex.insert({key, vertex});
+            if(!inserted.second) {
+                if(inserted.first->second != vertex) return false;
+                continue;
+            }
+            if(used[vertex]) return false;
+            used[vertex] = true;
+
+            for(unsigned int axis = 0; axis < 3; ++axis) {
+                if(quantize((*corners[k])[axis], m_vertexOrigin[axis], m_vertexScale[axis])
+                    != m_vertices[3 * vertex + axis]) return false;
+            }
+        }
+    }
+    return vertexIndex.size() == used.size();
+}
+
+
+void QuantizedBVH::getBounds(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const
+{
+    boundsMin = glm::vec3(0.0f);
+    boundsMax = glm::vec3(0.0f);
+    if(m_nodes.empty()) return;
+
+    const QuantizedBVHNode &root = m_nodes[0];
+    for(unsigned int axis = 0; axis < 3; ++axis) {
+        float scale = std::ldexp(1.0f, root.exponent[axis]);
+        unsigned int qMin = 255, qMax = 0;
+        for(unsigned int i = 0; i < root.childCount; ++i) {
+            qMin = std::min(qMin, (unsigned int)root.qMin[axis][i]);
+            qMax = std::max(qMax, (unsigned int)root.qMax[axis][i]);
+        }
+        boundsMin[axis] = decodeBound(root.origin[axis], qMin, scale);
+        boundsMax[axis] = decodeBound(root.origin[axis], qMax, scale);
+    }
+}
+
+
+size_t QuantizedBVH::memoryUsage() const
+{
+    return m_nodes.size() * sizeof(QuantizedBVHNode) + m_vertices.size() * sizeof(unsigned short)
+        + m_indexes.size() * sizeof(unsigned int);
+}
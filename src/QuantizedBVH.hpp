@@ -0,0 +1,122 @@
+#ifndef QUANTIZED_BVH_HPP
+#define QUANTIZED_BVH_HPP
+
+/**
+ * @file QuantizedBVH.hpp
+ * @brief Définition de la classe QuantizedBVH.
+ *
+ * Ce fichier contient la version compressée d'un maillage et de sa hiérarchie englobante, pour les
+ * maillages trop grands pour être gardés en précision flottante complète : boîtes des fils codées
+ * sur 8 bits par rapport à la boîte de leur parent, sommets partagés et codés sur 16 bits.
+ *
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "BVHBuilder.hpp"
+#include "Object.hpp"
+
+#define QBVH_WIDTH 4              // Fils par noeud
+#define QBVH_STACK_SIZE 128       // Profondeur maximale du parcours
+#define QBVH_EMPTY 0xFF           // count d'un emplacement de fils inutilisé
+#define QBVH_NODE_STEPS 255.0f    // Pas de quantification des boîtes (8 bits)
+#define QBVH_VERTEX_STEPS 65535.0f // Pas de quantification des sommets (16 bits)
+
+static_assert(QBVH_STACK_SIZE >= (QBVH_WIDTH - 1) * BVH_MAX_DEPTH + 1, "QBVH_STACK_SIZE trop petit pour BVH_MAX_DEPTH");
+
+
+/**
+ * @brief Noeud à quatre fils compressé (52 octets, contre 128 pour WideBVHNode).
+ *
+ * La boîte du fils i sur l'axe a est [origin[a] + qMin[a][i] * 2^exponent[a],
+ * origin[a] + qMax[a][i] * 2^exponent[a]], arrondie vers l'extérieur à l'encodage : elle contient
+ * toujours la boîte exacte. count[i] vaut 0 pour un noeud, le nombre de triangles pour une feuille
+ * et QBVH_EMPTY pour un emplacement inutilisé. Les noeuds fils sont rangés côte à côte à partir de
+ * firstNode, les triangles des feuilles côte à côte à partir de firstTriangle, dans l'ordre des fils.
+ */
+typedef struct s_QuantizedBVHNode {
+    float origin[3];
+    signed char exponent[3];
+    unsigned char childCount;
+    unsigned int firstNode;
+    unsigned int firstTriangle;
+    unsigned char count[QBVH_WIDTH];
+    unsigned char qMin[3][QBVH_WIDTH];
+    unsigned char qMax[3][QBVH_WIDTH];
+} QuantizedBVHNode;
+
+
+/**
+ * @class QuantizedBVH
+ * @brief Maillage indexé à sommets quantifiés et hiérarchie à quatre fils à boîtes quantifiées.
+ *
+ * Les sommets identiques sont fusionnés avant d'être quantifiés sur la boîte du maillage : deux
+ * triangles qui partagent une arête la retrouvent donc exactement après décodage, et le test
+ * étanche de TriangleIntersection ne laisse passer aucun rayon entre eux. Les boîtes sont calculées
+ * sur les triangles décodés, puis arrondies vers l'extérieur : le parcours ne manque aucun triangle.
+ */
+class QuantizedBVH
+{
+public:
+
+    QuantizedBVH();
+
+    /**
+     * @brief Compresse un maillage et sa hiérarchie binaire (cf. BVHBuilder).
+     * @param binaryNodes hiérarchie binaire, feuilles désignant des suites de triangles.
+     * @param triangles triangles dans l'ordre des feuilles de binaryNodes.
+     * @param order s'il est donné, reçoit pour chaque triangle de la version compressée son indice
+     * dans triangles.
+     */
+    QuantizedBVH(const std::vector<BVHNode> &binaryNodes, const std::vector<Triangle> &triangles,
+        std::vector<unsigned int>* order = nullptr);
+
+    /**
+     * @brief Cherche le triangle le plus proche touché par le rayon (cf. MeshBVH::intersect()).
+     * @param tMin distance minimale acceptée.
+     * @param anyHit s'arrêter au premier triangle touché avant t, pas forcément le plus proche.
+     */
+    bool intersect(const glm::vec3 &origin, const glm::vec3 &direction, float tMin, float &t,
+        unsigned int &triangle, bool anyHit = false) const;
+
+    /**
+     * @brief Décode le triangle d'indice index (ordre propre à la version compressée).
+     */
+    Triangle getTriangle(unsigned int index) const;
+
+    unsigned int getTriangleCount() const;
+    bool empty() const;
+
+    /**
+     * @brief Renvoie true si triangles, une fois quantifiés, donnent exactement les mêmes sommets et
+     * les mêmes indices que cette version compressée (à la numérotation des sommets près).
+     * @param order indice dans triangles de chaque triangle de la version compressée.
+     */
+    bool matches(const std::vector<Triangle> &triangles, const std::vector<unsigned int> &order) const;
+
+    /**
+     * @brief Renvoie la boîte englobante décodée de la racine (contient tous les triangles décodés).
+     */
+    void getBounds(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const;
+
+    /**
+     * @brief Renvoie la mémoire occupée par les noeuds, les sommets et les indices, en octets.
+     */
+    size_t memoryUsage() const;
+
+private:
+    std::vector<QuantizedBVHNode> m_nodes;
+    std::vector<unsigned short> m_vertices; // x, y, z quantifiés par sommet
+    std::vector<unsigned int> m_indexes;    // Trois sommets par triangle
+    glm::vec3 m_vertexOrigin;
+    glm::vec3 m_vertexScale;
+
+    glm::vec3 decodeVertex(unsigned int vertex) const;
+    void encodeVertices(const std::vector<Triangle> &triangles, std::vector<unsigned int> &indexes);
+    void encodeNode(QuantizedBVHNode &node, const BVHNode* children[QBVH_WIDTH], unsigned int childCount);
+};
+
+#endif // QUANTIZED_BVH_HPP
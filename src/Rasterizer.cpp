@@ -0,0 +1,317 @@
+#include "Rasterizer.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+/**
+ * @brief Arête d'un triangle à l'écran. Sa fonction vaut deux fois l'aire signée du triangle
+ * (from, to, point), positive si le point est à gauche de l'arête : sign * (dx * (y - fromY) - dy *
+ * (x - fromX)). Les deux sommets sont toujours pris dans le même ordre (sign vaut -1 s'ils ont été
+ * échangés), ce qui donne exactement l'opposé pour l'arête parcourue dans l'autre sens : deux
+ * triangles voisins ne laissent aucun trou entre eux.
+ */
+typedef struct s_RasterEdge {
+    float fromX, fromY;
+    float dx, dy;
+    float sign;
+    bool owned; // Règle "haut-gauche" : un point exactement sur l'arête appartient au triangle
+} RasterEdge;
+
+
+static RasterEdge makeEdge(const glm::vec3 &from, const glm::vec3 &to)
+{
+    // Un point exactement sur l'arête n'appartient au triangle que pour une des deux orientations
+    float orientedDy = to.y - from.y;
+    bool owned = orientedDy > 0.0f || (orientedDy == 0.0f && to.x < from.x);
+
+    bool swapped = from.x > to.x || (from.x == to.x && from.y > to.y);
+    const glm::vec3 &first = swapped ? to : from;
+    const glm::vec3 &second = swapped ? from : to;
+    return {first.x, first.y, second.x - first.x, second.y - first.y, swapped ? -1.0f : 1.0f, owned};
+}
+
+
+static float evaluateEdge(const RasterEdge &edge, float x, float y)
+{
+    return edge.sign * (edge.dx * (y - edge.fromY) - edge.dy * (x - edge.fromX));
+}
+
+
+/**
+ * @brief Distance (positive à l'intérieur) d'un sommet projeté à un plan de découpage : w minimal,
+ * puis plans proche et lointain.
+ */
+static float planeDistance(const glm::vec4 &vertex, int plane)
+{
+    switch(plane) {
+        case 0: return vertex.w - RASTER_MIN_W;
+        case 1: return vertex.w + vertex.z;
+        default: return vertex.w - vertex.z;
+    }
+}
+
+
+Rasterizer::Rasterizer() :
+    m_width(0),
+    m_height(0),
+    m_tilesX(0),
+    m_viewProjection(1.0f),
+    m_depthClip(false)
+{}
+
+
+void Rasterizer::begin(unsigned int width, unsigned int height, const glm::mat4 &viewProjection,
+    bool depthClip)
+{
+    m_width = width;
+    m_height = height;
+    m_viewProjection = viewProjection;
+    m_depthClip = depthClip;
+    m_triangles.clear();
+
+    m_tilesX = (width + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    unsigned int tilesY = (height + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    m_tiles.resize((size_t)m_tilesX * tilesY);
+    for(std::vector<unsigned int> &tile : m_tiles) tile.clear();
+
+    m_id.assign((size_t)width * height, RASTER_NO_ID);
+    m_primitive.assign((size_t)width * height, 0);
+    m_depth.assign((size_t)width * height, 0.0f);
+}
+
+
+void Rasterizer::addTriangle(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c, unsigned int id,
+    unsigned int primitive)
+{
+    clip(m_viewProjection * glm::vec4(a, 1.0f), m_viewProjection * glm::vec4(b, 1.0f),
+        m_viewProjection * glm::vec4(c, 1.0f), id, primitive);
+}
+
+
+void Rasterizer::addMesh(const std::vector<glm::vec3> &vertices, unsigned int stride,
+    const std::vector<unsigned int> &indexes, const glm::vec3 &origin, unsigned int id)
+{
+    size_t count = vertices.size() / stride;
+    m_projected.resize(count);
+
+    auto project = [&](size_t first, size_t last) {
+        for(size_t i = first; i < last; ++i)
+            m_projected[i] = m_viewProjection * glm::vec4(vertices[stride * i] + origin, 1.0f);
+    };
+
+    // Les sommets sont indépendants, seuls les grands maillages valent le coût des threads
+    if(count <= RASTER_VERTEX_CHUNK) project(0, count);
+    else {
+        parallelFor(0, (count + RASTER_VERTEX_CHUNK - 1) / RASTER_VERTEX_CHUNK, [&](size_t chunk) {
+            project(chunk * RASTER_VERTEX_CHUNK, std::min(count, (chunk + 1) * RASTER_VERTEX_CHUNK));
+        });
+    }
+
+    // Rangés dans l'ordre des indices : le résultat reste celui d'un ajout triangle par triangle
+    for(size_t i = 0; i + 2 < indexes.size(); i += 3)
+        clip(m_projected[indexes[i]], m_projected[indexes[i + 1]], m_projected[indexes[i + 2]], id, i / 3);
+}
+
+
+void Rasterizer::clip(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c, unsigned int id,
+    unsigned int primitive)
+{
+    int planes = m_depthClip ? 3 : 1;
+
+    // Cas le plus courant : le triangle est entièrement du bon côté des plans
+    bool inside = true;
+    for(int plane = 0; plane < planes; ++plane)
+        inside = inside && planeDistance(a, plane) >= 0.0f && planeDistance(b, plane) >= 0.0f
+            && planeDistance(c, plane) >= 0.0f;
+    if(inside) {
+        bin(a, b, c, id, primitive);
+        return;
+    }
+
+    // Sutherland-Hodgman : chaque plan ajoute un sommet au plus
+    glm::vec4 polygon[RASTER_MAX_CLIPPED] = {a, b, c};
+    glm::vec4 clipped[RASTER_MAX_CLIPPED];
+    int size = 3;
+    for(int plane = 0; plane < planes && size > 0; ++plane)
+    {
+        int count = 0;
+        for(int i = 0; i < size; ++i) {
+            const glm::vec4 &current = polygon[i];
+            const glm::vec4 &next = polygon[(i + 1) % size];
+            float currentDistance = planeDistance(current, plane);
+            float nextDistance = planeDistance(next, plane);
+
+            if(currentDistance >= 0.0f) clipped[count++] = current;
+            if((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+                clipped[count++] = current + (currentDistance / (currentDistance - nextDistance)) * (next - current);
+        }
+        std::copy(clipped, clipped + count, polygon);
+        size = count;
+    }
+
+    for(int i = 1; i + 1 < size; ++i) bin(polygon[0], polygon[i], polygon[i + 1], id, primitive);
+}
+
+
+void Rasterizer::bin(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c, unsigned int id,
+    unsigned int primitive)
+{
+    // Même correspondance que TraceCamera::generate() entre l'écran et l'espace de découpage
+    RasterTriangle triangle;
+    const glm::vec4* clip[3] = {&a, &b, &c};
+    for(int i = 0; i < 3; ++i) {
+        float inverseW = 1.0f / clip[i]->w;
+        triangle.vertices[i] = glm::vec3((clip[i]->x * inverseW + 1.0f) * 0.5f * m_width,
+            (1.0f - clip[i]->y * inverseW) * 0.5f * m_height, inverseW);
+    }
+    triangle.id = id;
+    triangle.primitive = primitive;
+
+    float minX = std::min({triangle.vertices[0].x, triangle.vertices[1].x, triangle.vertices[2].x});
+    float maxX = std::max({triangle.vertices[0].x, triangle.vertices[1].x, triangle.vertices[2].x});
+    float minY = std::min({triangle.vertices[0].y, triangle.vertices[1].y, triangle.vertices[2].y});
+    float maxY = std::max({triangle.vertices[0].y, triangle.vertices[1].y, triangle.vertices[2].y});
+
+    // Aucun point entier de l'image couvert par la boîte du triangle (bornes prises en flottants :
+    // les sommets proches du plan w = 0 sont très loin de l'image)
+    if(maxX < 0.0f || maxY < 0.0f || minX > m_width - 1.0f || minY > m_height - 1.0f) return;
+    if(std::ceil(minX) > std::floor(maxX) || std::ceil(minY) > std::floor(maxY)) return;
+
+    triangle.minX = (int)std::max(std::ceil(minX), 0.0f);
+    triangle.minY = (int)std::max(std::ceil(minY), 0.0f);
+    triangle.maxX = (int)std::min(std::floor(maxX), m_width - 1.0f);
+    triangle.maxY = (int)std::min(std::floor(maxY), m_height - 1.0f);
+
+    unsigned int index = m_triangles.size();
+    m_triangles.push_back(triangle);
+    for(int tileY = triangle.minY / RASTER_TILE_SIZE; tileY <= triangle.maxY / RASTER_TILE_SIZE; ++tileY)
+        for(int tileX = triangle.minX / RASTER_TILE_SIZE; tileX <= triangle.maxX / RASTER_TILE_SIZE; ++tileX)
+            m_tiles[(size_t)tileY * m_tilesX + tileX].push_back(index);
+}
+
+
+void Rasterizer::rasterize()
+{
+    parallelFor(0, m_tiles.size(), [&](size_t tile) {
+        int left = (tile % m_tilesX) * RASTER_TILE_SIZE;
+        int top = (tile / m_tilesX) * RASTER_TILE_SIZE;
+        int right = std::min(left + RASTER_TILE_SIZE, (int)m_width) - 1;
+        int bottom = std::min(top + RASTER_TILE_SIZE, (int)m_height) - 1;
+        for(unsigned int index : m_tiles[tile]) drawTriangle(m_triangles[index], left, top, right, bottom);
+    });
+}
+
+
+void Rasterizer::drawTriangle(const RasterTriangle &triangle, int left, int top, int right, int bottom)
+{
+    const glm::vec3* v[3] = {&triangle.vertices[0], &triangle.vertices[1], &triangle.vertices[2]};
+
+    // Sommets dans le sens où l'aire est positive : l'intérieur est du côté positif des arêtes
+    float area = evaluateEdge(makeEdge(*v[0], *v[1]), v[2]->x, v[2]->y);
+    if(area == 0.0f) return;
+    if(area < 0.0f) {
+        std::swap(v[1], v[2]);
+        area = -area;
+    }
+
+    // edges[i] : arête opposée au sommet i, dont la fonction donne le poids du sommet
+    RasterEdge edges[3];
+    for(int i = 0; i < 3; ++i) edges[i] = makeEdge(*v[(i + 1) % 3], *v[(i + 2) % 3]);
+
+    int x0 = std::max(triangle.minX, left);
+    int x1 = std::min(triangle.maxX, right);
+    int y0 = std::max(triangle.minY, top);
+    int y1 = std::min(triangle.maxY, bottom);
+    float inverseArea = 1.0f / area;
+
+#if defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 inverseAreas = _mm_set1_ps(inverseArea);
+    const __m128i ids = _mm_set1_epi32((int)triangle.id);
+    const __m128i primitives = _mm_set1_epi32((int)triangle.primitive);
+    __m128 fromX[3], dy[3], sign[3], owned[3], z[3];
+    for(int i = 0; i < 3; ++i) {
+        fromX[i] = _mm_set1_ps(edges[i].fromX);
+        dy[i] = _mm_set1_ps(edges[i].dy);
+        sign[i] = _mm_set1_ps(edges[i].sign);
+        owned[i] = _mm_castsi128_ps(_mm_set1_epi32(edges[i].owned ? -1 : 0));
+        z[i] = _mm_set1_ps(v[i]->z);
+    }
+#endif
+
+    for(int y = y0; y <= y1; ++y)
+    {
+        size_t row = (size_t)y * m_width;
+        int x = x0;
+
+#if defined(__SSE2__)
+        // Quatre pixels à la fois, mêmes opérations dans le même ordre que evaluateEdge()
+        __m128 rowTerms[3];
+        for(int i = 0; i < 3; ++i) rowTerms[i] = _mm_set1_ps(edges[i].dx * ((float)y - edges[i].fromY));
+
+        for(; x + 3 <= x1; x += 4)
+        {
+            __m128 px = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+            __m128 weights[3];
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for(int i = 0; i < 3; ++i) {
+                weights[i] = _mm_mul_ps(sign[i], _mm_sub_ps(rowTerms[i], _mm_mul_ps(dy[i], _mm_sub_ps(px, fromX[i]))));
+                inside = _mm_and_ps(inside, _mm_or_ps(_mm_cmpgt_ps(weights[i], zero),
+                    _mm_and_ps(_mm_cmpeq_ps(weights[i], zero), owned[i])));
+            }
+            if(_mm_movemask_ps(inside) == 0) continue;
+
+            __m128 depth = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(weights[0], z[0]), _mm_mul_ps(weights[1], z[1])),
+                _mm_mul_ps(weights[2], z[2])), inverseAreas);
+            __m128 oldDepth = _mm_loadu_ps(&m_depth[row + x]);
+            __m128 closer = _mm_and_ps(inside, _mm_cmpgt_ps(depth, oldDepth));
+            if(_mm_movemask_ps(closer) == 0) continue;
+
+            _mm_storeu_ps(&m_depth[row + x], _mm_or_ps(_mm_and_ps(closer, depth), _mm_andnot_ps(closer, oldDepth)));
+
+            __m128i mask = _mm_castps_si128(closer);
+            __m128i* idPointer = reinterpret_cast<__m128i*>(&m_id[row + x]);
+            __m128i* primitivePointer = reinterpret_cast<__m128i*>(&m_primitive[row + x]);
+            _mm_storeu_si128(idPointer, _mm_or_si128(_mm_and_si128(mask, ids),
+                _mm_andnot_si128(mask, _mm_loadu_si128(idPointer))));
+            _mm_storeu_si128(primitivePointer, _mm_or_si128(_mm_and_si128(mask, primitives),
+                _mm_andnot_si128(mask, _mm_loadu_si128(primitivePointer))));
+        }
+#endif
+
+        for(; x <= x1; ++x)
+        {
+            float weights[3];
+            bool inside = true;
+            for(int i = 0; i < 3 && inside; ++i) {
+                weights[i] = evaluateEdge(edges[i], (float)x, (float)y);
+                inside = weights[i] > 0.0f || (weights[i] == 0.0f && edges[i].owned);
+            }
+            if(!inside) continue;
+
+            // 1 / w varie linéairement à l'écran
+            float depth = (weights[0] * v[0]->z + weights[1] * v[1]->z + weights[2] * v[2]->z) * inverseArea;
+            size_t pixel = row + x;
+            if(depth <= m_depth[pixel]) continue;
+
+            m_depth[pixel] = depth;
+            m_id[pixel] = triangle.id;
+            m_primitive[pixel] = triangle.primitive;
+        }
+    }
+}
+
+
+unsigned int Rasterizer::getWidth() const {return m_width;}
+unsigned int Rasterizer::getHeight() const {return m_height;}
+size_t Rasterizer::getTriangleCount() const {return m_triangles.size();}
+unsigned int Rasterizer::getId(unsigned int x, unsigned int y) const {return m_id[(size_t)y * m_width + x];}
+unsigned int Rasterizer::getPrimitive(unsigned int x, unsigned int y) const {return m_primitive[(size_t)y * m_width + x];}
+float Rasterizer::getDepth(unsigned int x, unsigned int y) const {return m_depth[(size_t)y * m_width + x];}
@@ -0,0 +1,139 @@
+#ifndef RASTERIZER_HPP
+#define RASTERIZER_HPP
+
+/**
+ * @file Rasterizer.hpp
+ * @brief Définition de la classe Rasterizer.
+ *
+ * Ce fichier contient une rastérisation de triangles sur le processeur, sans OpenGL : pour chaque
+ * pixel, le triangle le plus proche de la caméra (identifiant, primitive et profondeur).
+ *
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#define RASTER_NO_ID 0xFFFFFFFFu   // Identifiant d'un pixel qu'aucun triangle ne couvre
+#define RASTER_TILE_SIZE 32        // Côté des tuiles de pixels, traitées chacune par une tâche
+#define RASTER_MIN_W 0.00001f      // w minimal après projection : le reste du triangle est coupé
+#define RASTER_VERTEX_CHUNK 16384  // Sommets projetés par tâche (cf. addMesh())
+#define RASTER_MAX_CLIPPED 8       // Sommets au plus d'un triangle coupé par les plans
+
+
+/**
+ * @brief Triangle projeté : position à l'écran (en pixels) et 1 / w de chaque sommet.
+ */
+typedef struct s_RasterTriangle {
+    glm::vec3 vertices[3]; // (x, y, 1 / w)
+    unsigned int id;
+    unsigned int primitive;
+    int minX, minY;        // Pixels de la boîte du triangle, bornés à l'image
+    int maxX, maxY;
+} RasterTriangle;
+
+
+/**
+ * @class Rasterizer
+ * @brief Tampon d'identifiants et de profondeur d'une image, rempli par une rastérisation des
+ * triangles sur le processeur.
+ *
+ * Les pixels sont échantillonnés aux mêmes points que les rayons de TraceCamera::generate() : le
+ * pixel (x, y) couvre le point (x, y) de l'écran, origine en haut à gauche (une translation d'un
+ * demi-pixel dans la matrice donne les centres des pixels d'OpenGL). Aucune face n'est éliminée.
+ * Par défaut, seuls les points derrière la caméra sont coupés (pas de plans proche ni lointain),
+ * comme pour les rayons. Les arêtes partagées par deux triangles suivent une règle "haut-gauche" :
+ * un point exactement sur l'arête n'appartient qu'à un des deux.
+ *
+ * Les triangles sont rangés à l'ajout dans les tuiles de RASTER_TILE_SIZE pixels de côté que
+ * couvre leur boîte, puis les tuiles sont rastérisées en parallèle, chaque triangle dans l'ordre
+ * d'ajout : le résultat ne dépend pas du nombre de threads. Les fonctions d'arête sont évaluées
+ * sur quatre pixels à la fois en SSE2, avec exactement les mêmes opérations que la version scalaire.
+ */
+class Rasterizer
+{
+public:
+
+    Rasterizer();
+
+    /**
+     * @brief Vide les tampons et les triangles pour une nouvelle image.
+     * @param viewProjection matrice projection * vue de la caméra.
+     * @param depthClip couper aussi par les plans proche et lointain de la projection, comme
+     * OpenGL.
+     */
+    void begin(unsigned int width, unsigned int height, const glm::mat4 &viewProjection,
+        bool depthClip = false);
+
+    /**
+     * @brief Projette un triangle (coordonnées du monde) et le range dans les tuiles qu'il couvre.
+     * @param id, primitive valeurs écrites dans les tampons pour les pixels où il est visible.
+     */
+    void addTriangle(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c, unsigned int id,
+        unsigned int primitive);
+
+    /**
+     * @brief Ajoute les triangles d'un maillage indexé, chaque sommet n'étant projeté qu'une fois.
+     * @param vertices sommets entrelacés tels qu'envoyés au VBO (position en premier).
+     * @param stride nombre de vec3 par sommet dans vertices.
+     * @param indexes indices des triangles tels qu'envoyés à l'EBO.
+     * @param origin position de l'objet (les sommets sont en coordonnées locales).
+     * @param id valeur écrite dans les tampons, la primitive étant le numéro du triangle.
+     */
+    void addMesh(const std::vector<glm::vec3> &vertices, unsigned int stride,
+        const std::vector<unsigned int> &indexes, const glm::vec3 &origin, unsigned int id);
+
+    /**
+     * @brief Remplit les tampons avec les triangles ajoutés depuis begin().
+     */
+    void rasterize();
+
+    unsigned int getWidth() const;
+    unsigned int getHeight() const;
+    size_t getTriangleCount() const;
+
+    /**
+     * @brief Renvoie l'identifiant du triangle visible au pixel (x, y), RASTER_NO_ID si aucun.
+     */
+    unsigned int getId(unsigned int x, unsigned int y) const;
+    unsigned int getPrimitive(unsigned int x, unsigned int y) const;
+
+    /**
+     * @brief Renvoie 1 / w du point visible au pixel (x, y) (0 si aucun) : plus grand = plus proche.
+     */
+    float getDepth(unsigned int x, unsigned int y) const;
+
+private:
+    unsigned int m_width;
+    unsigned int m_height;
+    unsigned int m_tilesX;
+    glm::mat4 m_viewProjection;
+    bool m_depthClip;
+    std::vector<RasterTriangle> m_triangles;
+    std::vector<std::vector<unsigned int>> m_tiles; // Triangles qui touchent chaque tuile
+    std::vector<glm::vec4> m_projected;             // Sommets du maillage en cours (cf. addMesh())
+
+    std::vector<unsigned int> m_id;
+    std::vector<unsigned int> m_primitive;
+    std::vector<float> m_depth;
+
+    /**
+     * @brief Coupe un triangle projeté par les plans actifs et range ce qui reste.
+     */
+    void clip(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c, unsigned int id,
+        unsigned int primitive);
+
+    /**
+     * @brief Range un triangle projeté (sommets devant la caméra) dans les tuiles qu'il couvre.
+     */
+    void bin(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c, unsigned int id,
+        unsigned int primitive);
+
+    /**
+     * @brief Rastérise un triangle dans le rectangle de pixels [left; right] x [top; bottom].
+     */
+    void drawTriangle(const RasterTriangle &triangle, int left, int top, int right, int bottom);
+};
+
+#endif // RASTERIZER_HPP
@@ -0,0 +1,131 @@
+#include "RayBatch.hpp"
+#include "Ray.hpp"
+
+#include <algorithm>
+
+
+RayBatch::RayBatch() :
+    m_VAO(0),
+    m_VBO(0),
+    m_capacity(0),
+    m_uploaded(0)
+{}
+
+
+RayBatch::~RayBatch()
+{
+    if(m_VAO == 0) return;
+    glDeleteBuffers(1, &m_VBO);
+    glDeleteVertexArrays(1, &m_VAO);
+}
+
+
+void RayBatch::addPath(glm::vec3 origin, const glm::vec3* points, unsigned int count, glm::vec3 exit)
+{
+    // Même découpage que le constructeur de Ray : RAY_LENGTH de long au total
+    float remainingLength = RAY_LENGTH;
+    glm::vec3 lastPosition = origin;
+    glm::vec3 color = RAY_PRIMARY_COLOR;
+    size_t first = m_vertices.size();
+    m_vertices.push_back({origin, color});
+
+    for(unsigned int k = 0; k < count; ++k) {
+        glm::vec3 nextDirection = points[k] - lastPosition;
+        float distanceToNext = glm::length(nextDirection);
+
+        if(distanceToNext > remainingLength) {
+            m_vertices.push_back({lastPosition + nextDirection * (remainingLength / distanceToNext), color});
+            endStrip(first);
+            return;
+        }
+
+        remainingLength -= distanceToNext;
+        lastPosition = points[k];
+        m_vertices.push_back({lastPosition, color});
+
+        // Le point du premier reflet est répété pour que la couleur change net sur la ligne
+        if(k == 0) {
+            endStrip(first);
+            color = RAY_BOUNCE_COLOR;
+            first = m_vertices.size();
+            m_vertices.push_back({lastPosition, color});
+        }
+    }
+
+    if(remainingLength > 0) m_vertices.push_back({lastPosition + exit * remainingLength, color});
+    endStrip(first);
+}
+
+
+void RayBatch::endStrip(size_t first)
+{
+    if(m_vertices.size() - first < 2) {
+        m_vertices.resize(first);
+        return;
+    }
+
+    m_firsts.push_back(first);
+    m_counts.push_back(m_vertices.size() - first);
+}
+
+
+void RayBatch::clear()
+{
+    // Sommets sans destructeur : les vecteurs gardent leur mémoire, comme le VBO
+    m_vertices.clear();
+    m_firsts.clear();
+    m_counts.clear();
+    m_uploaded = 0;
+}
+
+
+void RayBatch::draw(Shader shader)
+{
+    if(m_counts.empty()) return;
+    upload();
+
+    glBindVertexArray(m_VAO);
+    shader.setMat4("model", glm::mat4(1.0f));
+    shader.setBool("vertexColor", true);
+    glMultiDrawArrays(GL_LINE_STRIP, m_firsts.data(), m_counts.data(), m_counts.size());
+    shader.setBool("vertexColor", false);
+    glBindVertexArray(0);
+}
+
+
+size_t RayBatch::getPathCount() const {return m_counts.size();}
+size_t RayBatch::getVertexCount() const {return m_vertices.size();}
+
+
+void RayBatch::upload()
+{
+    if(m_VAO == 0) {
+        glGenVertexArrays(1, &m_VAO);
+        glGenBuffers(1, &m_VBO);
+
+        glBindVertexArray(m_VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(RayVertex), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(RayVertex), (void*)sizeof(glm::vec3));
+        glEnableVertexAttribArray(3);
+        glBindVertexArray(0);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+
+    // Le VBO est réalloué (par doublement) quand il est plein, et tout est alors renvoyé
+    if(m_vertices.size() > m_capacity) {
+        m_capacity = std::max({m_vertices.size(), 2 * m_capacity, (size_t)RAY_BATCH_INITIAL_CAPACITY});
+        glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(RayVertex), nullptr, GL_DYNAMIC_DRAW);
+        m_uploaded = 0;
+    }
+
+    if(m_uploaded < m_vertices.size()) {
+        glBufferSubData(GL_ARRAY_BUFFER, m_uploaded * sizeof(RayVertex),
+            (m_vertices.size() - m_uploaded) * sizeof(RayVertex), m_vertices.data() + m_uploaded);
+        m_uploaded = m_vertices.size();
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,98 @@
+#ifndef RAY_BATCH_HPP
+#define RAY_BATCH_HPP
+
+/**
+ * @file RayBatch.hpp
+ * @brief Définition de la classe RayBatch.
+ * 
+ * Ce fichier contient le tampon unique qui affiche tous les rayons lancés dans la scène (clics
+ * seuls et éventails), au lieu d'un objet Ray, d'un VAO et d'un VBO par rayon.
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <glad/glad.h>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "../includes/shader.hpp"
+
+#define RAY_BATCH_INITIAL_CAPACITY 4096          // Sommets réservés à la première création du VBO
+#define RAY_PRIMARY_COLOR glm::vec3(0.0f, 1.0f, 0.0f) // Segment avant le premier reflet
+#define RAY_BOUNCE_COLOR glm::vec3(1.0f, 0.0f, 0.0f)  // Segments après un reflet
+
+
+/**
+ * @brief Sommet d'un rayon affiché : position et couleur (attributs 0 et 3 de lighted.vs).
+ */
+typedef struct s_RayVertex {
+    glm::vec3 position;
+    glm::vec3 color;
+} RayVertex;
+
+
+/**
+ * @class RayBatch
+ * @brief Chemins de rayons rangés dans un seul VBO et dessinés en un seul appel.
+ * 
+ * Chaque chemin est coupé à RAY_LENGTH de long (comme un Ray) et ajouté sous forme de deux lignes
+ * brisées : le premier segment (RAY_PRIMARY_COLOR) puis les segments suivants (RAY_BOUNCE_COLOR).
+ * Toutes les lignes sont dessinées par un seul glMultiDrawArrays(). Le VBO grandit par doublement
+ * et seuls les sommets ajoutés depuis le dernier dessin sont envoyés. clear() ne fait que remettre
+ * les compteurs à zéro, le VBO est gardé pour les rayons suivants.
+ * 
+ * Les ressources OpenGL ne sont créées qu'au premier dessin : le contexte de l'application (qui
+ * possède le RayBatch) peut être construit avant le chargement d'OpenGL.
+ */
+class RayBatch
+{
+public:
+    RayBatch();
+    ~RayBatch();
+
+    RayBatch(const RayBatch&) = delete;
+    RayBatch& operator=(const RayBatch&) = delete;
+
+    /**
+     * @brief Ajoute le chemin d'un rayon.
+     * @param origin origine du rayon.
+     * @param points points touchés successivement (cf. Intersection::rayContextPath()).
+     * @param count nombre de points touchés.
+     * @param exit direction du rayon après le dernier point touché.
+     */
+    void addPath(glm::vec3 origin, const glm::vec3* points, unsigned int count, glm::vec3 exit);
+
+    /**
+     * @brief Supprime tous les chemins, en temps constant.
+     */
+    void clear();
+
+    /**
+     * @brief Envoie les sommets ajoutés depuis le dernier appel et dessine tous les chemins.
+     */
+    void draw(Shader shader);
+
+    size_t getPathCount() const;
+    size_t getVertexCount() const;
+
+private:
+    GLuint m_VAO, m_VBO;     // 0 tant que rien n'a été dessiné
+    size_t m_capacity;       // Sommets que peut contenir le VBO
+    size_t m_uploaded;       // Sommets déjà envoyés au VBO
+    std::vector<RayVertex> m_vertices;
+    std::vector<GLint> m_firsts;   // Premier sommet de chaque ligne brisée
+    std::vector<GLsizei> m_counts; // Nombre de sommets de chaque ligne brisée
+
+    /**
+     * @brief Termine la ligne brisée commencée au sommet first.
+     */
+    void endStrip(size_t first);
+
+    /**
+     * @brief Crée le VAO et le VBO si besoin, les agrandit si besoin et envoie les nouveaux sommets.
+     */
+    void upload();
+};
+
+#endif // RAY_BATCH_HPP
@@ -0,0 +1,136 @@
+#include "Resolve.hpp"
+#include "Parallel.hpp"
+
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define RESOLVE_BLOCK 64 // Pixels traités par bloc (indices gardés sur la pile)
+#define RESOLVE_MAX_RADIANCE 65504.f // Au-delà, les courbes calculeraient inf / inf
+
+
+// Seuils de Bayer 4x4 ramenés sur [0; 256[ : ajoutés à la partie fractionnaire de la table
+static const unsigned short BAYER_4x4[4][4] = {
+    {  8, 136,  40, 168},
+    {200,  72, 232, 104},
+    { 56, 184,  24, 152},
+    {248, 120, 216,  88}
+};
+
+
+ResolveSettings Resolve::defaultSettings()
+{
+    ResolveSettings settings;
+    settings.exposure = 1.f;
+    settings.toneMap = TONEMAP_ACES;
+    settings.dither = true;
+    return settings;
+}
+
+
+const unsigned short* Resolve::sRGBTable()
+{
+    // Construite une seule fois (initialisation thread-safe des variables statiques locales)
+    static const struct s_Table {
+        unsigned short values[RESOLVE_LUT_SIZE];
+        s_Table() {
+            for(int i = 0; i < RESOLVE_LUT_SIZE; ++i) {
+                double linear = (double)i / (RESOLVE_LUT_SIZE - 1);
+                double encoded = (linear <= 0.0031308) ? 12.92 * linear :
+                    1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+                values[i] = (unsigned short)std::lround(encoded * 255.0 * 256.0);
+            }
+        }
+    } table;
+
+    return table.values;
+}
+
+
+static inline float toneMapScalar(float v, unsigned int toneMap)
+{
+    // Écrit ainsi pour qu'un NaN donne 0
+    v = (v > 0.f) ? v : 0.f;
+    v = (v < RESOLVE_MAX_RADIANCE) ? v : RESOLVE_MAX_RADIANCE;
+
+    if(toneMap == TONEMAP_REINHARD) v = v / (1.f + v);
+    else if(toneMap == TONEMAP_ACES) v = (v * (2.51f * v + 0.03f)) / (v * (2.43f * v + 0.59f) + 0.14f);
+    return (v < 1.f) ? v : 1.f;
+}
+
+
+void Resolve::resolveSpan(const float* radiance, unsigned char* pixels, unsigned int count,
+    unsigned int x, unsigned int y, const ResolveSettings &settings)
+{
+    const unsigned short* table = sRGBTable();
+    const unsigned short* bayer = BAYER_4x4[y & 3];
+    unsigned int indexes[3 * RESOLVE_BLOCK];
+
+    for(unsigned int start = 0; start < count; start += RESOLVE_BLOCK)
+    {
+        unsigned int pixelCount = (count - start < RESOLVE_BLOCK) ? count - start : RESOLVE_BLOCK;
+        unsigned int valueCount = 3 * pixelCount;
+        const float* in = radiance + 3 * (size_t)start;
+        unsigned int i = 0;
+
+        // Partie flottante : les composantes sont indépendantes, on ignore le découpage en pixels
+#if defined(__SSE2__)
+        const __m128 exposure = _mm_set1_ps(settings.exposure);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 scale = _mm_set1_ps(RESOLVE_LUT_SIZE - 1);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 maxRadiance = _mm_set1_ps(RESOLVE_MAX_RADIANCE);
+
+        for(; i + 4 <= valueCount; i += 4)
+        {
+            // max(NaN, 0) renvoie 0
+            __m128 v = _mm_mul_ps(_mm_loadu_ps(in + i), exposure);
+            v = _mm_min_ps(_mm_max_ps(v, zero), maxRadiance);
+
+            if(settings.toneMap == TONEMAP_REINHARD) {
+                v = _mm_div_ps(v, _mm_add_ps(one, v));
+            }
+            else if(settings.toneMap == TONEMAP_ACES) {
+                __m128 num = _mm_mul_ps(v, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.51f), v), _mm_set1_ps(0.03f)));
+                __m128 den = _mm_add_ps(_mm_mul_ps(v, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.43f), v),
+                    _mm_set1_ps(0.59f))), _mm_set1_ps(0.14f));
+                v = _mm_div_ps(num, den);
+            }
+
+            v = _mm_min_ps(v, one);
+            __m128i index = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(indexes + i), index);
+        }
+#endif
+        for(; i < valueCount; ++i)
+        {
+            float v = toneMapScalar(in[i] * settings.exposure, settings.toneMap);
+            indexes[i] = (unsigned int)(v * (RESOLVE_LUT_SIZE - 1) + 0.5f);
+        }
+
+        // Partie entière : table sRGB, tramage et alpha
+        unsigned char* out = pixels + 4 * (size_t)start;
+        unsigned int px = x + start;
+        for(unsigned int p = 0; p < pixelCount; ++p, ++px, out += 4)
+        {
+            unsigned int offset = settings.dither ? bayer[px & 3] : 128;
+            out[0] = (table[indexes[3 * p]] + offset) >> 8;
+            out[1] = (table[indexes[3 * p + 1]] + offset) >> 8;
+            out[2] = (table[indexes[3 * p + 2]] + offset) >> 8;
+            out[3] = 255;
+        }
+    }
+}
+
+
+void Resolve::resolveRows(const float* radiance, unsigned char* pixels, unsigned int width,
+    unsigned int firstRow, unsigned int rowCount, const ResolveSettings &settings)
+{
+    parallelFor(0, rowCount, [&](size_t row) {
+        resolveSpan(radiance + 3 * (size_t)width * row, pixels + 4 * (size_t)width * row, width,
+            0, firstRow + row, settings);
+    });
+}
@@ -0,0 +1,72 @@
+#ifndef RESOLVE_HPP
+#define RESOLVE_HPP
+
+/**
+ * @file Resolve.hpp
+ * @brief Définition de la classe Resolve.
+ * 
+ * Ce fichier contient la conversion de la radiance linéaire calculée par le lancer de rayons
+ * (RGB flottant, non bornée) en pixels RGBA 8 bits affichables : exposition, courbe de tone
+ * mapping, bornage, encodage sRGB par table et tramage.
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <cstddef>
+
+#define TONEMAP_CLAMP 0     // Bornage seul
+#define TONEMAP_REINHARD 1  // x / (1 + x)
+#define TONEMAP_ACES 2      // Approximation de la courbe ACES (K. Narkowicz)
+
+#define RESOLVE_LUT_SIZE 4096 // Entrées de la table sRGB (valeurs linéaires entre 0 et 1)
+
+
+typedef struct s_ResolveSettings {
+    float exposure;       // Facteur appliqué à la radiance avant le tone mapping
+    unsigned int toneMap; // TONEMAP_*
+    bool dither;          // Tramage ordonné 4x4 avant la quantification sur 8 bits
+} ResolveSettings;
+
+
+/**
+ * @class Resolve
+ * @brief Conversion de la radiance linéaire en pixels 8 bits.
+ * 
+ * Les calculs flottants (exposition, courbe, bornage, indice dans la table) sont faits 4 valeurs à
+ * la fois en SSE2 lorsque le processeur le permet ; l'encodage sRGB et le tramage sont une lecture
+ * de table et une addition entière par composante. Une valeur NaN donne du noir.
+ */
+class Resolve
+{
+public:
+
+    /**
+     * @brief Réglages par défaut : exposition 1, courbe ACES, tramage activé.
+     */
+    static ResolveSettings defaultSettings();
+
+    /**
+     * @brief Convertit count pixels consécutifs d'une ligne.
+     * @param radiance count pixels RGB flottants.
+     * @param pixels count pixels RGBA 8 bits (alpha à 255).
+     * @param x, y position du premier pixel dans l'image (pour le motif de tramage).
+     */
+    static void resolveSpan(const float* radiance, unsigned char* pixels, unsigned int count,
+        unsigned int x, unsigned int y, const ResolveSettings &settings);
+
+    /**
+     * @brief Convertit rowCount lignes de width pixels en parallèle.
+     * @param firstRow position de la première ligne dans l'image (pour le motif de tramage).
+     */
+    static void resolveRows(const float* radiance, unsigned char* pixels, unsigned int width,
+        unsigned int firstRow, unsigned int rowCount, const ResolveSettings &settings);
+
+private:
+    /**
+     * @brief Table sRGB : valeur encodée * 256 (8 bits entiers, 8 bits de fraction pour le tramage).
+     */
+    static const unsigned short* sRGBTable();
+};
+
+#endif // RESOLVE_HPP
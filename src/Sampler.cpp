@@ -0,0 +1,298 @@
+#include "Sampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+
+uint32_t hashCombine(uint32_t seed, uint32_t value)
+{
+    return seed ^ (value + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+}
+
+
+uint32_t reverseBits(uint32_t x)
+{
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+    x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+    return (x >> 16) | (x << 16);
+}
+
+
+/**
+ * @brief Permutation de Laine-Karras : chaque bit ne dépend que des bits de poids plus faible.
+ */
+uint32_t laineKarras(uint32_t x, uint32_t seed)
+{
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return x;
+}
+
+
+/**
+ * @brief Brouillage d'Owen : chaque bit est inversé selon les bits de poids plus fort (bits
+ * retournés, permutation de Laine-Karras, bits retournés).
+ */
+uint32_t nestedUniformScramble(uint32_t x, uint32_t seed)
+{
+    return reverseBits(laineKarras(reverseBits(x), seed));
+}
+
+
+float toUnit(uint32_t x)
+{
+    // 24 bits de poids fort : le résultat est toujours strictement inférieur à 1
+    return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+
+/**
+ * @brief Nombres directeurs de Sobol sur 32 bits, pour les SAMPLER_SOBOL_DIMENSIONS premières
+ * dimensions, et leurs combinaisons pour chaque valeur de chaque octet de l'indice.
+ */
+typedef struct s_SobolTable {
+    uint32_t directions[SAMPLER_SOBOL_DIMENSIONS][32];
+    uint32_t bytes[SAMPLER_SOBOL_DIMENSIONS][4][256]; // Ou exclusif des nombres des bits à 1 de l'octet
+
+    s_SobolTable()
+    {
+        // Polynômes primitifs (degré, coefficients) et nombres initiaux de Joe et Kuo
+        static const unsigned int degree[SAMPLER_SOBOL_DIMENSIONS] = {0, 1, 2, 3};
+        static const unsigned int coefficients[SAMPLER_SOBOL_DIMENSIONS] = {0, 0, 1, 1};
+        static const uint32_t initial[SAMPLER_SOBOL_DIMENSIONS][3] = {{0, 0, 0}, {1, 0, 0}, {1, 3, 0}, {1, 3, 1}};
+
+        // Première dimension : suite de van der Corput en base 2
+        for(unsigned int i = 0; i < 32; ++i) directions[0][i] = 1u << (31 - i);
+
+        for(unsigned int d = 1; d < SAMPLER_SOBOL_DIMENSIONS; ++d) {
+            uint32_t* v = directions[d];
+            unsigned int s = degree[d];
+            for(unsigned int i = 0; i < 32; ++i) {
+                if(i < s) {
+                    v[i] = initial[d][i] << (31 - i);
+                    continue;
+                }
+                v[i] = v[i - s] ^ (v[i - s] >> s);
+                for(unsigned int k = 1; k < s; ++k)
+                    if((coefficients[d] >> (s - 1 - k)) & 1u) v[i] ^= v[i - k];
+            }
+        }
+
+        for(unsigned int d = 0; d < SAMPLER_SOBOL_DIMENSIONS; ++d) {
+            for(unsigned int byte = 0; byte < 4; ++byte) {
+                for(unsigned int value = 0; value < 256; ++value) {
+                    bytes[d][byte][value] = 0;
+                    for(unsigned int bit = 0; bit < 8; ++bit)
+                        if((value >> bit) & 1u) bytes[d][byte][value] ^= directions[d][8 * byte + bit];
+                }
+            }
+        }
+    }
+} SobolTable;
+
+
+const SobolTable sobolTable;
+
+
+/**
+ * @brief Valeur d'une dimension de la suite de Sobol : ou exclusif des nombres directeurs des bits
+ * à 1 de l'indice, par octet.
+ */
+uint32_t sobol(uint32_t index, unsigned int dimension)
+{
+    const uint32_t (*bytes)[256] = sobolTable.bytes[dimension];
+    return bytes[0][index & 0xFFu] ^ bytes[1][(index >> 8) & 0xFFu] ^ bytes[2][(index >> 16) & 0xFFu]
+        ^ bytes[3][index >> 24];
+}
+
+
+/**
+ * @brief Masque de bruit bleu par la méthode "void and cluster" d'Ulichney, sur un tore : les
+ * pixels reçoivent leur rang en retirant tour à tour le point le plus entouré d'un motif initial,
+ * puis en remplissant tour à tour le plus grand vide.
+ */
+std::vector<float> voidAndCluster()
+{
+    const int size = SAMPLER_BLUE_NOISE_SIZE;
+    const int count = size * size;
+
+    // Noyau gaussien indexé par le décalage (dx, dy), distances mesurées sur le tore
+    std::vector<float> kernel(count);
+    for(int dy = 0; dy < size; ++dy) {
+        for(int dx = 0; dx < size; ++dx) {
+            float x = (float)std::min(dx, size - dx);
+            float y = (float)std::min(dy, size - dy);
+            kernel[dy * size + dx] = std::exp(-(x * x + y * y) /
+                (2.0f * SAMPLER_BLUE_NOISE_SIGMA * SAMPLER_BLUE_NOISE_SIGMA));
+        }
+    }
+
+    std::vector<float> energy(count, 0.0f);
+    std::vector<char> pattern(count, 0);
+
+    auto splat = [&](int p, float sign) {
+        int px = p % size, py = p / size;
+        for(int y = 0; y < size; ++y) {
+            const float* row = kernel.data() + ((y - py + size) % size) * size;
+            for(int x = 0; x < size; ++x) energy[y * size + x] += sign * row[(x - px + size) % size];
+        }
+    };
+    auto tightestCluster = [&]() {
+        int best = -1;
+        for(int i = 0; i < count; ++i) if(pattern[i] && (best < 0 || energy[i] > energy[best])) best = i;
+        return best;
+    };
+    auto largestVoid = [&]() {
+        int best = -1;
+        for(int i = 0; i < count; ++i) if(!pattern[i] && (best < 0 || energy[i] < energy[best])) best = i;
+        return best;
+    };
+
+    // Motif initial : un point sur dix au hasard, puis le plus entouré va dans le plus grand vide
+    int initial = count / 10;
+    for(uint32_t i = 0, placed = 0; (int)placed < initial; ++i) {
+        int p = Sampler::hash(i) % count;
+        if(pattern[p]) continue;
+        pattern[p] = 1;
+        splat(p, 1.0f);
+        placed++;
+    }
+
+    for(int swaps = 0; swaps < count; ++swaps) {
+        int cluster = tightestCluster();
+        pattern[cluster] = 0;
+        splat(cluster, -1.0f);
+
+        int hole = largestVoid();
+        pattern[hole] = 1;
+        splat(hole, 1.0f);
+        if(hole == cluster) break;
+    }
+
+    std::vector<char> initialPattern = pattern;
+    std::vector<float> initialEnergy = energy;
+    std::vector<int> rank(count);
+
+    for(int r = initial - 1; r >= 0; --r) {
+        int cluster = tightestCluster();
+        pattern[cluster] = 0;
+        splat(cluster, -1.0f);
+        rank[cluster] = r;
+    }
+
+    pattern = initialPattern;
+    energy = initialEnergy;
+    for(int r = initial; r < count; ++r) {
+        int hole = largestVoid();
+        pattern[hole] = 1;
+        splat(hole, 1.0f);
+        rank[hole] = r;
+    }
+
+    std::vector<float> mask(count);
+    for(int i = 0; i < count; ++i) mask[i] = (rank[i] + 0.5f) / count;
+    return mask;
+}
+
+} // namespace
+
+
+Sampler::Sampler(unsigned int type, uint32_t seed) :
+    m_type(type),
+    m_seed(seed)
+{
+    // Le masque est calculé ici plutôt qu'au premier échantillon, pendant le rendu
+    if(m_type == SAMPLER_BLUE_NOISE) blueNoise();
+}
+
+
+float Sampler::get(unsigned int x, unsigned int y, unsigned int sample, unsigned int dimension) const
+{
+    float value;
+    sample1D(x, y, sample, dimension, 1, &value);
+    return value;
+}
+
+
+glm::vec2 Sampler::get2D(unsigned int x, unsigned int y, unsigned int sample, unsigned int dimension) const
+{
+    // Deux dimensions d'un même groupe de Sobol sont calculées ensemble
+    glm::vec2 value;
+    if(dimension % SAMPLER_SOBOL_DIMENSIONS == SAMPLER_SOBOL_DIMENSIONS - 1) {
+        sample1D(x, y, sample, dimension, 1, &value.x);
+        sample1D(x, y, sample, dimension + 1, 1, &value.y);
+    }
+    else {
+        float values[2];
+        sample1D(x, y, sample, dimension, 2, values);
+        value = glm::vec2(values[0], values[1]);
+    }
+    return value;
+}
+
+
+void Sampler::sample1D(unsigned int x, unsigned int y, unsigned int sample, unsigned int dimension,
+    unsigned int count, float* values) const
+{
+    uint32_t pixel = hash(hashCombine(hash(x ^ m_seed), y));
+
+    if(m_type == SAMPLER_RANDOM) {
+        for(unsigned int d = 0; d < count; ++d)
+            values[d] = toUnit(hash(hashCombine(hashCombine(pixel, sample), dimension + d)));
+        return;
+    }
+
+    // Bruit bleu : même suite pour tous les pixels, le pixel ne choisit que le décalage
+    uint32_t bits[SAMPLER_SOBOL_DIMENSIONS];
+    sobolOwen(sample, dimension, (m_type == SAMPLER_SOBOL) ? pixel : hash(m_seed), count, bits);
+
+    for(unsigned int d = 0; d < count; ++d) {
+        values[d] = toUnit(bits[d]);
+        if(m_type != SAMPLER_BLUE_NOISE) continue;
+
+        // Décalage du masque différent pour chaque dimension, pour qu'elles restent indépendantes
+        unsigned int mx = (x + (dimension + d) * 37) % SAMPLER_BLUE_NOISE_SIZE;
+        unsigned int my = (y + (dimension + d) * 23) % SAMPLER_BLUE_NOISE_SIZE;
+        values[d] += blueNoise()[my * SAMPLER_BLUE_NOISE_SIZE + mx];
+        if(values[d] >= 1.0f) values[d] -= 1.0f;
+    }
+}
+
+
+unsigned int Sampler::getType() const {return m_type;}
+
+
+uint32_t Sampler::hash(uint32_t value)
+{
+    uint32_t state = value * 747796405u + 2891336453u;
+    uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+
+const std::vector<float>& Sampler::blueNoise()
+{
+    static const std::vector<float> mask = voidAndCluster();
+    return mask;
+}
+
+
+void Sampler::sobolOwen(uint32_t index, unsigned int dimension, uint32_t seed, unsigned int count,
+    uint32_t* values)
+{
+    // Les dimensions d'un même groupe partagent l'ordre des échantillons, pour rester stratifiées ensemble
+    uint32_t groupSeed = hashCombine(seed, dimension / SAMPLER_SOBOL_DIMENSIONS);
+    uint32_t shuffled = nestedUniformScramble(index, hash(groupSeed));
+
+    for(unsigned int d = 0; d < count; ++d) {
+        uint32_t value = sobol(shuffled, (dimension + d) % SAMPLER_SOBOL_DIMENSIONS);
+        values[d] = nestedUniformScramble(value, hash(hashCombine(groupSeed, dimension + d)));
+    }
+}
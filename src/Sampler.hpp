@@ -0,0 +1,99 @@
+#ifndef SAMPLER_HPP
+#define SAMPLER_HPP
+
+/**
+ * @file Sampler.hpp
+ * @brief Définition de la classe Sampler.
+ * 
+ * Ce fichier contient les suites de nombres utilisées pour les images à plusieurs échantillons par
+ * pixel : chaque valeur ne dépend que du pixel, du numéro de l'échantillon et de la dimension, ce
+ * qui permet de les calculer dans n'importe quel ordre et depuis n'importe quel thread.
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#define SAMPLER_RANDOM 0     // Hachage sans état de (pixel, échantillon, dimension)
+#define SAMPLER_SOBOL 1      // Suite de Sobol brouillée par Owen, brouillage différent pour chaque pixel
+#define SAMPLER_BLUE_NOISE 2 // Même suite de Sobol pour tous les pixels, décalée par un masque de bruit bleu
+#define SAMPLER_COUNT 3
+
+#define SAMPLER_SOBOL_DIMENSIONS 4   // Dimensions de Sobol tabulées, les suivantes sont mélangées
+#define SAMPLER_BLUE_NOISE_SIZE 64   // Côté du masque de bruit bleu (répété sur toute l'image)
+#define SAMPLER_BLUE_NOISE_SIGMA 1.9f // Écart type du noyau de la méthode "void and cluster"
+
+#define SAMPLER_DIMENSION_PIXEL 0 // Dimensions 0 et 1 : position dans le pixel
+
+
+/**
+ * @class Sampler
+ * @brief Donne la valeur dans [0; 1[ de la dimension d'un échantillon d'un pixel.
+ * 
+ * - SAMPLER_RANDOM : hachage PCG, sans état et sans structure. C'est la référence (erreur en
+ *   1 / sqrt(N) pour N échantillons).
+ * - SAMPLER_SOBOL : suite de Sobol dont l'ordre des échantillons et les valeurs sont brouillés par
+ *   permutations imbriquées (Owen, par hachage comme Burley 2020). Chaque pixel a son propre
+ *   brouillage, les échantillons d'un pixel restent bien répartis et l'erreur décroît plus vite.
+ * - SAMPLER_BLUE_NOISE : la même suite de Sobol brouillée pour tous les pixels, décalée (modulo 1)
+ *   par un masque de bruit bleu : l'erreur restante passe des basses aux hautes fréquences de
+ *   l'image, bien moins visibles à faible nombre d'échantillons.
+ * 
+ * Au-delà de SAMPLER_SOBOL_DIMENSIONS, les dimensions réutilisent la table par groupes, avec un
+ * brouillage et un ordre des échantillons différents pour chaque groupe.
+ */
+class Sampler
+{
+public:
+
+    /**
+     * @param type SAMPLER_RANDOM, SAMPLER_SOBOL ou SAMPLER_BLUE_NOISE.
+     * @param seed graine, pour obtenir d'autres suites du même type.
+     */
+    Sampler(unsigned int type = SAMPLER_SOBOL, uint32_t seed = 0);
+
+    /**
+     * @brief Renvoie la valeur de la dimension dimension de l'échantillon sample du pixel (x, y).
+     */
+    float get(unsigned int x, unsigned int y, unsigned int sample, unsigned int dimension) const;
+
+    /**
+     * @brief Renvoie les dimensions dimension et dimension + 1 ensemble.
+     */
+    glm::vec2 get2D(unsigned int x, unsigned int y, unsigned int sample, unsigned int dimension) const;
+
+    unsigned int getType() const;
+
+    /**
+     * @brief Hachage sans état de 32 bits (PCG).
+     */
+    static uint32_t hash(uint32_t value);
+
+    /**
+     * @brief Renvoie le masque de bruit bleu (SAMPLER_BLUE_NOISE_SIZE² seuils dans [0; 1[),
+     * calculé une seule fois pour tout le programme.
+     */
+    static const std::vector<float>& blueNoise();
+
+private:
+    unsigned int m_type;
+    uint32_t m_seed;
+
+    /**
+     * @brief Calcule count dimensions consécutives (d'un même groupe de Sobol) à partir de dimension.
+     */
+    void sample1D(unsigned int x, unsigned int y, unsigned int sample, unsigned int dimension,
+        unsigned int count, float* values) const;
+
+    /**
+     * @brief Valeurs (sur 32 bits) de count dimensions consécutives de la suite de Sobol brouillée
+     * avec seed.
+     */
+    static void sobolOwen(uint32_t index, unsigned int dimension, uint32_t seed, unsigned int count,
+        uint32_t* values);
+};
+
+#endif // SAMPLER_HPP
@@ -0,0 +1,165 @@
+#include "SoftwareRenderer.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+
+
+/**
+ * @brief Couleur d'un fragment, même calcul que shaders/lighted.fs (objets dessinés en triangles :
+ * ni couleur uniforme ni couleur par sommet).
+ */
+static glm::vec3 lightedFragment(const glm::vec3 &fragPos, const glm::vec3 &normal, const glm::vec3 &uv,
+    const glm::vec3 &color, float ambientStrength, const glm::vec3 &lightColor, const glm::vec3 &lightPos,
+    unsigned int displayMode)
+{
+    if(displayMode == NORMAL_DISPLAY_MODE) return normal * 0.5f + 0.5f;
+    if(displayMode == UV_DISPLAY_MODE) return uv;
+
+    glm::vec3 ambient = ambientStrength * lightColor;
+
+    glm::vec3 norm = glm::normalize(normal);
+    glm::vec3 lightDir = glm::normalize(lightPos - fragPos);
+    float diff = std::max(glm::dot(norm, lightDir), 0.0f);
+    glm::vec3 diffuse = diff * lightColor;
+
+    float invDist = SOFTWARE_LIGHT_ALPHA / glm::length(lightPos - fragPos);
+    return (ambient + diffuse) * color * invDist;
+}
+
+
+/**
+ * @brief Conversion d'une composante en 8 bits, comme l'écriture dans le framebuffer d'OpenGL.
+ */
+static unsigned char toByte(float value)
+{
+    // max(NaN, 0) renvoie 0
+    return (unsigned char)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+
+SoftwareRenderer::SoftwareRenderer(unsigned int width, unsigned int height) :
+    m_width(width),
+    m_height(height),
+    m_pixels(4 * (size_t)width * height, 0)
+{}
+
+
+SoftwareStats SoftwareRenderer::render(AppContext &context)
+{
+    auto start = std::chrono::steady_clock::now();
+    SoftwareStats stats = {0, 0, 0, 0.0, 0.0};
+
+    Camera* camera = context.getCamera();
+    glm::mat4 projection = glm::perspective(glm::radians(camera->Zoom), (float)m_width / (float)m_height,
+        SOFTWARE_NEAR_PLANE, SOFTWARE_FAR_PLANE);
+
+    // Rasterizer échantillonne les coins des pixels, OpenGL leurs centres : décalage d'un demi-pixel
+    glm::mat4 pixelCenters = glm::translate(glm::mat4(1.0f), glm::vec3(-1.0f / m_width, 1.0f / m_height, 0.0f));
+    glm::mat4 viewProjection = pixelCenters * projection * camera->GetViewMatrix();
+
+    m_raster.begin(m_width, m_height, viewProjection, true);
+    m_objects.clear();
+    for(const auto& object : context) {
+        const std::vector<unsigned int> &indexes = object->getTriangleIndexes();
+        if(indexes.empty()) continue;
+
+        m_raster.addMesh(object->getVertexData(), object->getVertexStride(), indexes, object->getOrigin(),
+            m_objects.size());
+        m_objects.push_back(object.get());
+        stats.triangles += indexes.size() / 3;
+    }
+    m_raster.rasterize();
+    stats.objects = m_objects.size();
+    stats.rasterTriangles = m_raster.getTriangleCount();
+
+    auto shadeStart = std::chrono::steady_clock::now();
+    stats.rasterMilliseconds = std::chrono::duration<double, std::milli>(shadeStart - start).count();
+
+    // Uniformes de AppContext::drawContext()
+    glm::vec3 background = context.getBackgroundColor();
+    glm::vec3 lightColor = context.getLightColor();
+    glm::vec3 lightPos = (context.size() > 0) ? context.getActiveAsObject()->getOrigin() : glm::vec3(0.0f);
+    unsigned int displayMode = context.getDisplayMode();
+
+    // Point du plan proche sous chaque pixel : affine en (x, y), w étant le même sur tout le plan
+    glm::mat4 inverse = glm::inverse(viewProjection);
+    glm::vec4 corner = inverse * glm::vec4(-1.0f, 1.0f, -1.0f, 1.0f);
+    glm::vec4 stepX = inverse * glm::vec4(2.0f / m_width, 0.0f, 0.0f, 0.0f);
+    glm::vec4 stepY = inverse * glm::vec4(0.0f, -2.0f / m_height, 0.0f, 0.0f);
+    glm::vec3 eye = camera->Position;
+
+    parallelFor(0, m_height, [&](size_t y) {
+        for(unsigned int x = 0; x < m_width; ++x)
+        {
+            glm::vec3 color = background;
+            unsigned int id = m_raster.getId(x, y);
+
+            if(id != RASTER_NO_ID) {
+                const Object* object = m_objects[id];
+                const ptsTab &vertices = object->getVertexData();
+                const std::vector<unsigned int> &indexes = object->getTriangleIndexes();
+                unsigned int stride = object->getVertexStride();
+                size_t first = 3 * (size_t)m_raster.getPrimitive(x, y);
+                size_t corners[3] = {stride * (size_t)indexes[first], stride * (size_t)indexes[first + 1],
+                    stride * (size_t)indexes[first + 2]};
+
+                // Coordonnées barycentriques du point où le rayon du pixel coupe le plan du
+                // triangle (Möller-Trumbore sans rejet : le pixel est couvert par le triangle)
+                glm::vec4 point = corner + (float)x * stepX + (float)y * stepY;
+                glm::vec3 direction = glm::vec3(point) / point.w - eye;
+                glm::vec3 a = vertices[corners[0]] + object->getOrigin();
+                glm::vec3 edge1 = vertices[corners[1]] - vertices[corners[0]];
+                glm::vec3 edge2 = vertices[corners[2]] - vertices[corners[0]];
+                glm::vec3 p = glm::cross(direction, edge2);
+                float determinant = glm::dot(edge1, p);
+
+                float u = 1.0f / 3.0f, v = 1.0f / 3.0f;
+                if(determinant != 0.0f) {
+                    glm::vec3 toEye = eye - a;
+                    glm::vec3 q = glm::cross(toEye, edge1);
+                    u = glm::dot(toEye, p) / determinant;
+                    v = glm::dot(direction, q) / determinant;
+                }
+                float w = 1.0f - u - v;
+
+                // Attributs du VBO (normale puis UV) interpolés comme les sorties de lighted.vs
+                auto attribute = [&](unsigned int offset) {
+                    if(offset >= stride) return glm::vec3(0.0f);
+                    return w * vertices[corners[0] + offset] + u * vertices[corners[1] + offset]
+                        + v * vertices[corners[2] + offset];
+                };
+                glm::vec3 normal = attribute(1);
+                glm::vec3 uv = attribute(2);
+
+                color = lightedFragment(a + u * edge1 + v * edge2, normal, uv, object->getColor(),
+                    object->getAmbient(), lightColor, lightPos, displayMode);
+            }
+
+            unsigned char* out = &m_pixels[4 * ((size_t)y * m_width + x)];
+            out[0] = toByte(color.x);
+            out[1] = toByte(color.y);
+            out[2] = toByte(color.z);
+            out[3] = 255;
+        }
+    });
+
+    stats.shadeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shadeStart).count();
+    return stats;
+}
+
+
+const std::vector<unsigned char>& SoftwareRenderer::getPixels() const {return m_pixels;}
+unsigned int SoftwareRenderer::getWidth() const {return m_width;}
+unsigned int SoftwareRenderer::getHeight() const {return m_height;}
+
+
+void SoftwareRenderer::printStats(const std::string &name, const SoftwareStats &stats)
+{
+    std::cout << "Rendu logiciel " << name << " : " << stats.objects << " objets, " << stats.triangles
+        << " triangles (" << stats.rasterTriangles << " visibles a l'ecran), rasterisation "
+        << stats.rasterMilliseconds << " ms, eclairage " << stats.shadeMilliseconds << " ms" << std::endl;
+}
@@ -0,0 +1,90 @@
+#ifndef SOFTWARE_RENDERER_HPP
+#define SOFTWARE_RENDERER_HPP
+
+/**
+ * @file SoftwareRenderer.hpp
+ * @brief Définition de la classe SoftwareRenderer.
+ *
+ * Ce fichier contient le rendu des objets du contexte sur le processeur, sans OpenGL ni fenêtre :
+ * la même image que AppContext::drawContext() avec le shader lighted, pour les machines sans carte
+ * graphique.
+ *
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "AppContext.hpp"
+#include "Rasterizer.hpp"
+
+#define SOFTWARE_NEAR_PLANE 0.1f   // Mêmes plans que la projection de AppContext::drawContext()
+#define SOFTWARE_FAR_PLANE 100.0f
+#define SOFTWARE_LIGHT_ALPHA 4.0f  // Atténuation de la lumière avec la distance (cf. lighted.fs)
+
+
+/**
+ * @brief Bilan d'une image calculée par SoftwareRenderer::render().
+ */
+typedef struct s_SoftwareStats {
+    size_t objects;           // Objets dessinés en triangles
+    size_t triangles;         // Triangles de ces objets
+    size_t rasterTriangles;   // Triangles qui couvrent au moins un pixel, après découpage
+    double rasterMilliseconds;
+    double shadeMilliseconds;
+} SoftwareStats;
+
+
+/**
+ * @class SoftwareRenderer
+ * @brief Dessine les objets du contexte dans une image RGBA 8 bits, sans OpenGL.
+ *
+ * Le rendu reprend les données envoyées à OpenGL par les objets (sommets entrelacés du VBO et
+ * indices de l'EBO, cf. Object::getVertexData()) et se fait en deux passes :
+ * - visibilité : les triangles sont rastérisés par Rasterizer (tuiles en parallèle, fonctions
+ *   d'arête en SSE2), avec les mêmes matrices, plans de découpage et centres de pixels qu'OpenGL.
+ *   Le tampon ne garde que l'objet et le triangle vus en chaque pixel ;
+ * - éclairage : chaque pixel retrouve le point vu sur son triangle (intersection du rayon du pixel
+ *   avec le plan du triangle, ce qui donne l'interpolation en perspective d'OpenGL), interpole
+ *   normale et UV et calcule la couleur de lighted.fs, une seule fois par pixel quel que soit le
+ *   nombre de triangles superposés.
+ *
+ * Les objets dessinés en lignes (courbes de Bézier, rayons) ne sont pas rendus.
+ */
+class SoftwareRenderer
+{
+public:
+
+    SoftwareRenderer(unsigned int width, unsigned int height);
+
+    /**
+     * @brief Calcule l'image du contexte vue par sa caméra, éclairée par l'objet actif (cf.
+     * AppContext::drawContext()), dans le mode d'affichage du contexte.
+     */
+    SoftwareStats render(AppContext &context);
+
+    /**
+     * @brief Renvoie l'image de la dernière fois, RGBA 8 bits, ligne du haut en premier (cf.
+     * Capture::savePNG()).
+     */
+    const std::vector<unsigned char>& getPixels() const;
+
+    unsigned int getWidth() const;
+    unsigned int getHeight() const;
+
+    /**
+     * @brief Affiche un bilan dans le terminal.
+     */
+    static void printStats(const std::string &name, const SoftwareStats &stats);
+
+private:
+    unsigned int m_width;
+    unsigned int m_height;
+    Rasterizer m_raster;
+    std::vector<const Object*> m_objects; // Objet de chaque identifiant du tampon de visibilité
+    std::vector<unsigned char> m_pixels;
+};
+
+#endif // SOFTWARE_RENDERER_HPP
@@ -4,8 +4,11 @@
 Sphere::Sphere(float radius) : m_radius(radius)
 {
     // Completing Object constructor with EBO init
-    glGenBuffers(1, &EBOTriangles);
-    glGenBuffers(1, &EBOLines);
+    EBOTriangles = EBOLines = 0;
+    if(hasOpenGL()) {
+        glGenBuffers(1, &EBOTriangles);
+        glGenBuffers(1, &EBOLines);
+    }
 
     std::vector<unsigned int> lineIndexes;
 
@@ -20,6 +23,7 @@ Sphere::Sphere(float radius) : m_radius(radius)
 
     updateVertices(vertices);
     updateEBO(triangleIndexes, lineIndexes);
+    setTriangles(vertices, triangleIndexes);
 }
 
 
@@ -141,6 +145,9 @@ std::vector<unsigned int> Sphere::generateIndexes(unsigned int stackCount, unsig
 
 void Sphere::updateEBO(std::vector<unsigned int> triangleIndexes, std::vector<unsigned int> lineIndexes)
 {
+    setTriangleIndexes(triangleIndexes);
+    if(!hasOpenGL()) return;
+
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
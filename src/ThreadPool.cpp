@@ -0,0 +1,105 @@
+#include "ThreadPool.hpp"
+#include "Parallel.hpp"
+
+
+ThreadPool& ThreadPool::instance()
+{
+    static ThreadPool pool(threadCount() - 1);
+    return pool;
+}
+
+
+ThreadPool::ThreadPool(unsigned int workerCount) :
+    m_stop(false)
+{
+    for(unsigned int i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back([this]() {
+            while(true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [this]() {return m_stop || !m_tasks.empty();});
+                    if(m_stop && m_tasks.empty()) return;
+                    task = std::move(m_tasks.front());
+                    m_tasks.pop_front();
+                }
+                task();
+            }
+        });
+    }
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    for(std::thread &worker : m_workers) worker.join();
+}
+
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    // Sans thread, la tâche est exécutée tout de suite
+    if(m_workers.empty()) {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_condition.notify_one();
+}
+
+
+bool ThreadPool::runPendingTask()
+{
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_tasks.empty()) return false;
+        task = std::move(m_tasks.back()); // La plus récente : la plus petite en récursif
+        m_tasks.pop_back();
+    }
+    task();
+    return true;
+}
+
+
+unsigned int ThreadPool::getWorkerCount() const {return m_workers.size();}
+
+
+TaskGroup::TaskGroup(ThreadPool &pool) :
+    m_pool(pool),
+    m_pending(0)
+{
+}
+
+
+TaskGroup::~TaskGroup()
+{
+    wait();
+}
+
+
+void TaskGroup::run(std::function<void()> task)
+{
+    ++m_pending;
+    m_pool.submit([this, task]() {
+        task();
+        --m_pending;
+    });
+}
+
+
+void TaskGroup::wait()
+{
+    while(m_pending > 0) {
+        if(!m_pool.runPendingTask()) std::this_thread::yield();
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+/**
+ * @file ThreadPool.hpp
+ * @brief Définition des classes ThreadPool et TaskGroup.
+ * 
+ * Ce fichier contient un ensemble de threads créés une seule fois et auxquels on confie des tâches,
+ * pour les calculs récursifs (construction de hiérarchies englobantes, etc) où créer des threads à
+ * chaque appel comme parallelFor() coûterait trop cher.
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @class ThreadPool
+ * @brief File de tâches partagée par threadCount() - 1 threads (le thread appelant aide en attendant).
+ */
+class ThreadPool
+{
+public:
+
+    /**
+     * @brief Renvoie l'ensemble de threads commun au programme, créé au premier appel.
+     */
+    static ThreadPool& instance();
+
+    ThreadPool(unsigned int workerCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Ajoute une tâche à la file, elle sera exécutée par le premier thread libre.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Exécute une tâche de la file dans le thread appelant.
+     * @return false si la file était vide.
+     */
+    bool runPendingTask();
+
+    unsigned int getWorkerCount() const;
+
+private:
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stop;
+};
+
+
+/**
+ * @class TaskGroup
+ * @brief Groupe de tâches dont on attend la fin.
+ * 
+ * Pendant l'attente, le thread appelant exécute lui-même des tâches de la file : une tâche peut
+ * donc créer et attendre ses propres sous-tâches sans bloquer les threads de l'ensemble.
+ */
+class TaskGroup
+{
+public:
+    TaskGroup(ThreadPool &pool = ThreadPool::instance());
+
+    /**
+     * @brief Attend la fin des tâches du groupe.
+     */
+    ~TaskGroup();
+
+    void run(std::function<void()> task);
+    void wait();
+
+private:
+    ThreadPool &m_pool;
+    std::atomic<unsigned int> m_pending;
+};
+
+#endif // THREAD_POOL_HPP
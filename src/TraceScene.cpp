@@ -0,0 +1,764 @@
+#include "TraceScene.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <unordered_map>
+#include <glm/gtc/constants.hpp>
+
+
+/**
+ * @brief Complète la normale normée n en une base orthonormée (Duff et al. 2017, sans division par
+ * zéro ni normalisation).
+ */
+static void orthonormalBasis(const glm::vec3 &n, glm::vec3 &tangent, glm::vec3 &bitangent)
+{
+    float sign = std::copysign(1.0f, n.z);
+    float a = -1.0f / (sign + n.z);
+    float b = n.x * n.y * a;
+    tangent = glm::vec3(1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x);
+    bitangent = glm::vec3(b, sign + n.y * n.y * a, -n.y);
+}
+
+
+/**
+ * @brief Heuristique de puissance de Veach (exposant 2) : poids de la stratégie de densité pdf face
+ * à celle de densité other, pour la même direction.
+ */
+static float powerHeuristic(float pdf, float other)
+{
+    return (pdf * pdf) / (pdf * pdf + other * other);
+}
+
+
+TraceCamera::TraceCamera(AppContext &context, unsigned int width, unsigned int height) :
+    m_width(width),
+    m_height(height)
+{
+    Camera* camera = context.getCamera();
+    glm::mat4 projection = glm::perspective(glm::radians(camera->Zoom), (float)width / (float)height,
+        TRACE_NEAR_PLANE, TRACE_FAR_PLANE);
+
+    m_inverseProjection = glm::inverse(projection);
+    m_inverseView = glm::inverse(camera->GetViewMatrix());
+    m_viewProjection = projection * camera->GetViewMatrix();
+    m_position = camera->Position;
+}
+
+
+TraceRay TraceCamera::generate(float x, float y) const
+{
+    // Même calcul que Intersection::cameraRay() avec les matrices inverses déjà calculées
+    glm::vec4 rayClip((2.0f * x) / m_width - 1.0f, 1.0f - (2.0f * y) / m_height, -1.0f, 1.0f);
+
+    glm::vec4 rayEye = m_inverseProjection * rayClip;
+    rayEye = glm::vec4(rayEye.x, rayEye.y, -1.0f, 0.0f);
+
+    glm::vec4 rayWorld = m_inverseView * rayEye;
+
+    return {m_position, glm::normalize(glm::vec3(rayWorld))};
+}
+
+
+unsigned int TraceCamera::getWidth() const {return m_width;}
+unsigned int TraceCamera::getHeight() const {return m_height;}
+glm::vec3 TraceCamera::getPosition() const {return m_position;}
+const glm::mat4& TraceCamera::getViewProjection() const {return m_viewProjection;}
+
+
+bool TraceCamera::sameView(const TraceCamera &other) const
+{
+    return m_width == other.m_width && m_height == other.m_height && m_position == other.m_position
+        && m_inverseProjection == other.m_inverseProjection && m_inverseView == other.m_inverseView;
+}
+
+
+TraceScene::TraceScene(AppContext &context, unsigned int acceleration) :
+    m_acceleration(acceleration),
+    m_instanceStats(),
+    m_geometryVersion(0),
+    m_backgroundColor(context.getBackgroundColor()),
+    m_shadows(context.getTraceShadows()),
+    m_bounces(context.getTraceBounces()),
+    m_samples(std::max(context.getTraceSamples(), 1u)),
+    m_sampler(context.getTraceSampler()),
+    m_integrator(context.getTraceIntegrator()),
+    m_primary(context.getTracePrimary()),
+    m_light(nullptr),
+    m_lightPosition(0.0f),
+    m_lightColor(context.getLightColor()),
+    m_lightRadius(TRACE_LIGHT_MIN_RADIUS),
+    m_photonCount(context.getTracePhotons()),
+    m_causticsValid(false),
+    m_causticsVersion(0)
+{
+    // Les scènes sont construites par le thread principal (cf. AppContext::getTraceScene())
+    static unsigned int geometryVersions = 0;
+    m_geometryVersion = ++geometryVersions;
+
+    // Chaque géométrie partagée par plusieurs objets n'est ajoutée qu'une fois
+    std::unordered_map<const void*, unsigned int> geometries;
+    auto geometryIndex = [&geometries](const void* geometry, unsigned int count) {
+        return geometries.insert({geometry, count}).first->second;
+    };
+
+    std::vector<TraceInstance> instances;
+
+    for(const auto& object : context) {
+        Sphere* sphere = dynamic_cast<Sphere*>(object.get());
+        BezierSurface* surface = dynamic_cast<BezierSurface*>(object.get());
+        BezierCurve* curve = dynamic_cast<BezierCurve*>(object.get());
+
+        TraceInstance instance;
+        instance.object = object.get();
+        instance.geometry = 0;
+        instance.radius = 0.0f;
+        instance.origin = object->getOrigin();
+        instance.color = object->getColor();
+
+        if(sphere != nullptr) {
+            instance.type = TRACE_SPHERE;
+            instance.radius = sphere->getRadius();
+            instance.localMin = glm::vec3(-instance.radius);
+            instance.localMax = glm::vec3(instance.radius);
+        }
+        else if(surface != nullptr && surface->getPatch()->isValid()) {
+            instance.type = TRACE_PATCH;
+            instance.geometry = geometryIndex(surface->getPatch().get(), m_patches.size());
+            if(instance.geometry == m_patches.size()) m_patches.push_back(surface->getPatch());
+            m_patches[instance.geometry]->getBounds(instance.localMin, instance.localMax);
+        }
+        else if(curve != nullptr && curve->getTube()->isValid()) {
+            instance.type = TRACE_CURVE;
+            instance.geometry = geometryIndex(curve->getTube().get(), m_curves.size());
+            if(instance.geometry == m_curves.size()) m_curves.push_back(curve->getTube());
+            m_curves[instance.geometry]->getBounds(instance.localMin, instance.localMax);
+        }
+        else if(object->getMesh()) {
+            instance.type = TRACE_MESH;
+            instance.geometry = geometryIndex(object->getMesh().get(), m_meshes.size());
+            if(instance.geometry == m_meshes.size()) m_meshes.push_back(object->getMesh());
+            m_meshes[instance.geometry]->getBounds(instance.localMin, instance.localMax);
+        }
+        else continue;
+
+        instances.push_back(instance);
+    }
+
+    std::vector<BVHPrimitive> primitives = instanceBounds(instances);
+
+    if(m_acceleration == TRACE_ACCEL_GRID) {
+        m_instances = std::move(instances);
+        GridBuildStats stats = m_instanceGrid.build(primitives);
+        if(!m_instances.empty()) UniformGrid::printStats("instances", stats);
+    }
+    else {
+        std::vector<BVHNode> nodes;
+        std::vector<unsigned int> order;
+        m_instanceStats = BVHBuilder::build(primitives, TRACE_INSTANCES_PER_LEAF, nodes, order);
+        if(!instances.empty()) BVHBuilder::printStats("instances", m_instanceStats);
+        m_instanceTree = WideBVH(nodes);
+
+        m_instances.reserve(instances.size());
+        for(unsigned int index : order) m_instances.push_back(instances[index]);
+    }
+
+    // Le rayon de la sphère émettrice vient de l'instance de la lumière
+    setLight(context.getActiveAsObject());
+}
+
+
+std::vector<BVHPrimitive> TraceScene::instanceBounds(const std::vector<TraceInstance> &instances) const
+{
+    std::vector<BVHPrimitive> primitives(instances.size());
+    for(size_t i = 0; i < instances.size(); ++i)
+        primitives[i] = {instances[i].origin + instances[i].localMin, instances[i].origin + instances[i].localMax};
+    return primitives;
+}
+
+
+bool TraceScene::sameGeometry(const TraceInstance &instance) const
+{
+    switch(instance.type) {
+        case TRACE_SPHERE: {
+            const Sphere* sphere = dynamic_cast<const Sphere*>(instance.object);
+            return sphere != nullptr && sphere->getRadius() == instance.radius;
+        }
+        case TRACE_PATCH: {
+            const BezierSurface* surface = dynamic_cast<const BezierSurface*>(instance.object);
+            return surface != nullptr && surface->getPatch() == m_patches[instance.geometry];
+        }
+        case TRACE_CURVE: {
+            const BezierCurve* curve = dynamic_cast<const BezierCurve*>(instance.object);
+            return curve != nullptr && curve->getTube() == m_curves[instance.geometry];
+        }
+        default:
+            return instance.object->getMesh() == m_meshes[instance.geometry];
+    }
+}
+
+
+bool TraceScene::update()
+{
+    bool moved = false;
+
+    for(TraceInstance &instance : m_instances) {
+        if(!sameGeometry(instance)) return false;
+
+        glm::vec3 origin = instance.object->getOrigin();
+        if(origin != instance.origin) {
+            instance.origin = origin;
+            moved = true;
+        }
+        instance.color = instance.object->getColor();
+    }
+
+    if(moved) m_causticsValid = false;
+
+    if(moved && m_acceleration == TRACE_ACCEL_GRID) {
+        m_instanceGrid.build(instanceBounds(m_instances));
+        return true;
+    }
+
+    // La structure de la hiérarchie est gardée, seules ses boîtes suivent les objets
+    if(moved) {
+        m_instanceTree.refit([this](unsigned int first, unsigned int count, glm::vec3 &boundsMin,
+            glm::vec3 &boundsMax) {
+            for(unsigned int i = first; i < first + count; ++i) {
+                boundsMin = glm::min(boundsMin, m_instances[i].origin + m_instances[i].localMin);
+                boundsMax = glm::max(boundsMax, m_instances[i].origin + m_instances[i].localMax);
+            }
+        });
+    }
+
+    return true;
+}
+
+
+bool TraceScene::intersectInstance(const TraceInstance &instance, const TraceRay &ray, TraceHit &hit,
+    bool anyHit) const
+{
+    // Les géométries sont en coordonnées locales : c'est le rayon qui est déplacé
+    glm::vec3 origin = ray.origin - instance.origin;
+
+    switch(instance.type) {
+        case TRACE_SPHERE: {
+            // Même test que Intersection::Ray_Sphere(), sans calculer le rayon réfléchi
+            float t0, t1;
+            float a = glm::dot(ray.direction, ray.direction);
+            float b = 2 * glm::dot(ray.direction, origin);
+            float c = glm::dot(origin, origin) - instance.radius * instance.radius;
+            if(!solveQuadratic(a, b, c, t0, t1)) return false;
+
+            if(t0 < 0) {
+                t0 = t1;
+                if(t0 < 0) return false;
+            }
+            if(t0 >= hit.t) return false;
+
+            hit.t = t0;
+            return true;
+        }
+        case TRACE_PATCH:
+            return m_patches[instance.geometry]->intersect(origin, ray.direction, hit.t, hit.u, hit.v);
+        case TRACE_CURVE:
+            return m_curves[instance.geometry]->intersect(origin, ray.direction, hit.t, hit.normal);
+        default:
+            return m_meshes[instance.geometry]->intersect(origin, ray.direction, hit.t, hit.primitive, anyHit);
+    }
+}
+
+
+bool TraceScene::intersect(const TraceRay &ray, TraceHit &hit, bool meshes) const
+{
+    bool found = false;
+
+    // hit.t est la distance maximale passée au parcours, réduite par chaque instance touchée
+    if(m_acceleration == TRACE_ACCEL_GRID) {
+        m_instanceGrid.traverse(ray.origin, ray.direction, hit.t, [&](unsigned int index, float&) {
+            if(!meshes && m_instances[index].type == TRACE_MESH) return false;
+            if(!intersectInstance(m_instances[index], ray, hit)) return false;
+            hit.instance = index;
+            found = true;
+            return true;
+        });
+        return found;
+    }
+
+    m_instanceTree.traverse(ray.origin, ray.direction, hit.t, [&](unsigned int first, unsigned int count, float&) {
+        bool leafHit = false;
+        for(unsigned int i = first; i < first + count; ++i) {
+            if(!meshes && m_instances[i].type == TRACE_MESH) continue;
+            if(intersectInstance(m_instances[i], ray, hit)) {
+                hit.instance = i;
+                leafHit = true;
+            }
+        }
+        found |= leafHit;
+        return leafHit;
+    });
+    return found;
+}
+
+
+glm::vec3 TraceScene::hitNormal(const TraceRay &ray, const TraceHit &hit) const
+{
+    const TraceInstance &instance = m_instances[hit.instance];
+
+    switch(instance.type) {
+        case TRACE_SPHERE:
+            return glm::normalize(ray.origin + hit.t * ray.direction - instance.origin);
+        case TRACE_PATCH:
+            return m_patches[instance.geometry]->normal(hit.u, hit.v);
+        case TRACE_CURVE:
+            return hit.normal;
+        default: {
+            Triangle triangle = m_meshes[instance.geometry]->getTriangle(hit.primitive);
+            return glm::normalize(glm::cross(triangle.b - triangle.a, triangle.c - triangle.a));
+        }
+    }
+}
+
+
+TraceHit TraceScene::emptyHit()
+{
+    TraceHit hit;
+    hit.t = std::numeric_limits<float>::max();
+    hit.instance = 0;
+    hit.primitive = 0;
+    hit.u = hit.v = 0.0f;
+    hit.normal = glm::vec3(0.0f);
+    return hit;
+}
+
+
+TraceRay TraceScene::cameraRay(const TraceCamera &camera, unsigned int x, unsigned int y,
+    unsigned int sample) const
+{
+    if(m_samples == 1) return camera.generate(x, y);
+
+    glm::vec2 offset = m_sampler.get2D(x, y, sample, SAMPLER_DIMENSION_PIXEL);
+    return camera.generate(x + offset.x, y + offset.y);
+}
+
+
+glm::vec3 TraceScene::traceColor(const TraceRay &ray) const
+{
+    // Les distances sont comptées en multiples de la direction, supposée normée
+    glm::vec3 radiance(0.0f);
+    float throughput = 1.0f;
+    TraceRay current = ray;
+
+    for(unsigned int bounce = 0; ; ++bounce)
+    {
+        TraceHit hit = emptyHit();
+        if(!intersect(current, hit)) return radiance + throughput * m_backgroundColor;
+
+        // Au dernier rebond l'objet garde toute sa couleur, sinon une part vient du reflet
+        const TraceInstance &instance = m_instances[hit.instance];
+        float weight = (bounce == m_bounces) ? throughput : throughput * (1.0f - TRACE_REFLECTANCE);
+
+        // Les caustiques s'ajoutent avant la couleur, dans le même ordre que WavefrontTracer
+        glm::vec3 irradiance;
+        if(caustics(current, hit, irradiance)) radiance += weight * instance.color * irradiance;
+
+        glm::vec3 color = weight * instance.color;
+        TraceRay shadow;
+        float distance;
+        if(shadowRay(current, hit, shadow, distance) && occluded(shadow, distance)) color *= getShadowFactor();
+        radiance += color;
+
+        if(bounce == m_bounces) return radiance;
+
+        current = reflect(current, hit);
+        throughput *= TRACE_REFLECTANCE;
+    }
+}
+
+
+glm::vec3 TraceScene::traceRadiance(const TraceRay &ray, unsigned int x, unsigned int y,
+    unsigned int sample) const
+{
+    // Flux de la lumière réparti sur la surface de la sphère, dans toutes les directions
+    float pi = glm::pi<float>();
+    glm::vec3 emitted = m_lightColor * (TRACE_PHOTON_FLUX / (4.0f * pi * pi * m_lightRadius * m_lightRadius));
+    bool sampleLights = (m_light != nullptr && m_integrator != TRACE_INTEGRATOR_PATH_BSDF);
+
+    glm::vec3 radiance(0.0f);
+    glm::vec3 throughput(1.0f);
+    TraceRay current = ray;
+    bool specular = true; // Rayon primaire ou reflet de miroir : aucun rayon d'ombre n'a pu trouver la lumière
+    float bsdfPdf = 0.0f; // Densité du dernier rebond diffus, par angle solide
+
+    for(unsigned int bounce = 0; ; ++bounce)
+    {
+        TraceHit hit = emptyHit();
+        bool found = intersectSurfaces(current, hit);
+
+        float lightT;
+        if(m_light != nullptr && hitLight(current, lightT) && lightT < hit.t) {
+            float weight = 1.0f;
+            if(!specular && m_integrator == TRACE_INTEGRATOR_PATH_LIGHT) weight = 0.0f;
+            if(!specular && m_integrator == TRACE_INTEGRATOR_PATH_MIS)
+                weight = powerHeuristic(bsdfPdf, lightPdf(current.origin));
+            return radiance + weight * throughput * emitted;
+        }
+        if(!found) return radiance + throughput * m_backgroundColor;
+
+        const TraceInstance &instance = m_instances[hit.instance];
+        glm::vec3 normal = hitNormal(current, hit);
+        if(glm::dot(normal, current.direction) > 0.0f) normal = -normal;
+        glm::vec3 origin = current.origin + hit.t * current.direction + TRACE_RAY_EPSILON * normal;
+        glm::vec3 diffuse = instance.color * ((1.0f - TRACE_REFLECTANCE) / pi);
+        unsigned int dimension = SAMPLER_DIMENSION_PIXEL + TRACE_PATH_DIMENSIONS * (bounce + 1);
+
+        // Rayon d'ombre vers un point de la lumière tiré dans le cône qu'elle occupe vu du point
+        glm::vec3 direction;
+        float distance, pdf;
+        if(sampleLights && sampleLight(origin, m_sampler.get2D(x, y, sample, dimension), direction, distance, pdf)) {
+            float cosine = glm::dot(normal, direction);
+            if(cosine > 0.0f && !occluded({origin, direction}, distance)) {
+                float weight = 1.0f;
+                if(m_integrator == TRACE_INTEGRATOR_PATH_MIS)
+                    weight = powerHeuristic(pdf, (1.0f - TRACE_REFLECTANCE) * cosine / pi);
+                radiance += throughput * diffuse * emitted * (weight * cosine / pdf);
+            }
+        }
+
+        if(bounce == m_bounces) return radiance;
+
+        // Reflet de miroir avec une probabilité TRACE_REFLECTANCE, rebond diffus (cosinus) sinon
+        glm::vec2 u = m_sampler.get2D(x, y, sample, dimension + 2);
+        if(u.x < TRACE_REFLECTANCE) {
+            current = reflect(current, hit);
+            specular = true;
+            continue;
+        }
+
+        u.x = (u.x - TRACE_REFLECTANCE) / (1.0f - TRACE_REFLECTANCE);
+        glm::vec3 tangent, bitangent;
+        orthonormalBasis(normal, tangent, bitangent);
+        float r = std::sqrt(u.x);
+        float phi = 2.0f * pi * u.y;
+        float cosine = std::sqrt(std::max(0.0f, 1.0f - u.x));
+        current = {origin, r * std::cos(phi) * tangent + r * std::sin(phi) * bitangent + cosine * normal};
+
+        // BSDF x cosinus / densité : la couleur seule, la part diffuse s'annule avec sa probabilité
+        throughput *= instance.color;
+        bsdfPdf = (1.0f - TRACE_REFLECTANCE) * cosine / pi;
+        specular = false;
+    }
+}
+
+
+glm::vec3 TraceScene::traceSample(const TraceCamera &camera, unsigned int x, unsigned int y,
+    unsigned int sample) const
+{
+    TraceRay ray = cameraRay(camera, x, y, sample);
+    if(m_integrator == TRACE_INTEGRATOR_MIRROR) return traceColor(ray);
+    return traceRadiance(ray, x, y, sample);
+}
+
+
+unsigned int TraceScene::tracePath(const TraceRay &ray, unsigned int maxBounces, glm::vec3* points,
+    glm::vec3 &exit) const
+{
+    TraceRay current = ray;
+    unsigned int bounces = 0;
+
+    while(bounces < maxBounces)
+    {
+        TraceHit hit = emptyHit();
+        if(!intersect(current, hit)) break;
+
+        // Le point gardé est celui de la surface, pas l'origine décalée du rayon réfléchi
+        points[bounces++] = current.origin + hit.t * current.direction;
+        current = reflect(current, hit);
+    }
+
+    exit = current.direction;
+    return bounces;
+}
+
+
+bool TraceScene::shadowRay(const TraceRay &ray, const TraceHit &hit, TraceRay &shadow, float &distance) const
+{
+    if(!m_shadows || m_light == nullptr || m_instances[hit.instance].object == m_light) return false;
+
+    glm::vec3 point = ray.origin + hit.t * ray.direction;
+    glm::vec3 toLight = m_lightPosition - point;
+    distance = glm::length(toLight);
+    if(distance <= TRACE_RAY_EPSILON) return false;
+
+    shadow.direction = toLight / distance;
+    shadow.origin = point + TRACE_RAY_EPSILON * shadow.direction;
+    distance -= TRACE_RAY_EPSILON;
+    return true;
+}
+
+
+TraceRay TraceScene::reflect(const TraceRay &ray, const TraceHit &hit) const
+{
+    glm::vec3 normal = hitNormal(ray, hit);
+    if(glm::dot(normal, ray.direction) > 0.0f) normal = -normal;
+
+    // Même rayon réfléchi que Intersection::hitReflexion(), décalé pour ne pas retoucher la surface
+    glm::vec3 point = ray.origin + hit.t * ray.direction;
+    glm::vec3 direction = ray.direction - 2 * glm::dot(ray.direction, normal) * normal;
+    return {point + TRACE_RAY_EPSILON * normal, direction};
+}
+
+
+bool TraceScene::intersectSurfaces(const TraceRay &ray, TraceHit &hit) const
+{
+    float travelled = 0.0f;
+
+    for(unsigned int crossings = 0; crossings <= TRACE_PHOTON_LIGHT_CROSSINGS; ++crossings)
+    {
+        TraceRay current = {ray.origin + travelled * ray.direction, ray.direction};
+        TraceHit next = emptyHit();
+        next.t = hit.t - travelled;
+        if(!intersect(current, next)) return false;
+
+        if(m_instances[next.instance].object != m_light) {
+            hit = next;
+            hit.t += travelled;
+            return true;
+        }
+
+        // La lumière est remplacée par sa sphère émettrice, le rayon traverse l'objet
+        travelled += next.t + TRACE_RAY_EPSILON;
+    }
+    return false;
+}
+
+
+bool TraceScene::hitLight(const TraceRay &ray, float &t) const
+{
+    float t0, t1;
+    glm::vec3 origin = ray.origin - m_lightPosition;
+    if(!solveQuadratic(glm::dot(ray.direction, ray.direction), 2 * glm::dot(ray.direction, origin),
+        glm::dot(origin, origin) - m_lightRadius * m_lightRadius, t0, t1)) return false;
+
+    // Un point à l'intérieur de la sphère ne la voit pas (cf. lightPdf())
+    if(t0 <= 0.0f) return false;
+    t = t0;
+    return true;
+}
+
+
+float TraceScene::lightPdf(const glm::vec3 &point) const
+{
+    glm::vec3 toCenter = m_lightPosition - point;
+    float distance2 = glm::dot(toCenter, toCenter);
+    float radius2 = m_lightRadius * m_lightRadius;
+    if(distance2 <= radius2) return 0.0f;
+
+    // 1 - cos(angle du cône), sans perte de précision pour une lumière lointaine
+    float sin2Max = radius2 / distance2;
+    float oneMinusCosMax = sin2Max / (1.0f + std::sqrt(1.0f - sin2Max));
+    return 1.0f / (2.0f * glm::pi<float>() * oneMinusCosMax);
+}
+
+
+bool TraceScene::sampleLight(const glm::vec3 &point, const glm::vec2 &u, glm::vec3 &direction,
+    float &distance, float &pdf) const
+{
+    glm::vec3 toCenter = m_lightPosition - point;
+    float distance2 = glm::dot(toCenter, toCenter);
+    float radius2 = m_lightRadius * m_lightRadius;
+    if(distance2 <= radius2) return false;
+
+    float sin2Max = radius2 / distance2;
+    float oneMinusCosMax = sin2Max / (1.0f + std::sqrt(1.0f - sin2Max));
+    float oneMinusCos = u.x * oneMinusCosMax;
+    float sin2Theta = oneMinusCos * (2.0f - oneMinusCos);
+    float sinTheta = std::sqrt(sin2Theta);
+    float phi = 2.0f * glm::pi<float>() * u.y;
+
+    float centerDistance = std::sqrt(distance2);
+    glm::vec3 axis = toCenter / centerDistance;
+    glm::vec3 tangent, bitangent;
+    orthonormalBasis(axis, tangent, bitangent);
+    direction = (1.0f - oneMinusCos) * axis + sinTheta * (std::cos(phi) * tangent + std::sin(phi) * bitangent);
+
+    // Plus proche point de la sphère dans cette direction
+    distance = centerDistance * (1.0f - oneMinusCos) - std::sqrt(std::max(0.0f, radius2 - distance2 * sin2Theta));
+    pdf = 1.0f / (2.0f * glm::pi<float>() * oneMinusCosMax);
+    return true;
+}
+
+
+glm::vec3 TraceScene::getShadowFactor() const {return TRACE_SHADOW_AMBIENT * m_lightColor;}
+
+
+bool TraceScene::occluded(const TraceRay &ray, float tMax) const
+{
+    auto blocks = [&](const TraceInstance &instance) {
+        TraceHit hit = emptyHit();
+        hit.t = tMax;
+        return instance.object != m_light && intersectInstance(instance, ray, hit, true);
+    };
+
+    if(m_acceleration == TRACE_ACCEL_GRID) {
+        return m_instanceGrid.traverseAny(ray.origin, ray.direction, tMax, [&](unsigned int index, float) {
+            return blocks(m_instances[index]);
+        });
+    }
+
+    return m_instanceTree.traverseAny(ray.origin, ray.direction, tMax,
+        [&](unsigned int first, unsigned int count, float) {
+        for(unsigned int i = first; i < first + count; ++i)
+            if(blocks(m_instances[i])) return true;
+        return false;
+    });
+}
+
+
+void TraceScene::setLight(const Object* light)
+{
+    if(light != m_light || (light != nullptr && light->getOrigin() != m_lightPosition)) m_causticsValid = false;
+
+    m_light = light;
+    if(m_light == nullptr) return;
+    m_lightPosition = m_light->getOrigin();
+
+    // Sphère englobante autour de l'origine, exacte pour une sphère
+    m_lightRadius = TRACE_LIGHT_MIN_RADIUS;
+    for(const TraceInstance &instance : m_instances) {
+        if(instance.object != m_light) continue;
+        glm::vec3 extent = glm::max(glm::abs(instance.localMin), glm::abs(instance.localMax));
+        float radius = (instance.type == TRACE_SPHERE) ? instance.radius : glm::length(extent);
+        m_lightRadius = std::max(m_lightRadius, radius);
+    }
+}
+
+
+void TraceScene::updateCaustics()
+{
+    if(m_causticsValid) return;
+    m_causticsValid = true;
+    m_causticsVersion++;
+    m_caustics.clear();
+    if(m_photonCount == 0 || m_light == nullptr || m_integrator != TRACE_INTEGRATOR_MIRROR) return;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Chaque tranche a son propre générateur : le résultat ne dépend pas du nombre de threads
+    size_t chunks = (m_photonCount + TRACE_PHOTON_CHUNK - 1) / TRACE_PHOTON_CHUNK;
+    std::vector<std::vector<Photon>> stored(chunks);
+    glm::vec3 power = m_lightColor * (TRACE_PHOTON_FLUX / m_photonCount);
+
+    parallelFor(0, chunks, [&](size_t chunk) {
+        std::mt19937 generator(chunk);
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        size_t last = std::min<size_t>(m_photonCount, (chunk + 1) * TRACE_PHOTON_CHUNK);
+
+        for(size_t i = chunk * TRACE_PHOTON_CHUNK; i < last; ++i) {
+            // Direction uniforme sur la sphère
+            float z = 1.0f - 2.0f * uniform(generator);
+            float phi = 2.0f * glm::pi<float>() * uniform(generator);
+            float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+            tracePhoton({m_lightPosition, glm::vec3(r * std::cos(phi), r * std::sin(phi), z)}, power, stored[chunk]);
+        }
+    });
+
+    std::vector<Photon> photons;
+    for(const std::vector<Photon> &chunk : stored) photons.insert(photons.end(), chunk.begin(), chunk.end());
+    double emitted = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    m_caustics.build(std::move(photons));
+    double total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Caustiques : " << m_photonCount << " photons emis, " << m_caustics.size() << " deposes, "
+        << total << " ms (emission " << emitted << " ms, arbre kd " << total - emitted << " ms)" << std::endl;
+}
+
+
+void TraceScene::tracePhoton(const TraceRay &ray, glm::vec3 power, std::vector<Photon> &photons) const
+{
+    TraceRay current = ray;
+    unsigned int bounces = 0;
+    unsigned int crossings = 0;
+
+    while(bounces <= m_bounces)
+    {
+        TraceHit hit = emptyHit();
+        if(!intersect(current, hit)) return;
+
+        // La lumière ne fait pas d'ombre, le photon la traverse
+        glm::vec3 point = current.origin + hit.t * current.direction;
+        if(m_instances[hit.instance].object == m_light) {
+            if(++crossings > TRACE_PHOTON_LIGHT_CROSSINGS) return;
+            current.origin = point + TRACE_RAY_EPSILON * current.direction;
+            continue;
+        }
+
+        // L'éclairement direct est celui des rayons d'ombre : seuls les photons déjà réfléchis comptent
+        if(bounces > 0) photons.push_back({point, power, current.direction, 0});
+
+        current = reflect(current, hit);
+        power *= TRACE_REFLECTANCE;
+        bounces++;
+    }
+}
+
+
+bool TraceScene::caustics(const TraceRay &ray, const TraceHit &hit, glm::vec3 &irradiance) const
+{
+    if(m_caustics.empty()) return false;
+
+    glm::vec3 normal = hitNormal(ray, hit);
+    if(glm::dot(normal, ray.direction) > 0.0f) normal = -normal;
+
+    irradiance = m_caustics.irradiance(ray.origin + hit.t * ray.direction, normal, TRACE_PHOTON_GATHER,
+        TRACE_PHOTON_RADIUS);
+    return true;
+}
+
+
+const PhotonMap& TraceScene::getCaustics() const {return m_caustics;}
+unsigned int TraceScene::getCausticsVersion() const {return m_causticsVersion;}
+
+
+glm::vec3 TraceScene::getBackgroundColor() const {return m_backgroundColor;}
+const BVHBuildStats& TraceScene::getBuildStats() const {return m_instanceStats;}
+unsigned int TraceScene::getInstanceCount() const {return m_instances.size();}
+unsigned int TraceScene::getAcceleration() const {return m_acceleration;}
+unsigned int TraceScene::getBounces() const {return m_bounces;}
+unsigned int TraceScene::getSamples() const {return m_samples;}
+const Sampler& TraceScene::getSampler() const {return m_sampler;}
+unsigned int TraceScene::getIntegrator() const {return m_integrator;}
+unsigned int TraceScene::getPrimary() const {return m_primary;}
+float TraceScene::getLightRadius() const {return m_lightRadius;}
+const Object* TraceScene::getLight() const {return m_light;}
+glm::vec3 TraceScene::getLightPosition() const {return m_lightPosition;}
+unsigned int TraceScene::getGeometryVersion() const {return m_geometryVersion;}
+const TraceInstance& TraceScene::getInstance(unsigned int index) const {return m_instances[index];}
+
+
+const MeshBVH* TraceScene::getMesh(unsigned int instance) const
+{
+    const TraceInstance &traced = m_instances[instance];
+    return (traced.type == TRACE_MESH) ? m_meshes[traced.geometry].get() : nullptr;
+}
+
+
+void TraceScene::getBounds(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const
+{
+    boundsMin = glm::vec3(std::numeric_limits<float>::max());
+    boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+    for(const BVHPrimitive &bounds : instanceBounds(m_instances)) {
+        boundsMin = glm::min(boundsMin, bounds.boundsMin);
+        boundsMax = glm::max(boundsMax, bounds.boundsMax);
+    }
+}
+
+
+unsigned int TraceScene::getGeometryCount() const
+{
+    return m_meshes.size() + m_patches.size() + m_curves.size();
+}
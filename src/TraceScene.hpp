@@ -0,0 +1,466 @@
+#ifndef TRACE_SCENE_HPP
+#define TRACE_SCENE_HPP
+
+/**
+ * @file TraceScene.hpp
+ * @brief Définition des classes TraceCamera et TraceScene.
+ * 
+ * Ce fichier contient la copie de la scène utilisée par le lancer de rayons des captures d'écran.
+ * Contrairement aux objets du contexte, elle ne crée aucune ressource OpenGL et peut être lue
+ * depuis plusieurs threads à la fois.
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "AppContext.hpp"
+#include "BezierCurve.hpp"
+#include "BezierSurface.hpp"
+#include "MeshBVH.hpp"
+#include "PhotonMap.hpp"
+#include "Sampler.hpp"
+#include "Sphere.hpp"
+#include "UniformGrid.hpp"
+#include "WideBVH.hpp"
+
+#define TRACE_NEAR_PLANE 0.1f
+#define TRACE_FAR_PLANE 100.0f
+#define TRACE_INSTANCES_PER_LEAF 4
+
+#define TRACE_SPHERE 0 // Sphère testée directement
+#define TRACE_MESH 1   // Maillage et sa hiérarchie (MeshBVH)
+#define TRACE_PATCH 2  // Surface de Bézier testée directement (BezierPatch)
+#define TRACE_CURVE 3  // Tube autour d'une courbe de Bézier (BezierTube)
+
+#define TRACE_ACCEL_BVH 0  // Instances dans une hiérarchie (WideBVH), recalculée quand elles bougent
+#define TRACE_ACCEL_GRID 1 // Instances dans une grille (UniformGrid), reconstruite quand elles bougent
+
+#define TRACE_SHADOW_AMBIENT 0.2f // Part de la lumière qui reste dans l'ombre (cf. lighted.fs)
+#define TRACE_RAY_EPSILON 0.001f  // Décalage de l'origine des rayons secondaires (auto-intersection)
+#define TRACE_REFLECTANCE 0.3f    // Part de la couleur d'un point qui vient de son reflet
+#define TRACE_DEFAULT_BOUNCES 2   // Rebonds suivis par défaut après le rayon primaire
+#define TRACE_MISS 0xFFFFFFFFu    // TraceHit::instance d'un rayon qui ne touche rien
+
+#define TRACE_DEFAULT_SAMPLES 1 // Échantillons par pixel par défaut (un rayon au coin du pixel)
+#define TRACE_KEY_MAX_SAMPLES 64 // Échantillons par pixel au plus au clavier (x4 à chaque appui, puis 1)
+#define TRACE_PATH_SAMPLES 16    // Échantillons par pixel donnés aux chemins aléatoires choisis au clavier
+
+#define TRACE_INTEGRATOR_MIRROR 0     // Miroirs et rayons d'ombre, sans hasard (cf. traceColor())
+#define TRACE_INTEGRATOR_PATH_BSDF 1  // Chemins aléatoires, la lumière n'est trouvée que par les rebonds
+#define TRACE_INTEGRATOR_PATH_LIGHT 2 // Chemins aléatoires, la lumière n'est comptée que par rayon d'ombre
+#define TRACE_INTEGRATOR_PATH_MIS 3   // Les deux stratégies, pondérées par l'heuristique de puissance
+#define TRACE_INTEGRATOR_COUNT 4
+
+#define TRACE_PRIMARY_RAYS 0   // Points vus par la caméra trouvés par les rayons primaires
+#define TRACE_PRIMARY_RASTER 1 // Maillages rastérisés pour les points vus (cf. GBuffer), rayons pour le reste
+
+#define TRACE_LIGHT_MIN_RADIUS 0.05f // Rayon de la sphère émettrice d'une lumière sans géométrie
+#define TRACE_PATH_DIMENSIONS 4      // Dimensions de l'échantillonneur par rebond (lumière 2, rebond 2)
+
+#define TRACE_DEFAULT_PHOTONS 0        // Photons émis par défaut pour les caustiques (0 : pas de caustiques)
+#define TRACE_CAUSTIC_PHOTONS 200000   // Photons émis quand les caustiques sont activées au clavier
+#define TRACE_PHOTON_FLUX 50.0f        // Flux de la lumière (4 pi x 4 : éclairement de 1 à 2 unités)
+#define TRACE_PHOTON_GATHER 32         // Photons voisins d'une estimation des caustiques
+#define TRACE_PHOTON_RADIUS 0.2f       // Distance maximale de ces voisins
+#define TRACE_PHOTON_CHUNK 4096        // Photons émis par tâche
+#define TRACE_PHOTON_LIGHT_CROSSINGS 4 // Surfaces de l'objet lumière qu'un photon peut traverser
+
+
+/**
+ * @brief Rayon sans ressource OpenGL (contrairement à la classe Ray), utilisé pour le rendu.
+ */
+typedef struct s_TraceRay {
+    glm::vec3 origin;
+    glm::vec3 direction;
+} TraceRay;
+
+/**
+ * @brief Objet de la scène : une géométrie en coordonnées locales (partagée entre toutes les
+ * instances qui l'utilisent) placée à l'origine de l'objet.
+ */
+typedef struct s_TraceInstance {
+    const Object* object;   // Objet du contexte dont l'instance suit l'origine et la couleur
+    unsigned int type;      // TRACE_SPHERE, TRACE_MESH, TRACE_PATCH ou TRACE_CURVE
+    unsigned int geometry;  // Indice de la géométrie parmi celles de son type
+    float radius;           // Rayon des sphères
+    glm::vec3 origin;
+    glm::vec3 color;
+    glm::vec3 localMin;     // Boîte de la géométrie, en coordonnées locales
+    glm::vec3 localMax;
+} TraceInstance;
+
+/**
+ * @brief Intersection retenue par TraceScene::intersect() : la distance et de quoi retrouver la
+ * normale ensuite (cf. TraceScene::hitNormal()), pour le point retenu seulement.
+ */
+typedef struct s_TraceHit {
+    float t;                // Distance en multiples de la direction du rayon
+    unsigned int instance;  // Instance touchée (cf. TraceScene::getInstance())
+    unsigned int primitive; // Triangle touché pour un maillage
+    float u, v;             // Paramètres du point touché pour un carreau de Bézier
+    glm::vec3 normal;       // Normale pour un tube, donnée par son test d'intersection
+} TraceHit;
+
+/**
+ * @brief Chemins de plusieurs rayons de reflet en reflet (cf. TraceScene::tracePath()), rangés à
+ * taille fixe pour que chaque chemin puisse être écrit par un thread différent.
+ */
+typedef struct s_RayPaths {
+    unsigned int maxBounces;           // Points réservés pour chaque chemin
+    std::vector<glm::vec3> points;     // Points touchés par le chemin i, à partir de i * maxBounces
+    std::vector<unsigned int> bounces; // Nombre de points touchés par chaque chemin
+    std::vector<glm::vec3> exits;      // Direction de chaque chemin après son dernier point
+} RayPaths;
+
+
+/**
+ * @class TraceCamera
+ * @brief Génère les rayons primaires d'une image de taille quelconque.
+ * 
+ * Les matrices inverses sont calculées une seule fois à la construction, et non à chaque pixel
+ * comme dans Intersection::cameraRay(). La projection est recalculée pour le rapport largeur /
+ * hauteur de l'image, ce qui permet des captures à une autre résolution que celle de la fenêtre.
+ */
+class TraceCamera
+{
+public:
+
+    /**
+     * @brief Constructeur.
+     * @param context contexte dont on reprend la caméra.
+     * @param width, height résolution de l'image à calculer.
+     */
+    TraceCamera(AppContext &context, unsigned int width, unsigned int height);
+
+    /**
+     * @brief Renvoie le rayon passant par le pixel (x, y) de l'image (origine en haut à gauche).
+     */
+    TraceRay generate(float x, float y) const;
+
+    unsigned int getWidth() const;
+    unsigned int getHeight() const;
+    glm::vec3 getPosition() const;
+
+    /**
+     * @brief Renvoie la matrice projection * vue qui correspond aux rayons de generate().
+     */
+    const glm::mat4& getViewProjection() const;
+
+    /**
+     * @brief Renvoie true si les deux caméras génèrent exactement les mêmes rayons.
+     */
+    bool sameView(const TraceCamera &other) const;
+
+private:
+    glm::mat4 m_inverseProjection;
+    glm::mat4 m_inverseView;
+    glm::mat4 m_viewProjection;
+    glm::vec3 m_position;
+    unsigned int m_width;
+    unsigned int m_height;
+};
+
+
+/**
+ * @class TraceScene
+ * @brief Copie en lecture seule des objets du contexte qui peuvent être touchés par un rayon.
+ * 
+ * La scène a deux niveaux. Chaque géométrie unique (maillage, carreau ou tube de Bézier) est
+ * gardée une seule fois avec sa propre hiérarchie, en coordonnées locales, quel que soit le nombre
+ * d'objets qui l'utilisent. Les objets sont des instances (géométrie + origine) rangées dans une
+ * hiérarchie de premier niveau construite par BVHBuilder (bilan affiché à la construction) puis
+ * repliée en noeuds à quatre fils (cf. WideBVH). Déplacer un objet ne demande que de recalculer les
+ * boîtes de ce premier niveau (cf. update()). Pour les scènes dont beaucoup d'objets bougent à
+ * chaque image, le premier niveau peut être une grille régulière (TRACE_ACCEL_GRID), reconstruite
+ * entièrement en temps linéaire plutôt que recalculée.
+ * 
+ * Les sphères et les surfaces de Bézier sont testées directement (plus précis que leur maillage),
+ * les courbes de Bézier par un tube autour de la courbe et les autres objets qui ont un maillage
+ * par leur hiérarchie englobante.
+ *
+ * La lumière est l'objet actif du contexte, comme pour le rendu OpenGL (cf. AppContext::draw()) :
+ * un rayon d'ombre est lancé du point touché vers son origine et s'arrête au premier obstacle
+ * (cf. occluded()), sans chercher le plus proche. L'objet lumière lui-même ne fait pas d'ombre.
+ *
+ * Comme pour les rayons de Intersection::rayContextPath(), tous les objets sont des miroirs : un
+ * point prend (1 - TRACE_REFLECTANCE) de sa couleur et TRACE_REFLECTANCE de son reflet, sur
+ * getBounces() rebonds au plus.
+ *
+ * Les caustiques (lumière concentrée par les reflets des miroirs) sont calculées par une carte de
+ * photons (cf. updateCaustics()) : des photons partent de la lumière dans toutes les directions,
+ * suivent les mêmes reflets que les rayons et sont déposés sur les surfaces touchées après au
+ * moins un reflet. L'éclairement direct reste celui des rayons d'ombre.
+ *
+ * Les intégrateurs TRACE_INTEGRATOR_PATH_* remplacent ce modèle par des chemins aléatoires (cf.
+ * traceRadiance()) : la lumière devient une sphère émettrice et les objets sont diffus, avec
+ * TRACE_REFLECTANCE de miroir.
+ */
+class TraceScene
+{
+public:
+
+    /**
+     * @brief Construit la scène à partir des objets du contexte.
+     * @param acceleration structure du premier niveau, TRACE_ACCEL_BVH ou TRACE_ACCEL_GRID.
+     */
+    TraceScene(AppContext &context, unsigned int acceleration = TRACE_ACCEL_BVH);
+
+    /**
+     * @brief Renvoie la couleur vue par le rayon, un rayon à la fois : celle de l'objet le plus
+     * proche touché (même résultat que Intersection::rayColorPoint() sans rebond), ou la couleur
+     * de fond, mélangée à celle de ses reflets. Si les ombres sont actives, la couleur d'un point
+     * caché de la lumière est multipliée par getShadowFactor(). Cf. WavefrontTracer pour des
+     * images entières.
+     */
+    glm::vec3 traceColor(const TraceRay &ray) const;
+
+    /**
+     * @brief Renvoie la radiance vue par le rayon le long d'un chemin aléatoire, dont les nombres
+     * sont ceux de l'échantillon sample du pixel (x, y) (cf. getSampler()).
+     *
+     * La lumière est une sphère de rayon getLightRadius() autour de l'origine de l'objet lumière
+     * (qui n'est plus touché lui-même), de flux TRACE_PHOTON_FLUX. Les objets renvoient
+     * TRACE_REFLECTANCE de la lumière comme un miroir et le reste de façon diffuse (Lambert), avec
+     * leur couleur, sur getBounces() rebonds au plus. À chaque point diffus, selon l'intégrateur :
+     * - TRACE_INTEGRATOR_PATH_BSDF : la lumière ne compte que si le rebond la touche ;
+     * - TRACE_INTEGRATOR_PATH_LIGHT : un point de la lumière est tiré (cône de la sphère vue du point)
+     *   et testé par un rayon d'ombre, un rebond diffus qui touche la lumière ne compte plus ;
+     * - TRACE_INTEGRATOR_PATH_MIS : les deux, chacun pondéré par l'heuristique de puissance de
+     *   Veach (densités des deux stratégies pour la même direction).
+     * Après un reflet de miroir, la lumière touchée compte toujours (aucun rayon d'ombre ne peut
+     * trouver cette direction). Les ombres et les caustiques du modèle miroir sont inutiles ici.
+     */
+    glm::vec3 traceRadiance(const TraceRay &ray, unsigned int x, unsigned int y, unsigned int sample) const;
+
+    /**
+     * @brief Renvoie la couleur de l'échantillon sample du pixel (x, y) avec l'intégrateur de la
+     * scène : traceColor() ou traceRadiance() sur le rayon de cameraRay().
+     */
+    glm::vec3 traceSample(const TraceCamera &camera, unsigned int x, unsigned int y, unsigned int sample) const;
+
+    /**
+     * @brief Suit le rayon de reflet en reflet comme Intersection::rayContextPath(), sans limite
+     * de rebonds de la scène (cf. getBounces()).
+     * @param points reçoit les points touchés, maxBounces au plus.
+     * @param exit reçoit la direction du rayon après le dernier point touché.
+     * @return le nombre de points touchés.
+     */
+    unsigned int tracePath(const TraceRay &ray, unsigned int maxBounces, glm::vec3* points,
+        glm::vec3 &exit) const;
+
+    /**
+     * @brief Renvoie le rayon primaire de l'échantillon sample du pixel (x, y) : le coin du pixel
+     * (comme TraceCamera::generate()) pour les images à un échantillon par pixel, un point du pixel
+     * donné par getSampler() sinon.
+     */
+    TraceRay cameraRay(const TraceCamera &camera, unsigned int x, unsigned int y, unsigned int sample) const;
+
+    /**
+     * @brief Cherche l'instance la plus proche touchée avant hit.t (cf. emptyHit()).
+     * @param meshes false pour ne tester que les instances qui ne sont pas des maillages (leurs
+     * points déjà trouvés par rastérisation).
+     * @return true si hit a été mis à jour.
+     */
+    bool intersect(const TraceRay &ray, TraceHit &hit, bool meshes = true) const;
+
+    /**
+     * @brief Renvoie la normale (normée) au point retenu par intersect().
+     */
+    glm::vec3 hitNormal(const TraceRay &ray, const TraceHit &hit) const;
+
+    /**
+     * @brief Prépare le rayon d'ombre du point touché, vers la lumière.
+     * @param distance distance à ne pas dépasser (la lumière).
+     * @return false si le point n'a pas besoin de rayon d'ombre (ombres inactives, pas de lumière
+     * ou point de l'objet lumière).
+     */
+    bool shadowRay(const TraceRay &ray, const TraceHit &hit, TraceRay &shadow, float &distance) const;
+
+    /**
+     * @brief Renvoie le rayon réfléchi au point touché.
+     */
+    TraceRay reflect(const TraceRay &ray, const TraceHit &hit) const;
+
+    /**
+     * @brief Estime l'éclairement des caustiques au point retenu par intersect(), à partir de ses
+     * TRACE_PHOTON_GATHER plus proches photons.
+     * @return false si la carte de photons est vide (caustiques inactives).
+     */
+    bool caustics(const TraceRay &ray, const TraceHit &hit, glm::vec3 &irradiance) const;
+
+    /**
+     * @brief Émet les photons des caustiques et reconstruit leur carte, en parallèle, si des objets
+     * ou la lumière ont bougé depuis la dernière fois. Ne fait rien si les caustiques sont
+     * inactives (cf. AppContext::setTracePhotons()), s'il n'y a pas de lumière ou avec les
+     * intégrateurs TRACE_INTEGRATOR_PATH_* (les chemins aléatoires trouvent eux-mêmes les caustiques).
+     */
+    void updateCaustics();
+
+    const PhotonMap& getCaustics() const;
+
+    /**
+     * @brief Numéro de la carte de photons, changé à chaque fois qu'elle est reconstruite.
+     */
+    unsigned int getCausticsVersion() const;
+
+    /**
+     * @brief Facteur appliqué à la couleur d'un point à l'ombre.
+     */
+    glm::vec3 getShadowFactor() const;
+
+    /**
+     * @brief Renvoie un TraceHit sans intersection (distance maximale).
+     */
+    static TraceHit emptyHit();
+
+    /**
+     * @brief Renvoie true si un objet (autre que la lumière) est touché avant tMax. Le parcours
+     * s'arrête au premier trouvé et ne calcule rien d'autre que sa distance.
+     */
+    bool occluded(const TraceRay &ray, float tMax) const;
+
+    /**
+     * @brief Choisit l'objet qui sert de lumière et reprend sa position (nullptr : pas d'ombres).
+     */
+    void setLight(const Object* light);
+
+    /**
+     * @brief Reprend l'origine et la couleur des objets du contexte. Si des objets ont bougé, seules
+     * les boîtes de la hiérarchie de premier niveau sont recalculées (ou la grille reconstruite).
+     * @return false si la géométrie d'un objet a changé : la scène doit alors être reconstruite.
+     */
+    bool update();
+
+    glm::vec3 getBackgroundColor() const;
+
+    /**
+     * @brief Renvoie le bilan de la construction de la hiérarchie de premier niveau.
+     */
+    const BVHBuildStats& getBuildStats() const;
+
+    unsigned int getInstanceCount() const;
+    const TraceInstance& getInstance(unsigned int index) const;
+
+    /**
+     * @brief Renvoie le maillage de l'instance, nullptr si elle n'est pas de type TRACE_MESH.
+     */
+    const MeshBVH* getMesh(unsigned int instance) const;
+
+    unsigned int getAcceleration() const;
+    unsigned int getBounces() const;
+    unsigned int getSamples() const;
+    const Sampler& getSampler() const;
+    unsigned int getIntegrator() const;
+
+    /**
+     * @brief Origine des points vus par la caméra dans les captures, TRACE_PRIMARY_RAYS ou
+     * TRACE_PRIMARY_RASTER (cf. GBuffer).
+     */
+    unsigned int getPrimary() const;
+    const Object* getLight() const;
+    glm::vec3 getLightPosition() const;
+
+    /**
+     * @brief Numéro de la géométrie de la scène, différent pour chaque scène construite. Tant qu'il
+     * ne change pas, les instances restent les mêmes, dans le même ordre : seuls leur origine et
+     * leur couleur peuvent changer (cf. update()).
+     */
+    unsigned int getGeometryVersion() const;
+
+    /**
+     * @brief Rayon de la sphère émettrice des intégrateurs TRACE_INTEGRATOR_PATH_* : sphère
+     * englobante de l'objet lumière autour de son origine, TRACE_LIGHT_MIN_RADIUS au moins.
+     */
+    float getLightRadius() const;
+
+    /**
+     * @brief Renvoie la boîte englobante de toutes les instances.
+     */
+    void getBounds(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const;
+
+    /**
+     * @brief Renvoie le nombre de géométries uniques (maillages, carreaux et tubes).
+     */
+    unsigned int getGeometryCount() const;
+
+private:
+    std::vector<TraceInstance> m_instances; // Dans l'ordre des feuilles de m_instanceTree
+    unsigned int m_acceleration;
+    WideBVH m_instanceTree;
+    BVHBuildStats m_instanceStats;
+    UniformGrid m_instanceGrid;
+    std::vector<std::shared_ptr<const MeshBVH>> m_meshes;
+    std::vector<std::shared_ptr<const BezierPatch>> m_patches;
+    std::vector<std::shared_ptr<const BezierTube>> m_curves;
+    unsigned int m_geometryVersion;
+    glm::vec3 m_backgroundColor;
+    bool m_shadows;
+    unsigned int m_bounces;
+    unsigned int m_samples;
+    Sampler m_sampler;
+    unsigned int m_integrator;
+    unsigned int m_primary;
+    const Object* m_light;
+    glm::vec3 m_lightPosition;
+    glm::vec3 m_lightColor;
+    float m_lightRadius;
+    unsigned int m_photonCount;
+    PhotonMap m_caustics;
+    bool m_causticsValid; // Carte à jour de la position des objets et de la lumière
+    unsigned int m_causticsVersion;
+
+    /**
+     * @brief Renvoie true si l'instance désigne toujours la géométrie actuelle de son objet.
+     */
+    bool sameGeometry(const TraceInstance &instance) const;
+
+    /**
+     * @brief Renvoie les boîtes des instances, à leur position actuelle.
+     */
+    std::vector<BVHPrimitive> instanceBounds(const std::vector<TraceInstance> &instances) const;
+
+    /**
+     * @brief Cherche le point de l'instance le plus proche touché avant hit.t et met à jour hit
+     * (sauf hit.instance).
+     * @param anyHit se contenter d'un point touché avant hit.t, pas forcément le plus proche.
+     */
+    bool intersectInstance(const TraceInstance &instance, const TraceRay &ray, TraceHit &hit,
+        bool anyHit = false) const;
+
+    /**
+     * @brief Comme intersect(), en traversant l'objet lumière (TRACE_PHOTON_LIGHT_CROSSINGS
+     * surfaces au plus). hit.t reste compté le long de ray.
+     */
+    bool intersectSurfaces(const TraceRay &ray, TraceHit &hit) const;
+
+    /**
+     * @brief Cherche la sphère émettrice le long du rayon, vue de l'extérieur.
+     * @param t reçoit la distance de la sphère.
+     */
+    bool hitLight(const TraceRay &ray, float &t) const;
+
+    /**
+     * @brief Densité (par angle solide) de sampleLight() vu de point, 0 à l'intérieur de la sphère.
+     */
+    float lightPdf(const glm::vec3 &point) const;
+
+    /**
+     * @brief Tire une direction uniforme dans le cône de la sphère émettrice vu de point.
+     * @param distance reçoit la distance de la sphère dans cette direction.
+     * @return false si point est à l'intérieur de la sphère.
+     */
+    bool sampleLight(const glm::vec3 &point, const glm::vec2 &u, glm::vec3 &direction, float &distance,
+        float &pdf) const;
+
+    /**
+     * @brief Suit un photon parti de la lumière et ajoute à photons ceux qu'il dépose.
+     */
+    void tracePhoton(const TraceRay &ray, glm::vec3 power, std::vector<Photon> &photons) const;
+};
+
+#endif // TRACE_SCENE_HPP
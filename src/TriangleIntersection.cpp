@@ -0,0 +1,183 @@
+#include "TriangleIntersection.hpp"
+
+#include <cmath>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+WatertightRay TriangleIntersection::prepare(const glm::vec3 &origin, const glm::vec3 &direction)
+{
+    WatertightRay ray;
+    ray.origin = origin;
+
+    // Axe dominant de la direction, les deux autres suivent en gardant l'orientation du repère
+    glm::vec3 absDir = glm::abs(direction);
+    ray.kz = (absDir.x > absDir.y) ? ((absDir.x > absDir.z) ? 0 : 2) : ((absDir.y > absDir.z) ? 1 : 2);
+    ray.kx = (ray.kz + 1) % 3;
+    ray.ky = (ray.kx + 1) % 3;
+    if(direction[ray.kz] < 0.0f) std::swap(ray.kx, ray.ky);
+
+    ray.Sx = direction[ray.kx] / direction[ray.kz];
+    ray.Sy = direction[ray.ky] / direction[ray.kz];
+    ray.Sz = 1.0f / direction[ray.kz];
+
+    return ray;
+}
+
+
+bool TriangleIntersection::intersect(const WatertightRay &ray, const Triangle &triangle, float tMin,
+    float &t, float &u, float &v)
+{
+    const glm::vec3 A = triangle.a - ray.origin;
+    const glm::vec3 B = triangle.b - ray.origin;
+    const glm::vec3 C = triangle.c - ray.origin;
+
+    // Sommets dans le repère du rayon (cisaillement)
+    const float Ax = A[ray.kx] - ray.Sx * A[ray.kz];
+    const float Ay = A[ray.ky] - ray.Sy * A[ray.kz];
+    const float Bx = B[ray.kx] - ray.Sx * B[ray.kz];
+    const float By = B[ray.ky] - ray.Sy * B[ray.kz];
+    const float Cx = C[ray.kx] - ray.Sx * C[ray.kz];
+    const float Cy = C[ray.ky] - ray.Sy * C[ray.kz];
+
+    // Coordonnées barycentriques non normalisées (aires signées)
+    float U = Cx * By - Cy * Bx;
+    float V = Ax * Cy - Ay * Cx;
+    float W = Bx * Ay - By * Ax;
+
+    // Rayon exactement sur une arête : on refait le calcul en double pour trancher sans erreur
+    if(U == 0.0f || V == 0.0f || W == 0.0f) {
+        U = (float)((double)Cx * (double)By - (double)Cy * (double)Bx);
+        V = (float)((double)Ax * (double)Cy - (double)Ay * (double)Cx);
+        W = (float)((double)Bx * (double)Ay - (double)By * (double)Ax);
+    }
+
+    if((U < 0.0f || V < 0.0f || W < 0.0f) && (U > 0.0f || V > 0.0f || W > 0.0f)) return false;
+
+    const float det = U + V + W;
+    if(det == 0.0f) return false;
+
+    const float Az = ray.Sz * A[ray.kz];
+    const float Bz = ray.Sz * B[ray.kz];
+    const float Cz = ray.Sz * C[ray.kz];
+    const float T = U * Az + V * Bz + W * Cz;
+
+    // Distance comparée sans division, au signe de det près (les deux faces sont touchées)
+    if(det > 0.0f ? (T <= tMin * det || T >= t * det) : (T >= tMin * det || T <= t * det)) return false;
+
+    const float invDet = 1.0f / det;
+    t = T * invDet;
+    u = V * invDet;
+    v = W * invDet;
+    return true;
+}
+
+
+int TriangleIntersection::intersectPacket(const WatertightRay &ray, const TrianglePacket &packet,
+    float tMin, float &t, float &u, float &v)
+{
+    int hitLane = -1;
+
+#if defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 Sx = _mm_set1_ps(ray.Sx);
+    const __m128 Sy = _mm_set1_ps(ray.Sy);
+    const __m128 Sz = _mm_set1_ps(ray.Sz);
+    const __m128 ox = _mm_set1_ps(ray.origin[ray.kx]);
+    const __m128 oy = _mm_set1_ps(ray.origin[ray.ky]);
+    const __m128 oz = _mm_set1_ps(ray.origin[ray.kz]);
+
+    // Sommets dans le repère du rayon : x et y cisaillés, z mis à l'échelle plus bas
+    __m128 px[3], py[3], pz[3];
+    for(int i = 0; i < 3; ++i) {
+        pz[i] = _mm_sub_ps(_mm_load_ps(packet.v[i][ray.kz]), oz);
+        px[i] = _mm_sub_ps(_mm_sub_ps(_mm_load_ps(packet.v[i][ray.kx]), ox), _mm_mul_ps(Sx, pz[i]));
+        py[i] = _mm_sub_ps(_mm_sub_ps(_mm_load_ps(packet.v[i][ray.ky]), oy), _mm_mul_ps(Sy, pz[i]));
+    }
+
+    __m128 U = _mm_sub_ps(_mm_mul_ps(px[2], py[1]), _mm_mul_ps(py[2], px[1]));
+    __m128 V = _mm_sub_ps(_mm_mul_ps(px[0], py[2]), _mm_mul_ps(py[0], px[2]));
+    __m128 W = _mm_sub_ps(_mm_mul_ps(px[1], py[0]), _mm_mul_ps(py[1], px[0]));
+
+    // Un rayon sur une arête demande le calcul en double : rare, on passe par la référence
+    __m128 onEdge = _mm_or_ps(_mm_cmpeq_ps(U, zero), _mm_or_ps(_mm_cmpeq_ps(V, zero), _mm_cmpeq_ps(W, zero)));
+    if(_mm_movemask_ps(onEdge) != 0) {
+        for(int lane = 0; lane < TRIANGLE_PACKET_SIZE; ++lane) {
+            if(intersect(ray, getPacketTriangle(packet, lane), tMin, t, u, v)) hitLane = lane;
+        }
+        return hitLane;
+    }
+
+    __m128 negative = _mm_or_ps(_mm_cmplt_ps(U, zero), _mm_or_ps(_mm_cmplt_ps(V, zero), _mm_cmplt_ps(W, zero)));
+    __m128 positive = _mm_or_ps(_mm_cmpgt_ps(U, zero), _mm_or_ps(_mm_cmpgt_ps(V, zero), _mm_cmpgt_ps(W, zero)));
+    __m128 inside = _mm_xor_ps(_mm_and_ps(negative, positive), _mm_castsi128_ps(_mm_set1_epi32(-1)));
+
+    // Opérations dans le même ordre que la référence pour des résultats identiques au bit près
+    __m128 det = _mm_add_ps(_mm_add_ps(U, V), W);
+    __m128 T = _mm_add_ps(_mm_add_ps(_mm_mul_ps(U, _mm_mul_ps(Sz, pz[0])), _mm_mul_ps(V, _mm_mul_ps(Sz, pz[1]))),
+        _mm_mul_ps(W, _mm_mul_ps(Sz, pz[2])));
+
+    // Même comparaison que la référence : T et det ramenés au signe de det
+    __m128 detSign = _mm_and_ps(det, signBit);
+    __m128 absDet = _mm_xor_ps(det, detSign);
+    __m128 signedT = _mm_xor_ps(T, detSign);
+    __m128 valid = _mm_and_ps(inside, _mm_cmpneq_ps(det, zero));
+    valid = _mm_and_ps(valid, _mm_cmpgt_ps(signedT, _mm_mul_ps(_mm_set1_ps(tMin), absDet)));
+    valid = _mm_and_ps(valid, _mm_cmplt_ps(signedT, _mm_mul_ps(_mm_set1_ps(t), absDet)));
+
+    int mask = _mm_movemask_ps(valid);
+    if(mask == 0) return -1;
+
+    alignas(16) float laneT[4], laneDet[4], laneV[4], laneW[4];
+    _mm_store_ps(laneT, T);
+    _mm_store_ps(laneDet, det);
+    _mm_store_ps(laneV, V);
+    _mm_store_ps(laneW, W);
+
+    for(int lane = 0; lane < TRIANGLE_PACKET_SIZE; ++lane) {
+        if(!(mask & (1 << lane))) continue;
+        float invDet = 1.0f / laneDet[lane];
+        float d = laneT[lane] * invDet;
+        if(d < t) {
+            t = d;
+            u = laneV[lane] * invDet;
+            v = laneW[lane] * invDet;
+            hitLane = lane;
+        }
+    }
+#else
+    for(int lane = 0; lane < TRIANGLE_PACKET_SIZE; ++lane) {
+        if(intersect(ray, getPacketTriangle(packet, lane), tMin, t, u, v)) hitLane = lane;
+    }
+#endif
+
+    return hitLane;
+}
+
+
+void TriangleIntersection::setPacketTriangle(TrianglePacket &packet, unsigned int lane,
+    const Triangle &triangle, unsigned int index)
+{
+    for(int axis = 0; axis < 3; ++axis) {
+        packet.v[0][axis][lane] = triangle.a[axis];
+        packet.v[1][axis][lane] = triangle.b[axis];
+        packet.v[2][axis][lane] = triangle.c[axis];
+    }
+    packet.triangles[lane] = index;
+}
+
+
+Triangle TriangleIntersection::getPacketTriangle(const TrianglePacket &packet, unsigned int lane)
+{
+    Triangle triangle;
+    for(int axis = 0; axis < 3; ++axis) {
+        triangle.a[axis] = packet.v[0][axis][lane];
+        triangle.b[axis] = packet.v[1][axis][lane];
+        triangle.c[axis] = packet.v[2][axis][lane];
+    }
+    return triangle;
+}
@@ -0,0 +1,90 @@
+#ifndef TRIANGLE_INTERSECTION_HPP
+#define TRIANGLE_INTERSECTION_HPP
+
+/**
+ * @file TriangleIntersection.hpp
+ * @brief Définition de la classe TriangleIntersection.
+ * 
+ * Ce fichier contient le test d'intersection rayon / triangle "étanche" (S. Woop, C. Benthin et
+ * I. Wald, "Watertight Ray/Triangle Intersection", JCGT 2013) : un rayon qui passe sur l'arête
+ * commune de deux triangles touche toujours au moins l'un des deux, il ne peut pas "passer entre".
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <glm/glm.hpp>
+
+#include "Object.hpp"
+
+#define TRIANGLE_PACKET_SIZE 4 // Triangles testés à la fois (largeur d'un registre SSE)
+
+
+/**
+ * @brief Rayon préparé pour le test étanche : l'axe dominant de la direction devient l'axe z et la
+ * direction est ramenée à (0, 0, 1) par un cisaillement. Calculé une fois par rayon.
+ */
+typedef struct s_WatertightRay {
+    glm::vec3 origin;
+    int kx, ky, kz;
+    float Sx, Sy, Sz;
+} WatertightRay;
+
+
+/**
+ * @brief TRIANGLE_PACKET_SIZE triangles rangés par composante (SoA) : v[sommet][axe][triangle].
+ * Les emplacements inutilisés répètent le dernier triangle.
+ */
+typedef struct alignas(16) s_TrianglePacket {
+    float v[3][3][TRIANGLE_PACKET_SIZE];
+    unsigned int triangles[TRIANGLE_PACKET_SIZE]; // Indice de chaque triangle dans le maillage
+} TrianglePacket;
+
+
+/**
+ * @class TriangleIntersection
+ * @brief Tests d'intersection rayon / triangle étanches, un triangle ou un paquet à la fois.
+ * 
+ * Les deux versions donnent le même résultat : la version par paquet calcule les coordonnées
+ * barycentriques de tous les triangles en SSE2 et se replie sur la version de référence lorsqu'un
+ * rayon passe exactement sur une arête (cas où le calcul est refait en double précision).
+ */
+class TriangleIntersection
+{
+public:
+
+    /**
+     * @brief Prépare un rayon (direction non nécessairement normée) pour les tests suivants.
+     */
+    static WatertightRay prepare(const glm::vec3 &origin, const glm::vec3 &direction);
+
+    /**
+     * @brief Version de référence, un seul triangle.
+     * @param tMin distance minimale acceptée.
+     * @param t en entrée, distance maximale ; en sortie, distance du point touché.
+     * @param u, v coordonnées barycentriques du point touché (poids de b et de c).
+     * @return true si le triangle est touché entre tMin et t.
+     */
+    static bool intersect(const WatertightRay &ray, const Triangle &triangle, float tMin, float &t,
+        float &u, float &v);
+
+    /**
+     * @brief Teste TRIANGLE_PACKET_SIZE triangles à la fois et garde le plus proche.
+     * @return l'emplacement du triangle touché dans le paquet, -1 si aucun ne l'est avant t.
+     */
+    static int intersectPacket(const WatertightRay &ray, const TrianglePacket &packet, float tMin,
+        float &t, float &u, float &v);
+
+    /**
+     * @brief Range un triangle à l'emplacement lane du paquet.
+     */
+    static void setPacketTriangle(TrianglePacket &packet, unsigned int lane, const Triangle &triangle,
+        unsigned int index);
+
+    /**
+     * @brief Relit le triangle rangé à l'emplacement lane du paquet.
+     */
+    static Triangle getPacketTriangle(const TrianglePacket &packet, unsigned int lane);
+};
+
+#endif // TRIANGLE_INTERSECTION_HPP
@@ -0,0 +1,139 @@
+#include "UniformGrid.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+
+/**
+ * @brief Appelle func(first, last) sur des tranches de GRID_CHUNK_SIZE primitives, en parallèle.
+ */
+template <typename Function>
+static void forEachChunk(size_t count, Function func)
+{
+    TaskGroup group;
+    for(size_t first = 0; first < count; first += GRID_CHUNK_SIZE) {
+        size_t last = std::min(first + GRID_CHUNK_SIZE, count);
+        group.run([=]() {func(first, last);});
+    }
+}
+
+
+UniformGrid::UniformGrid() :
+    m_resolution(1),
+    m_cellSize(1.0f),
+    m_counterSize(0)
+{
+    m_bounds.boundsMin = m_bounds.boundsMax = glm::vec3(0.0f);
+    m_bounds.first = m_bounds.count = 0;
+}
+
+
+void UniformGrid::cellRange(const BVHPrimitive &primitive, glm::ivec3 &first, glm::ivec3 &last) const
+{
+    for(int axis = 0; axis < 3; ++axis) {
+        int lo = (int)std::floor((primitive.boundsMin[axis] - m_bounds.boundsMin[axis]) / m_cellSize[axis]);
+        int hi = (int)std::floor((primitive.boundsMax[axis] - m_bounds.boundsMin[axis]) / m_cellSize[axis]);
+        first[axis] = std::min(std::max(lo, 0), m_resolution[axis] - 1);
+        last[axis] = std::min(std::max(hi, 0), m_resolution[axis] - 1);
+    }
+}
+
+
+GridBuildStats UniformGrid::build(const std::vector<BVHPrimitive> &primitives)
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t count = primitives.size();
+    m_references.clear();
+    if(count == 0) return {0.0, 0, 0, 0};
+
+    // Boîte de la scène, réduite par tranche
+    size_t chunks = (count + GRID_CHUNK_SIZE - 1) / GRID_CHUNK_SIZE;
+    std::vector<BVHNode> partial(chunks);
+    forEachChunk(count, [&](size_t first, size_t last) {
+        BVHNode &bounds = partial[first / GRID_CHUNK_SIZE];
+        bounds.boundsMin = primitives[first].boundsMin;
+        bounds.boundsMax = primitives[first].boundsMax;
+        for(size_t i = first + 1; i < last; ++i) {
+            bounds.boundsMin = glm::min(bounds.boundsMin, primitives[i].boundsMin);
+            bounds.boundsMax = glm::max(bounds.boundsMax, primitives[i].boundsMax);
+        }
+    });
+    m_bounds = partial[0];
+    for(size_t c = 1; c < chunks; ++c) {
+        m_bounds.boundsMin = glm::min(m_bounds.boundsMin, partial[c].boundsMin);
+        m_bounds.boundsMax = glm::max(m_bounds.boundsMax, partial[c].boundsMax);
+    }
+
+    // Cellules à peu près cubiques, environ GRID_DENSITY par primitive (une scène plate garde une
+    // épaisseur minimale pour que le volume ne soit pas nul)
+    glm::vec3 extent = m_bounds.boundsMax - m_bounds.boundsMin;
+    float minExtent = 0.001f * std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-6f));
+    extent = glm::max(extent, glm::vec3(minExtent));
+    m_bounds.boundsMax = m_bounds.boundsMin + extent;
+
+    float cellSide = std::cbrt(extent.x * extent.y * extent.z / (GRID_DENSITY * count));
+    for(int axis = 0; axis < 3; ++axis) {
+        m_resolution[axis] = std::min(std::max((int)std::ceil(extent[axis] / cellSide), 1), GRID_MAX_RESOLUTION);
+        m_cellSize[axis] = extent[axis] / m_resolution[axis];
+    }
+
+    size_t cells = (size_t)m_resolution.x * m_resolution.y * m_resolution.z;
+    if(m_counterSize < cells) {
+        m_counters.reset(new std::atomic<unsigned int>[cells]);
+        m_counterSize = cells;
+    }
+    for(size_t c = 0; c < cells; ++c) m_counters[c].store(0, std::memory_order_relaxed);
+
+    // Nombre de primitives par cellule
+    forEachChunk(count, [&](size_t first, size_t last) {
+        glm::ivec3 lo, hi;
+        for(size_t i = first; i < last; ++i) {
+            cellRange(primitives[i], lo, hi);
+            for(int z = lo.z; z <= hi.z; ++z)
+                for(int y = lo.y; y <= hi.y; ++y)
+                    for(int x = lo.x; x <= hi.x; ++x)
+                        m_counters[x + m_resolution.x * (y + m_resolution.y * z)].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    // Somme préfixe : début de chaque cellule, les compteurs deviennent des curseurs d'écriture
+    m_cellStart.resize(cells + 1);
+    unsigned int total = 0;
+    for(size_t c = 0; c < cells; ++c) {
+        m_cellStart[c] = total;
+        total += m_counters[c].load(std::memory_order_relaxed);
+        m_counters[c].store(m_cellStart[c], std::memory_order_relaxed);
+    }
+    m_cellStart[cells] = total;
+    m_references.resize(total);
+
+    forEachChunk(count, [&](size_t first, size_t last) {
+        glm::ivec3 lo, hi;
+        for(size_t i = first; i < last; ++i) {
+            cellRange(primitives[i], lo, hi);
+            for(int z = lo.z; z <= hi.z; ++z)
+                for(int y = lo.y; y <= hi.y; ++y)
+                    for(int x = lo.x; x <= hi.x; ++x) {
+                        unsigned int cell = x + m_resolution.x * (y + m_resolution.y * z);
+                        m_references[m_counters[cell].fetch_add(1, std::memory_order_relaxed)] = i;
+                    }
+        }
+    });
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return {ms, (unsigned int)count, (unsigned int)cells, total};
+}
+
+
+bool UniformGrid::empty() const {return m_references.empty();}
+
+
+void UniformGrid::printStats(const std::string &name, const GridBuildStats &stats)
+{
+    double rate = (stats.milliseconds > 0.0) ? stats.primitives / (stats.milliseconds * 1000.0) : 0.0;
+    std::cout << "Grille " << name << " : " << stats.primitives << " primitives, " << stats.cells
+        << " cellules, " << stats.references << " références, " << stats.milliseconds << " ms ("
+        << rate << " M primitives/s)" << std::endl;
+}
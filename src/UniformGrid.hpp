@@ -0,0 +1,193 @@
+#ifndef UNIFORM_GRID_HPP
+#define UNIFORM_GRID_HPP
+
+/**
+ * @file UniformGrid.hpp
+ * @brief Définition de la classe UniformGrid.
+ *
+ * Ce fichier contient une grille régulière de cellules, structure d'accélération alternative aux
+ * hiérarchies englobantes : moins efficace à parcourir, mais reconstruite en temps linéaire, ce qui
+ * la rend préférable pour les scènes dont les objets bougent à chaque image.
+ *
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "BVHBuilder.hpp"
+
+#define GRID_DENSITY 2.0f        // Cellules par primitive
+#define GRID_MAX_RESOLUTION 256  // Cellules par axe au maximum
+#define GRID_CHUNK_SIZE 16384    // Primitives traitées par tâche pendant la construction
+
+
+/**
+ * @brief Bilan d'une construction.
+ */
+typedef struct s_GridBuildStats {
+    double milliseconds;
+    unsigned int primitives;
+    unsigned int cells;
+    unsigned int references; // Total des primitives rangées dans les cellules
+} GridBuildStats;
+
+
+/**
+ * @class UniformGrid
+ * @brief Grille régulière de cellules, chacune listant les primitives dont la boîte la touche.
+ *
+ * La construction est un tri par comptage : les primitives comptent en parallèle les cellules
+ * qu'elles touchent, une somme préfixe donne le début de chaque cellule, puis les primitives
+ * s'y inscrivent en parallèle. La résolution est choisie pour avoir environ GRID_DENSITY cellules
+ * par primitive.
+ *
+ * Le parcours suit le rayon cellule par cellule (3D-DDA, Amanatides et Woo) et s'arrête à la
+ * première cellule dont la sortie est au-delà du point le plus proche trouvé. Une primitive à
+ * cheval sur plusieurs cellules peut être testée plusieurs fois, ce qui ne change pas le résultat.
+ */
+class UniformGrid
+{
+public:
+
+    UniformGrid();
+
+    /**
+     * @brief (Re)construit la grille, en réutilisant la mémoire de la construction précédente.
+     * @param primitives boîtes englobantes des primitives.
+     * @return le bilan de la construction.
+     */
+    GridBuildStats build(const std::vector<BVHPrimitive> &primitives);
+
+    /**
+     * @brief Parcourt les cellules traversées par le rayon et appelle primitive(index, t) pour
+     * chaque primitive qu'elles contiennent. primitive doit réduire t lorsqu'elle est touchée plus
+     * près et renvoyer true dans ce cas.
+     * @return true si au moins un appel à primitive a renvoyé true.
+     */
+    template <typename PrimitiveFunction>
+    bool traverse(const glm::vec3 &origin, const glm::vec3 &direction, float &t,
+        PrimitiveFunction primitive) const;
+
+    /**
+     * @brief Comme traverse(), mais s'arrête dès qu'un appel à primitive(index, tMax) renvoie true
+     * (primitive touchée avant tMax, pas forcément la plus proche) : tests d'occultation.
+     * @return true si un appel à primitive a renvoyé true.
+     */
+    template <typename PrimitiveFunction>
+    bool traverseAny(const glm::vec3 &origin, const glm::vec3 &direction, float tMax,
+        PrimitiveFunction primitive) const;
+
+    bool empty() const;
+
+    /**
+     * @brief Affiche le bilan d'une construction dans le terminal.
+     */
+    static void printStats(const std::string &name, const GridBuildStats &stats);
+
+private:
+    BVHNode m_bounds;       // Boîte de la grille (seuls boundsMin et boundsMax sont utilisés)
+    glm::ivec3 m_resolution;
+    glm::vec3 m_cellSize;
+    std::vector<unsigned int> m_cellStart;  // Début de chaque cellule dans m_references
+    std::vector<unsigned int> m_references; // Primitives des cellules, cellule après cellule
+    std::unique_ptr<std::atomic<unsigned int>[]> m_counters; // Comptes puis curseurs d'écriture
+    size_t m_counterSize;
+
+    void cellRange(const BVHPrimitive &primitive, glm::ivec3 &first, glm::ivec3 &last) const;
+
+    /**
+     * @brief Suit le rayon cellule par cellule (3D-DDA) et appelle cell(first, last) avec les
+     * références de chaque cellule, jusqu'à ce que cell renvoie true ou que la cellule suivante
+     * commence au-delà de t (t peut être réduit par cell pendant le parcours).
+     * @return true si cell a renvoyé true.
+     */
+    template <typename CellFunction>
+    bool walk(const glm::vec3 &origin, const glm::vec3 &direction, const float &t, CellFunction cell) const;
+};
+
+
+template <typename CellFunction>
+bool UniformGrid::walk(const glm::vec3 &origin, const glm::vec3 &direction, const float &t,
+    CellFunction cell) const
+{
+    if(m_references.empty()) return false;
+
+    glm::vec3 invDir = 1.0f / direction;
+    float enter = intersectBounds(m_bounds, origin, invDir, t);
+    if(enter == std::numeric_limits<float>::infinity()) return false;
+
+    // Cellule d'entrée, pas et distances jusqu'aux prochaines faces de cellule sur chaque axe
+    glm::vec3 entry = origin + enter * direction;
+    glm::ivec3 current, step;
+    glm::vec3 tNext, tDelta;
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        int c = (int)std::floor((entry[axis] - m_bounds.boundsMin[axis]) / m_cellSize[axis]);
+        current[axis] = std::min(std::max(c, 0), m_resolution[axis] - 1);
+
+        if(direction[axis] > 0.0f) {
+            step[axis] = 1;
+            tNext[axis] = (m_bounds.boundsMin[axis] + (current[axis] + 1) * m_cellSize[axis] - origin[axis]) * invDir[axis];
+            tDelta[axis] = m_cellSize[axis] * invDir[axis];
+        }
+        else if(direction[axis] < 0.0f) {
+            step[axis] = -1;
+            tNext[axis] = (m_bounds.boundsMin[axis] + current[axis] * m_cellSize[axis] - origin[axis]) * invDir[axis];
+            tDelta[axis] = -m_cellSize[axis] * invDir[axis];
+        }
+        else {
+            step[axis] = 0;
+            tNext[axis] = std::numeric_limits<float>::infinity();
+            tDelta[axis] = std::numeric_limits<float>::infinity();
+        }
+    }
+
+    while(true)
+    {
+        unsigned int index = current.x + m_resolution.x * (current.y + m_resolution.y * current.z);
+        if(cell(m_cellStart[index], m_cellStart[index + 1])) return true;
+
+        // Un point touché avant la sortie de la cellule ne peut plus être battu par les suivantes
+        int axis = (tNext.x < tNext.y) ? ((tNext.x < tNext.z) ? 0 : 2) : ((tNext.y < tNext.z) ? 1 : 2);
+        if(t <= tNext[axis]) return false;
+
+        current[axis] += step[axis];
+        if(current[axis] < 0 || current[axis] >= m_resolution[axis]) return false;
+        tNext[axis] += tDelta[axis];
+    }
+}
+
+
+template <typename PrimitiveFunction>
+bool UniformGrid::traverse(const glm::vec3 &origin, const glm::vec3 &direction, float &t,
+    PrimitiveFunction primitive) const
+{
+    bool hit = false;
+    walk(origin, direction, t, [&](unsigned int first, unsigned int last) {
+        for(unsigned int i = first; i < last; ++i)
+            if(primitive(m_references[i], t)) hit = true;
+        return false;
+    });
+    return hit;
+}
+
+
+template <typename PrimitiveFunction>
+bool UniformGrid::traverseAny(const glm::vec3 &origin, const glm::vec3 &direction, float tMax,
+    PrimitiveFunction primitive) const
+{
+    return walk(origin, direction, tMax, [&](unsigned int first, unsigned int last) {
+        for(unsigned int i = first; i < last; ++i)
+            if(primitive(m_references[i], tMax)) return true;
+        return false;
+    });
+}
+
+#endif // UNIFORM_GRID_HPP
@@ -0,0 +1,395 @@
+#include "WavefrontTracer.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+
+template <typename Function>
+void WavefrontTracer::forEachRay(size_t count, Function func)
+{
+    size_t chunks = (count + WAVEFRONT_CHUNK_SIZE - 1) / WAVEFRONT_CHUNK_SIZE;
+    parallelFor(0, chunks, [&](size_t chunk) {
+        size_t last = std::min(count, (chunk + 1) * WAVEFRONT_CHUNK_SIZE);
+        for(size_t i = chunk * WAVEFRONT_CHUNK_SIZE; i < last; ++i) func(i);
+    });
+}
+
+
+WavefrontTracer::WavefrontTracer(const TraceScene &scene, bool sortRays) :
+    m_scene(scene),
+    m_sortRays(sortRays),
+    m_stats()
+{
+    // Cellules d'origine des rayons : la boîte de la scène découpée en 2^WAVEFRONT_CELL_BITS par axe
+    glm::vec3 boundsMax;
+    m_scene.getBounds(m_boundsMin, boundsMax);
+    glm::vec3 extent = glm::max(boundsMax - m_boundsMin, glm::vec3(1e-6f));
+    m_cellScale = glm::vec3((float)(1u << WAVEFRONT_CELL_BITS)) / extent;
+}
+
+
+void WavefrontTracer::renderRows(const TraceCamera &camera, unsigned int firstRow, unsigned int rowCount,
+    float* radiance)
+{
+    unsigned int width = camera.getWidth();
+    if(m_scene.getIntegrator() != TRACE_INTEGRATOR_MIRROR) {
+        renderPaths(camera, firstRow, rowCount, radiance);
+        return;
+    }
+
+    unsigned int waveRows = std::max(1u, WAVEFRONT_QUEUE_SIZE / std::max(width, 1u));
+    std::fill(radiance, radiance + 3 * (size_t)width * rowCount, 0.0f);
+
+    for(unsigned int row = 0; row < rowCount; row += waveRows)
+    {
+        unsigned int rows = std::min(waveRows, rowCount - row);
+        float* waveRadiance = radiance + 3 * (size_t)width * row;
+
+        auto start = std::chrono::steady_clock::now();
+        auto lap = [&](unsigned int stage) {
+            auto now = std::chrono::steady_clock::now();
+            m_stats.milliseconds[stage] += std::chrono::duration<double, std::milli>(now - start).count();
+            start = now;
+        };
+
+        // Les échantillons d'un pixel passent l'un après l'autre, chacun avec son poids dans le pixel
+        for(unsigned int sample = 0; sample < m_scene.getSamples(); ++sample)
+        {
+            generate(camera, firstRow + row, rows, sample);
+            lap(WAVEFRONT_STAGE_GENERATE);
+
+            for(unsigned int bounce = 0; bounce <= m_scene.getBounces() && !m_rays.pixel.empty(); ++bounce)
+            {
+                m_stats.rays += m_rays.pixel.size();
+
+                // Les rayons primaires d'une vague sont déjà cohérents, pas les rayons réfléchis
+                if(m_sortRays && bounce > 0) sort();
+                lap(WAVEFRONT_STAGE_SORT);
+                extend();
+                lap(WAVEFRONT_STAGE_EXTEND);
+                shade(bounce, waveRadiance);
+                compact();
+                lap(WAVEFRONT_STAGE_SHADE);
+                connect(waveRadiance);
+                lap(WAVEFRONT_STAGE_CONNECT);
+            }
+        }
+    }
+}
+
+
+void WavefrontTracer::renderPaths(const TraceCamera &camera, unsigned int firstRow, unsigned int rowCount,
+    float* radiance)
+{
+    unsigned int width = camera.getWidth();
+    size_t count = (size_t)width * rowCount;
+    auto start = std::chrono::steady_clock::now();
+
+    forEachRay(count, [&](size_t i) {
+        unsigned int x = i % width;
+        unsigned int y = firstRow + i / width;
+        glm::vec3 color(0.0f);
+        for(unsigned int sample = 0; sample < m_scene.getSamples(); ++sample)
+            color += m_scene.traceSample(camera, x, y, sample);
+        color /= (float)m_scene.getSamples();
+
+        radiance[3 * i] = color.x;
+        radiance[3 * i + 1] = color.y;
+        radiance[3 * i + 2] = color.z;
+    });
+
+    m_stats.rays += count * m_scene.getSamples();
+    m_stats.milliseconds[WAVEFRONT_STAGE_SHADE] +=
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+const WavefrontStats& WavefrontTracer::getStats() const {return m_stats;}
+
+
+void WavefrontTracer::printStats(const std::string &name, const WavefrontStats &stats)
+{
+    static const char* stages[WAVEFRONT_STAGE_COUNT] = {"generate", "tri", "extend", "shade", "connect"};
+    double total = 0.0;
+    for(double ms : stats.milliseconds) total += ms;
+
+    std::cout << "Vagues " << name << " : " << stats.rays << " rayons, " << stats.shadowRays
+        << " rayons d'ombre, " << total << " ms (";
+    for(unsigned int stage = 0; stage < WAVEFRONT_STAGE_COUNT; ++stage)
+        std::cout << (stage ? ", " : "") << stages[stage] << " " << stats.milliseconds[stage];
+    std::cout << ")" << std::endl;
+}
+
+
+void WavefrontTracer::generate(const TraceCamera &camera, unsigned int firstRow, unsigned int rowCount,
+    unsigned int sample)
+{
+    unsigned int width = camera.getWidth();
+    float weight = 1.0f / m_scene.getSamples();
+    resize(m_rays, (size_t)width * rowCount);
+
+    forEachRay(m_rays.pixel.size(), [&](size_t i) {
+        unsigned int x = i % width;
+        unsigned int y = firstRow + i / width;
+        setRay(m_rays, i, m_scene.cameraRay(camera, x, y, sample), i, weight);
+    });
+}
+
+
+unsigned int WavefrontTracer::sortKey(const RayQueue &queue, size_t index) const
+{
+    unsigned int octant = (queue.directionX[index] < 0.0f) | ((queue.directionY[index] < 0.0f) << 1)
+        | ((queue.directionZ[index] < 0.0f) << 2);
+
+    // Cellule d'origine, coordonnées entrelacées (ordre de Morton)
+    const float origin[3] = {queue.originX[index], queue.originY[index], queue.originZ[index]};
+    unsigned int cell = 0;
+    for(unsigned int axis = 0; axis < 3; ++axis) {
+        float position = (origin[axis] - m_boundsMin[axis]) * m_cellScale[axis];
+        unsigned int c = (unsigned int)std::min(std::max(position, 0.0f), (float)((1u << WAVEFRONT_CELL_BITS) - 1));
+        for(unsigned int bit = 0; bit < WAVEFRONT_CELL_BITS; ++bit)
+            cell |= ((c >> bit) & 1u) << (3 * bit + axis);
+    }
+
+    return (octant << (3 * WAVEFRONT_CELL_BITS)) | cell;
+}
+
+
+void WavefrontTracer::sort()
+{
+    size_t count = m_rays.pixel.size();
+    m_keys.resize(count);
+    forEachRay(count, [&](size_t i) {m_keys[i] = sortKey(m_rays, i);});
+
+    // Tri par comptage, une tâche par tranche de WAVEFRONT_SORT_SLICE rayons : taille de chaque
+    // intervalle dans chaque tranche, début de chaque intervalle dans chaque tranche, puis rangement
+    size_t slices = (count + WAVEFRONT_SORT_SLICE - 1) / WAVEFRONT_SORT_SLICE;
+    m_sliceStart.assign(slices * WAVEFRONT_SORT_BINS, 0);
+    parallelFor(0, slices, [&](size_t slice) {
+        unsigned int* sizes = m_sliceStart.data() + slice * WAVEFRONT_SORT_BINS;
+        size_t last = std::min(count, (slice + 1) * WAVEFRONT_SORT_SLICE);
+        for(size_t i = slice * WAVEFRONT_SORT_SLICE; i < last; ++i) sizes[m_keys[i]]++;
+    });
+
+    // Les intervalles sont répartis par blocs de WAVEFRONT_CHUNK_SIZE : taille totale de chacun, somme
+    // préfixe sur les intervalles, puis début de l'intervalle dans chaque tranche
+    auto forEachBin = [&](auto func) {
+        parallelFor(0, (WAVEFRONT_SORT_BINS + WAVEFRONT_CHUNK_SIZE - 1) / WAVEFRONT_CHUNK_SIZE, [&](size_t block) {
+            size_t last = std::min<size_t>(WAVEFRONT_SORT_BINS, (block + 1) * WAVEFRONT_CHUNK_SIZE);
+            for(size_t bin = block * WAVEFRONT_CHUNK_SIZE; bin < last; ++bin) func(bin);
+        });
+    };
+
+    m_binStart.resize(WAVEFRONT_SORT_BINS);
+    forEachBin([&](size_t bin) {
+        unsigned int size = 0;
+        for(size_t slice = 0; slice < slices; ++slice) size += m_sliceStart[slice * WAVEFRONT_SORT_BINS + bin];
+        m_binStart[bin] = size;
+    });
+    unsigned int start = 0;
+    for(unsigned int &binStart : m_binStart) {
+        unsigned int size = binStart;
+        binStart = start;
+        start += size;
+    }
+    forEachBin([&](size_t bin) {
+        unsigned int start = m_binStart[bin];
+        for(size_t slice = 0; slice < slices; ++slice) {
+            unsigned int &sliceStart = m_sliceStart[slice * WAVEFRONT_SORT_BINS + bin];
+            unsigned int size = sliceStart;
+            sliceStart = start;
+            start += size;
+        }
+    });
+
+    resize(m_sorted, count);
+    parallelFor(0, slices, [&](size_t slice) {
+        unsigned int* next = m_sliceStart.data() + slice * WAVEFRONT_SORT_BINS;
+        size_t last = std::min(count, (slice + 1) * WAVEFRONT_SORT_SLICE);
+        for(size_t i = slice * WAVEFRONT_SORT_SLICE; i < last; ++i) copyRay(m_rays, i, m_sorted, next[m_keys[i]]++);
+    });
+    std::swap(m_rays, m_sorted);
+}
+
+
+void WavefrontTracer::extend()
+{
+    m_hits.resize(m_rays.pixel.size());
+    forEachRay(m_rays.pixel.size(), [&](size_t i) {
+        m_hits[i] = TraceScene::emptyHit();
+        if(!m_scene.intersect(getRay(m_rays, i), m_hits[i])) m_hits[i].instance = TRACE_MISS;
+    });
+}
+
+
+void WavefrontTracer::shade(unsigned int bounce, float* radiance)
+{
+    size_t count = m_rays.pixel.size();
+    resize(m_shadows, count);
+    resize(m_nextRays, count);
+    bool lastBounce = (bounce == m_scene.getBounces());
+
+    // Chaque pixel n'a qu'un rayon par vague : les threads n'écrivent jamais dans le même pixel
+    forEachRay(count, [&](size_t i) {
+        TraceRay ray = getRay(m_rays, i);
+        const TraceHit &hit = m_hits[i];
+        float throughput = m_rays.throughput[i];
+        float* pixel = radiance + 3 * (size_t)m_rays.pixel[i];
+        m_shadows.distance[i] = 0.0f;
+        m_nextRays.throughput[i] = 0.0f;
+
+        if(hit.instance == TRACE_MISS) {
+            glm::vec3 color = throughput * m_scene.getBackgroundColor();
+            pixel[0] += color.x;
+            pixel[1] += color.y;
+            pixel[2] += color.z;
+            return;
+        }
+
+        // Même répartition que TraceScene::traceColor(), caustiques comprises
+        float weight = lastBounce ? throughput : throughput * (1.0f - TRACE_REFLECTANCE);
+        glm::vec3 irradiance;
+        if(m_scene.caustics(ray, hit, irradiance)) {
+            glm::vec3 caustic = weight * m_scene.getInstance(hit.instance).color * irradiance;
+            pixel[0] += caustic.x;
+            pixel[1] += caustic.y;
+            pixel[2] += caustic.z;
+        }
+
+        glm::vec3 color = weight * m_scene.getInstance(hit.instance).color;
+
+        TraceRay shadow;
+        float distance;
+        if(m_scene.shadowRay(ray, hit, shadow, distance)) {
+            m_shadows.originX[i] = shadow.origin.x;
+            m_shadows.originY[i] = shadow.origin.y;
+            m_shadows.originZ[i] = shadow.origin.z;
+            m_shadows.directionX[i] = shadow.direction.x;
+            m_shadows.directionY[i] = shadow.direction.y;
+            m_shadows.directionZ[i] = shadow.direction.z;
+            m_shadows.distance[i] = distance;
+            m_shadows.colorR[i] = color.x;
+            m_shadows.colorG[i] = color.y;
+            m_shadows.colorB[i] = color.z;
+            m_shadows.pixel[i] = m_rays.pixel[i];
+        }
+        else {
+            pixel[0] += color.x;
+            pixel[1] += color.y;
+            pixel[2] += color.z;
+        }
+
+        if(!lastBounce) setRay(m_nextRays, i, m_scene.reflect(ray, hit), m_rays.pixel[i], throughput * TRACE_REFLECTANCE);
+    });
+}
+
+
+void WavefrontTracer::connect(float* radiance)
+{
+    glm::vec3 shadowFactor = m_scene.getShadowFactor();
+    m_stats.shadowRays += std::count_if(m_shadows.distance.begin(), m_shadows.distance.end(),
+        [](float distance) {return distance > 0.0f;});
+
+    forEachRay(m_shadows.distance.size(), [&](size_t i) {
+        if(m_shadows.distance[i] <= 0.0f) return;
+
+        TraceRay shadow = {glm::vec3(m_shadows.originX[i], m_shadows.originY[i], m_shadows.originZ[i]),
+            glm::vec3(m_shadows.directionX[i], m_shadows.directionY[i], m_shadows.directionZ[i])};
+        glm::vec3 color(m_shadows.colorR[i], m_shadows.colorG[i], m_shadows.colorB[i]);
+        if(m_scene.occluded(shadow, m_shadows.distance[i])) color *= shadowFactor;
+
+        float* pixel = radiance + 3 * (size_t)m_shadows.pixel[i];
+        pixel[0] += color.x;
+        pixel[1] += color.y;
+        pixel[2] += color.z;
+    });
+}
+
+
+void WavefrontTracer::compact()
+{
+    // Rayons vivants de chaque tranche, premier emplacement de chaque tranche, puis recopie
+    size_t count = m_nextRays.pixel.size();
+    size_t chunks = (count + WAVEFRONT_CHUNK_SIZE - 1) / WAVEFRONT_CHUNK_SIZE;
+    m_chunkStart.assign(chunks + 1, 0);
+    parallelFor(0, chunks, [&](size_t chunk) {
+        size_t last = std::min(count, (chunk + 1) * WAVEFRONT_CHUNK_SIZE);
+        for(size_t i = chunk * WAVEFRONT_CHUNK_SIZE; i < last; ++i)
+            if(m_nextRays.throughput[i] > 0.0f) m_chunkStart[chunk + 1]++;
+    });
+    for(size_t chunk = 0; chunk < chunks; ++chunk) m_chunkStart[chunk + 1] += m_chunkStart[chunk];
+
+    // m_rays n'est plus lue après shade() : elle reçoit les rayons vivants
+    resize(m_rays, m_chunkStart[chunks]);
+    parallelFor(0, chunks, [&](size_t chunk) {
+        size_t next = m_chunkStart[chunk];
+        size_t last = std::min(count, (chunk + 1) * WAVEFRONT_CHUNK_SIZE);
+        for(size_t i = chunk * WAVEFRONT_CHUNK_SIZE; i < last; ++i)
+            if(m_nextRays.throughput[i] > 0.0f) copyRay(m_nextRays, i, m_rays, next++);
+    });
+}
+
+
+void WavefrontTracer::resize(RayQueue &queue, size_t size)
+{
+    queue.originX.resize(size);
+    queue.originY.resize(size);
+    queue.originZ.resize(size);
+    queue.directionX.resize(size);
+    queue.directionY.resize(size);
+    queue.directionZ.resize(size);
+    queue.pixel.resize(size);
+    queue.throughput.resize(size);
+}
+
+
+void WavefrontTracer::resize(ShadowQueue &queue, size_t size)
+{
+    queue.originX.resize(size);
+    queue.originY.resize(size);
+    queue.originZ.resize(size);
+    queue.directionX.resize(size);
+    queue.directionY.resize(size);
+    queue.directionZ.resize(size);
+    queue.distance.resize(size);
+    queue.colorR.resize(size);
+    queue.colorG.resize(size);
+    queue.colorB.resize(size);
+    queue.pixel.resize(size);
+}
+
+
+TraceRay WavefrontTracer::getRay(const RayQueue &queue, size_t index)
+{
+    return {glm::vec3(queue.originX[index], queue.originY[index], queue.originZ[index]),
+        glm::vec3(queue.directionX[index], queue.directionY[index], queue.directionZ[index])};
+}
+
+
+void WavefrontTracer::setRay(RayQueue &queue, size_t index, const TraceRay &ray, unsigned int pixel,
+    float throughput)
+{
+    queue.originX[index] = ray.origin.x;
+    queue.originY[index] = ray.origin.y;
+    queue.originZ[index] = ray.origin.z;
+    queue.directionX[index] = ray.direction.x;
+    queue.directionY[index] = ray.direction.y;
+    queue.directionZ[index] = ray.direction.z;
+    queue.pixel[index] = pixel;
+    queue.throughput[index] = throughput;
+}
+
+
+void WavefrontTracer::copyRay(const RayQueue &from, size_t fromIndex, RayQueue &to, size_t toIndex)
+{
+    to.originX[toIndex] = from.originX[fromIndex];
+    to.originY[toIndex] = from.originY[fromIndex];
+    to.originZ[toIndex] = from.originZ[fromIndex];
+    to.directionX[toIndex] = from.directionX[fromIndex];
+    to.directionY[toIndex] = from.directionY[fromIndex];
+    to.directionZ[toIndex] = from.directionZ[fromIndex];
+    to.pixel[toIndex] = from.pixel[fromIndex];
+    to.throughput[toIndex] = from.throughput[fromIndex];
+}
@@ -0,0 +1,162 @@
+#ifndef WAVEFRONT_TRACER_HPP
+#define WAVEFRONT_TRACER_HPP
+
+/**
+ * @file WavefrontTracer.hpp
+ * @brief Définition de la classe WavefrontTracer.
+ *
+ * Ce fichier contient le lancer de rayons "par vagues" des captures : au lieu de suivre chaque
+ * rayon de rebond en rebond, tous les rayons d'une vague passent ensemble par chaque étape, dans
+ * de grandes files rangées par composante.
+ *
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "TraceScene.hpp"
+
+#define WAVEFRONT_QUEUE_SIZE 262144 // Rayons par vague au plus
+#define WAVEFRONT_CHUNK_SIZE 4096   // Rayons traités par tâche
+#define WAVEFRONT_CELL_BITS 4       // Bits par axe de la cellule d'origine dans la clé de tri
+#define WAVEFRONT_SORT_BINS (8u << (3 * WAVEFRONT_CELL_BITS)) // Octant de la direction x cellule
+#define WAVEFRONT_SORT_SLICE 32768  // Rayons par tâche du tri, chacune avec son histogramme complet
+
+#define WAVEFRONT_STAGE_GENERATE 0
+#define WAVEFRONT_STAGE_SORT 1
+#define WAVEFRONT_STAGE_EXTEND 2
+#define WAVEFRONT_STAGE_SHADE 3
+#define WAVEFRONT_STAGE_CONNECT 4
+#define WAVEFRONT_STAGE_COUNT 5
+
+
+/**
+ * @brief File de rayons, rangée par composante (SoA).
+ */
+typedef struct s_RayQueue {
+    std::vector<float> originX, originY, originZ;
+    std::vector<float> directionX, directionY, directionZ;
+    std::vector<unsigned int> pixel; // Pixel dont le rayon porte la couleur
+    std::vector<float> throughput;   // Poids du rayon dans la couleur du pixel, 0 pour un rayon mort
+} RayQueue;
+
+/**
+ * @brief File de rayons d'ombre, avec la couleur qu'ils apportent à leur pixel.
+ */
+typedef struct s_ShadowQueue {
+    std::vector<float> originX, originY, originZ;
+    std::vector<float> directionX, directionY, directionZ;
+    std::vector<float> distance;     // Distance de la lumière, 0 pour un emplacement inutilisé
+    std::vector<float> colorR, colorG, colorB;
+    std::vector<unsigned int> pixel;
+} ShadowQueue;
+
+/**
+ * @brief Bilan des images calculées par un WavefrontTracer.
+ */
+typedef struct s_WavefrontStats {
+    double milliseconds[WAVEFRONT_STAGE_COUNT]; // Temps passé dans chaque étape (WAVEFRONT_STAGE_*)
+    size_t rays;       // Rayons primaires et réfléchis
+    size_t shadowRays;
+} WavefrontStats;
+
+
+/**
+ * @class WavefrontTracer
+ * @brief Calcule des lignes d'image avec le même résultat que TraceScene::traceColor(), par vagues.
+ *
+ * Chaque vague passe par quatre étapes, chacune parallèle sur toute la file (tri et compactage
+ * compris) :
+ * - generate : rayons primaires des pixels de la vague ;
+ * - extend : intersection la plus proche de chaque rayon (TraceScene::intersect()) ;
+ * - shade : couleur des points touchés, rayon d'ombre et rayon réfléchi de chacun ;
+ * - connect : test d'occultation des rayons d'ombre (TraceScene::occluded()).
+ *
+ * Les rayons réfléchis partent dans toutes les directions : avant chaque extend, la file est
+ * triée (tri par comptage) par octant de direction puis par cellule d'origine dans la scène, pour
+ * que des rayons voisins en mémoire parcourent les mêmes noeuds. Chaque tranche de
+ * WAVEFRONT_SORT_SLICE rayons compte et range ses rayons sur son thread ; le tri reste stable, donc
+ * l'image ne dépend pas du nombre de threads.
+ *
+ * Les chemins aléatoires des intégrateurs TRACE_INTEGRATOR_PATH_* ne passent pas par les vagues :
+ * chaque pixel est calculé d'un bout à l'autre par TraceScene::traceSample() (cf. renderPaths()).
+ */
+class WavefrontTracer
+{
+public:
+
+    /**
+     * @brief Constructeur.
+     * @param sortRays trier les rayons réfléchis avant chaque extend.
+     */
+    WavefrontTracer(const TraceScene &scene, bool sortRays = true);
+
+    /**
+     * @brief Calcule rowCount lignes de l'image à partir de la ligne firstRow et écrit leur
+     * radiance linéaire (RGB flottant) dans radiance (cf. Intersection::rayRenderRows()).
+     */
+    void renderRows(const TraceCamera &camera, unsigned int firstRow, unsigned int rowCount, float* radiance);
+
+    /**
+     * @brief Renvoie le bilan cumulé de tous les appels à renderRows().
+     */
+    const WavefrontStats& getStats() const;
+
+    /**
+     * @brief Affiche un bilan dans le terminal.
+     */
+    static void printStats(const std::string &name, const WavefrontStats &stats);
+
+private:
+    const TraceScene &m_scene;
+    bool m_sortRays;
+    glm::vec3 m_boundsMin;
+    glm::vec3 m_cellScale; // Cellules d'origine par unité de longueur, sur chaque axe
+
+    RayQueue m_rays;
+    RayQueue m_nextRays;
+    RayQueue m_sorted;
+    ShadowQueue m_shadows;
+    std::vector<TraceHit> m_hits;
+    std::vector<unsigned int> m_keys;
+    std::vector<unsigned int> m_binStart;   // Début de chaque intervalle du tri
+    std::vector<unsigned int> m_sliceStart; // Début de chaque intervalle dans chaque tranche du tri
+    std::vector<size_t> m_chunkStart;       // Premier emplacement de chaque tranche du compactage
+    WavefrontStats m_stats;
+
+    /**
+     * @brief renderRows() pour les intégrateurs TRACE_INTEGRATOR_PATH_*, pixel par pixel.
+     */
+    void renderPaths(const TraceCamera &camera, unsigned int firstRow, unsigned int rowCount, float* radiance);
+
+    void generate(const TraceCamera &camera, unsigned int firstRow, unsigned int rowCount, unsigned int sample);
+    void sort();
+    void extend();
+    void shade(unsigned int bounce, float* radiance);
+    void connect(float* radiance);
+
+    /**
+     * @brief Recopie dans m_rays les rayons vivants de m_nextRays, dans le même ordre.
+     */
+    void compact();
+
+    unsigned int sortKey(const RayQueue &queue, size_t index) const;
+
+    static void resize(RayQueue &queue, size_t size);
+    static void resize(ShadowQueue &queue, size_t size);
+    static TraceRay getRay(const RayQueue &queue, size_t index);
+    static void setRay(RayQueue &queue, size_t index, const TraceRay &ray, unsigned int pixel, float throughput);
+    static void copyRay(const RayQueue &from, size_t fromIndex, RayQueue &to, size_t toIndex);
+
+    /**
+     * @brief Appelle func(i) pour chaque rayon de [0; count[, par tranches de WAVEFRONT_CHUNK_SIZE
+     * réparties sur les threads.
+     */
+    template <typename Function>
+    static void forEachRay(size_t count, Function func);
+};
+
+#endif // WAVEFRONT_TRACER_HPP
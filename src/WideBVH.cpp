@@ -0,0 +1,145 @@
+#include "WideBVH.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+/**
+ * @brief Demi-aire d'une boîte, pour choisir le noeud binaire à ouvrir.
+ */
+static float halfArea(const BVHNode &node)
+{
+    glm::vec3 extent = node.boundsMax - node.boundsMin;
+    return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+
+WideBVH::WideBVH() {}
+
+
+WideBVH::WideBVH(const std::vector<BVHNode> &binaryNodes)
+{
+    if(binaryNodes.empty()) return;
+
+    m_nodes.reserve(binaryNodes.size() / 2 + 1);
+
+    if(binaryNodes[0].count > 0) {
+        // Racine feuille : un seul noeud dont le premier fils est cette feuille
+        WideBVHNode root;
+        for(unsigned int i = 0; i < WIDE_BVH_WIDTH; ++i) {
+            root.minX[i] = root.minY[i] = root.minZ[i] = std::numeric_limits<float>::infinity();
+            root.maxX[i] = root.maxY[i] = root.maxZ[i] = -std::numeric_limits<float>::infinity();
+            root.child[i] = 0;
+            root.count[i] = WIDE_BVH_EMPTY;
+        }
+        const BVHNode &leaf = binaryNodes[0];
+        root.minX[0] = leaf.boundsMin.x; root.minY[0] = leaf.boundsMin.y; root.minZ[0] = leaf.boundsMin.z;
+        root.maxX[0] = leaf.boundsMax.x; root.maxY[0] = leaf.boundsMax.y; root.maxZ[0] = leaf.boundsMax.z;
+        root.child[0] = leaf.first;
+        root.count[0] = leaf.count;
+        m_nodes.push_back(root);
+        return;
+    }
+
+    collapse(binaryNodes, 0);
+}
+
+
+unsigned int WideBVH::collapse(const std::vector<BVHNode> &binaryNodes, unsigned int binaryIndex)
+{
+    // Fils du noeud binaire, puis ouverture du plus grand noeud interne tant qu'il reste de la place
+    unsigned int children[WIDE_BVH_WIDTH];
+    unsigned int childCount = 2;
+    children[0] = binaryNodes[binaryIndex].first;
+    children[1] = binaryNodes[binaryIndex].first + 1;
+
+    while(childCount < WIDE_BVH_WIDTH)
+    {
+        int largest = -1;
+        float largestArea = -1.0f;
+        for(unsigned int i = 0; i < childCount; ++i) {
+            const BVHNode &node = binaryNodes[children[i]];
+            if(node.count == 0 && halfArea(node) > largestArea) {
+                largest = i;
+                largestArea = halfArea(node);
+            }
+        }
+        if(largest < 0) break;
+
+        unsigned int opened = children[largest];
+        children[largest] = binaryNodes[opened].first;
+        children[childCount++] = binaryNodes[opened].first + 1;
+    }
+
+    unsigned int index = m_nodes.size();
+    m_nodes.push_back(WideBVHNode());
+
+    WideBVHNode node;
+    for(unsigned int i = 0; i < WIDE_BVH_WIDTH; ++i)
+    {
+        if(i >= childCount) {
+            node.minX[i] = node.minY[i] = node.minZ[i] = std::numeric_limits<float>::infinity();
+            node.maxX[i] = node.maxY[i] = node.maxZ[i] = -std::numeric_limits<float>::infinity();
+            node.child[i] = 0;
+            node.count[i] = WIDE_BVH_EMPTY;
+            continue;
+        }
+
+        const BVHNode &binary = binaryNodes[children[i]];
+        node.minX[i] = binary.boundsMin.x; node.minY[i] = binary.boundsMin.y; node.minZ[i] = binary.boundsMin.z;
+        node.maxX[i] = binary.boundsMax.x; node.maxY[i] = binary.boundsMax.y; node.maxZ[i] = binary.boundsMax.z;
+        node.count[i] = binary.count;
+        node.child[i] = (binary.count > 0) ? binary.first : collapse(binaryNodes, children[i]);
+    }
+
+    m_nodes[index] = node;
+    return index;
+}
+
+
+unsigned int WideBVH::intersectChildren(const WideBVHNode &node, const glm::vec3 &origin,
+    const glm::vec3 &invDir, float tMax, float distances[WIDE_BVH_WIDTH])
+{
+#if defined(__SSE2__)
+    // Même calcul que intersectBounds(), pour les quatre fils à la fois
+    __m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y), oz = _mm_set1_ps(origin.z);
+    __m128 ix = _mm_set1_ps(invDir.x), iy = _mm_set1_ps(invDir.y), iz = _mm_set1_ps(invDir.z);
+
+    __m128 t0x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minX), ox), ix);
+    __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxX), ox), ix);
+    __m128 t0y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minY), oy), iy);
+    __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxY), oy), iy);
+    __m128 t0z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minZ), oz), iz);
+    __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxZ), oz), iz);
+
+    __m128 enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)),
+        _mm_max_ps(_mm_min_ps(t0z, t1z), _mm_setzero_ps()));
+    __m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)),
+        _mm_min_ps(_mm_max_ps(t0z, t1z), _mm_set1_ps(tMax)));
+
+    // Les emplacements inutilisés sont écartés par leur count, pas par leur boîte
+    __m128i empty = _mm_cmpeq_epi32(_mm_load_si128((const __m128i*)node.count),
+        _mm_set1_epi32((int)WIDE_BVH_EMPTY));
+    __m128 hit = _mm_andnot_ps(_mm_castsi128_ps(empty), _mm_cmple_ps(enter, exit));
+
+    _mm_storeu_ps(distances, enter);
+    return (unsigned int)_mm_movemask_ps(hit);
+#else
+    unsigned int mask = 0;
+    for(unsigned int i = 0; i < WIDE_BVH_WIDTH; ++i) {
+        if(node.count[i] == WIDE_BVH_EMPTY) continue;
+
+        BVHNode box;
+        box.boundsMin = glm::vec3(node.minX[i], node.minY[i], node.minZ[i]);
+        box.boundsMax = glm::vec3(node.maxX[i], node.maxY[i], node.maxZ[i]);
+        distances[i] = intersectBounds(box, origin, invDir, tMax);
+        if(distances[i] != std::numeric_limits<float>::infinity()) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+
+bool WideBVH::empty() const {return m_nodes.empty();}
+const std::vector<WideBVHNode>& WideBVH::getNodes() const {return m_nodes;}
@@ -0,0 +1,245 @@
+#ifndef WIDE_BVH_HPP
+#define WIDE_BVH_HPP
+
+/**
+ * @file WideBVH.hpp
+ * @brief Définition de la classe WideBVH.
+ *
+ * Ce fichier contient la version "large" des hiérarchies englobantes : chaque noeud a jusqu'à
+ * quatre fils dont les boîtes sont testées ensemble en SSE2, ce qui divise à peu près par deux la
+ * profondeur de l'arbre et le nombre de noeuds chargés par rayon.
+ *
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <limits>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "BVHBuilder.hpp"
+
+#define WIDE_BVH_WIDTH 4          // Fils par noeud (largeur d'un registre SSE)
+#define WIDE_BVH_STACK_SIZE 128   // Profondeur maximale du parcours (jusqu'à 3 fils mis de côté par niveau)
+#define WIDE_BVH_EMPTY 0xFFFFFFFFu // count d'un emplacement de fils inutilisé
+
+// Le repliement ne rend pas l'arbre plus profond que la hiérarchie binaire (cf. BVHBuilder)
+static_assert(WIDE_BVH_STACK_SIZE >= (WIDE_BVH_WIDTH - 1) * BVH_MAX_DEPTH + 1,
+    "WIDE_BVH_STACK_SIZE trop petit pour BVH_MAX_DEPTH");
+
+
+/**
+ * @brief Noeud à quatre fils (128 octets alignés, soit deux lignes de cache).
+ *
+ * Les boîtes des fils sont rangées par composante (SoA) pour être chargées directement dans des
+ * registres SSE. Pour chaque fils i : si count[i] vaut 0, child[i] est l'indice d'un noeud ; sinon
+ * le fils est une feuille de count[i] primitives à partir de child[i]. Les emplacements inutilisés
+ * ont count[i] = WIDE_BVH_EMPTY.
+ */
+typedef struct alignas(64) s_WideBVHNode {
+    float minX[WIDE_BVH_WIDTH];
+    float minY[WIDE_BVH_WIDTH];
+    float minZ[WIDE_BVH_WIDTH];
+    float maxX[WIDE_BVH_WIDTH];
+    float maxY[WIDE_BVH_WIDTH];
+    float maxZ[WIDE_BVH_WIDTH];
+    unsigned int child[WIDE_BVH_WIDTH];
+    unsigned int count[WIDE_BVH_WIDTH];
+} WideBVHNode;
+
+
+/**
+ * @class WideBVH
+ * @brief Hiérarchie à quatre fils obtenue en "repliant" une hiérarchie binaire.
+ *
+ * Chaque noeud reprend les fils de son noeud binaire en ouvrant à chaque fois le petit-fils de plus
+ * grande aire, jusqu'à en avoir quatre. Les feuilles et l'ordre des primitives sont ceux de la
+ * hiérarchie binaire d'origine.
+ *
+ * Le parcours est ordonné : les fils touchés sont triés par distance d'entrée, le plus proche est
+ * visité tout de suite et les autres sont mis de côté avec leur distance, ce qui permet d'ignorer
+ * ceux qui sont derrière la primitive la plus proche trouvée entre temps.
+ */
+class WideBVH
+{
+public:
+
+    WideBVH();
+
+    /**
+     * @brief Construit la hiérarchie à partir d'une hiérarchie binaire (cf. BVHBuilder).
+     */
+    WideBVH(const std::vector<BVHNode> &binaryNodes);
+
+    /**
+     * @brief Teste les quatre boîtes d'un noeud.
+     * @param invDir inverse composante par composante de la direction du rayon.
+     * @param tMax distance maximale.
+     * @param distances distance d'entrée dans chaque boîte touchée.
+     * @return masque des fils touchés (bit i pour le fils i).
+     */
+    static unsigned int intersectChildren(const WideBVHNode &node, const glm::vec3 &origin,
+        const glm::vec3 &invDir, float tMax, float distances[WIDE_BVH_WIDTH]);
+
+    /**
+     * @brief Parcourt la hiérarchie et appelle leaf(first, count, t) pour chaque feuille touchée
+     * avant t, dans l'ordre des distances. leaf doit réduire t lorsqu'il trouve une primitive plus
+     * proche et renvoyer true dans ce cas.
+     * @return true si au moins un appel à leaf a renvoyé true.
+     */
+    template <typename LeafFunction>
+    bool traverse(const glm::vec3 &origin, const glm::vec3 &direction, float &t, LeafFunction leaf) const;
+
+    /**
+     * @brief Parcours sans ordre pour les tests d'occultation : appelle leaf(first, count, tMax)
+     * pour les feuilles touchées avant tMax et s'arrête dès qu'un appel renvoie true (une primitive
+     * touchée avant tMax, pas forcément la plus proche).
+     * @return true si un appel à leaf a renvoyé true.
+     */
+    template <typename LeafFunction>
+    bool traverseAny(const glm::vec3 &origin, const glm::vec3 &direction, float tMax, LeafFunction leaf) const;
+
+    /**
+     * @brief Recalcule les boîtes de tous les noeuds sans changer leur structure (primitives
+     * déplacées). leafBounds(first, count, boundsMin, boundsMax) doit renvoyer la boîte de la feuille.
+     */
+    template <typename LeafBounds>
+    void refit(LeafBounds leafBounds);
+
+    bool empty() const;
+    const std::vector<WideBVHNode>& getNodes() const;
+
+private:
+    std::vector<WideBVHNode> m_nodes;
+
+    unsigned int collapse(const std::vector<BVHNode> &binaryNodes, unsigned int binaryIndex);
+};
+
+
+template <typename LeafFunction>
+bool WideBVH::traverse(const glm::vec3 &origin, const glm::vec3 &direction, float &t,
+    LeafFunction leaf) const
+{
+    if(m_nodes.empty()) return false;
+
+    glm::vec3 invDir = 1.0f / direction;
+    bool hit = false;
+
+    // Fils mis de côté : noeud ou feuille (child, count) et distance d'entrée
+    unsigned int stackChild[WIDE_BVH_STACK_SIZE];
+    unsigned int stackCount[WIDE_BVH_STACK_SIZE];
+    float stackDistance[WIDE_BVH_STACK_SIZE];
+    unsigned int stackSize = 0;
+
+    stackChild[0] = 0;
+    stackCount[0] = 0;
+    stackDistance[0] = 0.0f;
+    stackSize = 1;
+
+    while(stackSize > 0)
+    {
+        --stackSize;
+        if(stackDistance[stackSize] > t) continue;
+
+        unsigned int child = stackChild[stackSize];
+        unsigned int count = stackCount[stackSize];
+
+        // Descend tant que le fils le plus proche est un noeud
+        while(count == 0)
+        {
+            const WideBVHNode &node = m_nodes[child];
+            float distances[WIDE_BVH_WIDTH];
+            unsigned int mask = intersectChildren(node, origin, invDir, t, distances);
+            if(mask == 0) break;
+
+            // Tri par insertion des fils touchés, du plus lointain au plus proche
+            unsigned int sorted[WIDE_BVH_WIDTH];
+            unsigned int sortedSize = 0;
+            for(unsigned int i = 0; i < WIDE_BVH_WIDTH; ++i) {
+                if(!(mask & (1u << i))) continue;
+                unsigned int j = sortedSize++;
+                while(j > 0 && distances[sorted[j - 1]] < distances[i]) {
+                    sorted[j] = sorted[j - 1];
+                    --j;
+                }
+                sorted[j] = i;
+            }
+
+            for(unsigned int j = 0; j + 1 < sortedSize; ++j) {
+                stackChild[stackSize] = node.child[sorted[j]];
+                stackCount[stackSize] = node.count[sorted[j]];
+                stackDistance[stackSize++] = distances[sorted[j]];
+            }
+
+            child = node.child[sorted[sortedSize - 1]];
+            count = node.count[sorted[sortedSize - 1]];
+        }
+
+        if(count != 0 && leaf(child, count, t)) hit = true;
+    }
+
+    return hit;
+}
+
+
+template <typename LeafFunction>
+bool WideBVH::traverseAny(const glm::vec3 &origin, const glm::vec3 &direction, float tMax,
+    LeafFunction leaf) const
+{
+    if(m_nodes.empty()) return false;
+
+    glm::vec3 invDir = 1.0f / direction;
+
+    // Pas de tri : n'importe quelle primitive touchée suffit
+    unsigned int stack[WIDE_BVH_STACK_SIZE];
+    unsigned int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while(stackSize > 0)
+    {
+        const WideBVHNode &node = m_nodes[stack[--stackSize]];
+        float distances[WIDE_BVH_WIDTH];
+        unsigned int mask = intersectChildren(node, origin, invDir, tMax, distances);
+
+        for(unsigned int i = 0; i < WIDE_BVH_WIDTH; ++i) {
+            if(!(mask & (1u << i))) continue;
+            if(node.count[i] == 0) stack[stackSize++] = node.child[i];
+            else if(leaf(node.child[i], node.count[i], tMax)) return true;
+        }
+    }
+
+    return false;
+}
+
+
+template <typename LeafBounds>
+void WideBVH::refit(LeafBounds leafBounds)
+{
+    // Les noeuds fils sont toujours rangés après leur parent
+    for(size_t index = m_nodes.size(); index-- > 0;)
+    {
+        WideBVHNode &node = m_nodes[index];
+        for(unsigned int i = 0; i < WIDE_BVH_WIDTH; ++i)
+        {
+            if(node.count[i] == WIDE_BVH_EMPTY) continue;
+
+            glm::vec3 boundsMin(std::numeric_limits<float>::infinity());
+            glm::vec3 boundsMax(-std::numeric_limits<float>::infinity());
+
+            if(node.count[i] > 0) leafBounds(node.child[i], node.count[i], boundsMin, boundsMax);
+            else {
+                const WideBVHNode &child = m_nodes[node.child[i]];
+                for(unsigned int j = 0; j < WIDE_BVH_WIDTH; ++j) {
+                    if(child.count[j] == WIDE_BVH_EMPTY) continue;
+                    boundsMin = glm::min(boundsMin, glm::vec3(child.minX[j], child.minY[j], child.minZ[j]));
+                    boundsMax = glm::max(boundsMax, glm::vec3(child.maxX[j], child.maxY[j], child.maxZ[j]));
+                }
+            }
+
+            node.minX[i] = boundsMin.x; node.minY[i] = boundsMin.y; node.minZ[i] = boundsMin.z;
+            node.maxX[i] = boundsMax.x; node.maxY[i] = boundsMax.y; node.maxZ[i] = boundsMax.z;
+        }
+    }
+}
+
+#endif // WIDE_BVH_HPP
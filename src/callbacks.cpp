@@ -86,11 +86,69 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         glfwSetWindowShouldClose(window, true);
     }
 
-    // Capture screen with ray tracing
-    if (key == GLFW_KEY_P && action == GLFW_PRESS) {
+    // Capture screen with ray tracing (SHIFT : poster capture, streamed to disk)
+    if (key == GLFW_KEY_P && action == GLFW_PRESS && !(mods & GLFW_MOD_SHIFT)) {
         std::string captureName = "screen_capture.png";
         Intersection::raySavePNG(*context, captureName);
     }
+    if (key == GLFW_KEY_P && action == GLFW_PRESS && (mods & GLFW_MOD_SHIFT)) {
+        std::string captureName = "poster_capture.png";
+        Intersection::rayStreamPNG(*context, captureName, context->SCR_WIDTH * CAPTURE_POSTER_SCALE,
+            context->SCR_HEIGHT * CAPTURE_POSTER_SCALE);
+    }
+
+    // Capture screen with ray tracing as raw linear floats (for post-processing tools)
+    if (key == GLFW_KEY_R && action == GLFW_PRESS) {
+        std::string captureName = "screen_capture.raw";
+        Intersection::raySaveRaw(*context, captureName, context->SCR_WIDTH, context->SCR_HEIGHT);
+    }
+
+    // Switch between single ray and ray fans for mouse clicks
+    if (key == GLFW_KEY_F && action == GLFW_PRESS) {
+        static const char* modes[RAY_MODE_COUNT] = {"rayon seul", "eventail en cone", "eventail en grille"};
+        context->setRayMode((context->getRayMode() + 1) % RAY_MODE_COUNT);
+        std::cout << "Clic : " << modes[context->getRayMode()] << std::endl;
+    }
+
+    // Switch caustics (photon map) on and off for ray traced captures
+    if (key == GLFW_KEY_C && action == GLFW_PRESS) {
+        context->setTracePhotons(context->getTracePhotons() ? 0 : TRACE_CAUSTIC_PHOTONS);
+        std::cout << "Caustiques : " << (context->getTracePhotons() ? "actives" : "inactives") << std::endl;
+    }
+
+    // Cycle through the integrators of ray traced captures (mirrors, then random paths)
+    if (key == GLFW_KEY_I && action == GLFW_PRESS) {
+        static const char* integrators[TRACE_INTEGRATOR_COUNT] = {"miroirs", "chemins (rebonds seuls)",
+            "chemins (rayons d'ombre seuls)", "chemins (MIS)"};
+        context->setTraceIntegrator((context->getTraceIntegrator() + 1) % TRACE_INTEGRATOR_COUNT);
+
+        // Un seul chemin par pixel ne donne que du bruit
+        if(context->getTraceIntegrator() != TRACE_INTEGRATOR_MIRROR && context->getTraceSamples() < TRACE_PATH_SAMPLES)
+            context->setTraceSamples(TRACE_PATH_SAMPLES);
+        std::cout << "Integrateur : " << integrators[context->getTraceIntegrator()] << ", "
+            << context->getTraceSamples() << " echantillons par pixel" << std::endl;
+    }
+
+    // Cycle through the sample counts of ray traced captures (1, 4, 16, 64, then 1 again)
+    if (key == GLFW_KEY_E && action == GLFW_PRESS) {
+        unsigned int samples = context->getTraceSamples() * 4;
+        context->setTraceSamples(samples > TRACE_KEY_MAX_SAMPLES ? 1 : samples);
+        std::cout << "Echantillons par pixel : " << context->getTraceSamples() << std::endl;
+    }
+
+    // Cycle through the sequences placing the samples in the pixels of captures
+    if (key == GLFW_KEY_G && action == GLFW_PRESS) {
+        static const char* samplers[SAMPLER_COUNT] = {"hasard", "Sobol", "bruit bleu"};
+        context->setTraceSampler((context->getTraceSampler() + 1) % SAMPLER_COUNT);
+        std::cout << "Suite des echantillons : " << samplers[context->getTraceSampler()] << std::endl;
+    }
+
+    // Toggle rasterized primary visibility for the meshes of captures (hybrid rendering)
+    if (key == GLFW_KEY_H && action == GLFW_PRESS) {
+        bool raster = context->getTracePrimary() != TRACE_PRIMARY_RASTER;
+        context->setTracePrimary(raster ? TRACE_PRIMARY_RASTER : TRACE_PRIMARY_RAYS);
+        std::cout << "Points vus : " << (raster ? "rasterisation des maillages" : "rayons primaires") << std::endl;
+    }
 
     // Switch to next element in context
     if(key == GLFW_KEY_RIGHT && action == GLFW_PRESS) {
@@ -149,11 +207,25 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
         Ray original;
         Intersection::cameraRay(*context, mouseX, mouseY, original);
         
+        // Eventail : tous les chemins sont calculés ensemble sur la scène du lancer de rayons
+        if(context->getRayMode() != RAY_MODE_SINGLE) {
+            unsigned int shape = (context->getRayMode() == RAY_MODE_FAN_GRID) ? RAY_FAN_GRID : RAY_FAN_CONE;
+            std::vector<TraceRay> rays = Intersection::rayFan({original.getOrigin(), original.getDirection()}, shape);
+
+            RayPaths paths;
+            Intersection::rayScenePaths(*context->getTraceScene(), rays, MAX_RAY_BOUNCES, paths);
+            for(size_t i = 0; i < rays.size(); ++i) {
+                context->getRayBatch()->addPath(rays[i].origin, paths.points.data() + i * paths.maxBounces,
+                    paths.bounces[i], paths.exits[i]);
+            }
+            return;
+        }
+
         // Calcul d'intersections
         ptsTab intersections;
         glm::vec3 reflexion;
         Intersection::rayContextPath(*context, original, intersections, reflexion);
-        context->addObject(std::make_unique<Ray>(original.getOrigin(), original.getDirection(), intersections, reflexion));
+        context->getRayBatch()->addPath(original.getOrigin(), intersections.data(), intersections.size(), reflexion);
     }
 }
 
@@ -7,6 +7,8 @@
 #include "AppContext.hpp"
 #include "Intersections.hpp"
 
+#define CAPTURE_POSTER_SCALE 8 // Résolution des captures "poster" (SHIFT + P) par rapport à la fenêtre
+
 /**
  * @brief Frame-buffer size callback.
  * 
@@ -47,6 +49,15 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
  * - Flèche bas (comportement spécifique aux courbes de Bézier)
  * - Tab (bascule du mode "curseur" au mode "souris")
  * - M (comportement spécifique aux courbes de Bézier)
+ * - P (capture d'écran par lancer de rayons, SHIFT + P pour une capture "poster" en haute résolution)
+ * - R (capture d'écran brute en flottants, cf. MappedImage.hpp)
+ * - C (caustiques des captures par carte de photons, cf. TraceScene::updateCaustics())
+ * - H (points vus des captures : rayons primaires ou rastérisation des maillages, cf. GBuffer)
+ * - F (un clic lance un rayon, un éventail en cône ou un éventail en grille, cf. Intersection::rayFan())
+ * - I (intégrateur des captures : miroirs, puis chemins aléatoires avec au moins TRACE_PATH_SAMPLES
+ *   échantillons par pixel, cf. TRACE_INTEGRATOR_*)
+ * - E (échantillons par pixel des captures : 1, 4, 16 puis 64, cf. TRACE_KEY_MAX_SAMPLES)
+ * - G (suite des échantillons dans le pixel : hasard, Sobol ou bruit bleu, cf. Sampler.hpp)
  * @param window Fenêtre à laquelle on veut assigner le callback.
  * @param key Identifiant de la touche qui déclenche le callback.
  * @param scancode Scancode de la touche qui déclenche le callback.
@@ -39,6 +39,11 @@ Rename this file to lodepng.cpp to use it for C++, or to lodepng.c to use it for
 #include <stdlib.h> /* allocations */
 #endif /* LODEPNG_COMPILE_ALLOCATORS */
 
+#if defined(LODEPNG_COMPILE_CPP) && defined(LODEPNG_COMPILE_ENCODER)
+#include <thread> /* parallel deflate */
+#include <vector>
+#endif /* LODEPNG_COMPILE_CPP && LODEPNG_COMPILE_ENCODER */
+
 #if defined(_MSC_VER) && (_MSC_VER >= 1310) /*Visual Studio: A few warning types are not desired here.*/
 #pragma warning( disable : 4244 ) /*implicit conversions: not warned by gcc -Wall -Wextra and requires too much casts*/
 #pragma warning( disable : 4996 ) /*VS does not like fopen, but fopen_s is not standard C so unusable here*/
@@ -421,22 +426,30 @@ static void LodePNGBitWriter_init(LodePNGBitWriter* writer, ucvector* data) {
 static void writeBits(LodePNGBitWriter* writer, unsigned value, size_t nbits) {
   if(nbits == 1) { /* compiler should statically compile this case if nbits == 1 */
     WRITEBIT(writer, value);
-  } else {
-    /* TODO: increase output size only once here rather than in each WRITEBIT */
+  } else if(nbits != 0) {
+    /* grow the output once and or the value in whole bytes, rather than one WRITEBIT per bit (nbits <= 32) */
+    unsigned bitpos = writer->bp & 7u;
+    size_t pos = writer->data->size - (bitpos != 0); /*byte receiving the first bit*/
+    size_t end = pos + (bitpos + nbits + 7u) / 8u;
+    unsigned long long bits = (unsigned long long)value << bitpos;
     size_t i;
-    for(i = 0; i != nbits; ++i) {
-      WRITEBIT(writer, (unsigned char)((value >> i) & 1));
-    }
+    if(!ucvector_resize(writer->data, end)) return;
+    for(i = pos + (bitpos != 0); i != end; ++i) writer->data->data[i] = 0;
+    for(i = pos; i != end; ++i, bits >>= 8u) writer->data->data[i] |= (unsigned char)(bits & 255u);
+    writer->bp = (unsigned char)(writer->bp + nbits);
   }
 }
 
+static unsigned reverseBits(unsigned value, size_t nbits) {
+  size_t i;
+  unsigned reversed = 0;
+  for(i = 0; i != nbits; ++i) reversed |= ((value >> i) & 1u) << (nbits - 1u - i);
+  return reversed;
+}
+
 /* This one is to use for adding huffman symbol, the value bits are written MSB first */
 static void writeBitsReversed(LodePNGBitWriter* writer, unsigned value, size_t nbits) {
-  size_t i;
-  for(i = 0; i != nbits; ++i) {
-    /* TODO: increase output size only once here rather than in each WRITEBIT */
-    WRITEBIT(writer, (unsigned char)((value >> (nbits - 1u - i)) & 1u));
-  }
+  writeBits(writer, reverseBits(value, nbits), nbits);
 }
 #endif /*LODEPNG_COMPILE_ENCODER*/
 
@@ -1560,6 +1573,33 @@ static void updateHashChain(Hash* hash, size_t wpos, unsigned hashval, unsigned
   hash->headz[numzeros] = (int)wpos;
 }
 
+/*LZ77 restricted to the distance 1, that is run length encoding of repeated bytes (like zlib's Z_RLE).
+It needs no hash chains, so it is a lot faster than the full search of encodeLZ77.*/
+static unsigned encodeRLE(uivector* out, const unsigned char* in, size_t inpos, size_t insize, unsigned minmatch) {
+  size_t pos = inpos;
+  if(minmatch < 3) minmatch = 3;
+
+  while(pos < insize) {
+    size_t length = 0;
+    if(pos > 0) {
+      size_t maxlength = insize - pos;
+      unsigned char previous = in[pos - 1];
+      if(maxlength > MAX_SUPPORTED_DEFLATE_LENGTH) maxlength = MAX_SUPPORTED_DEFLATE_LENGTH;
+      while(length < maxlength && in[pos + length] == previous) ++length;
+    }
+
+    if(length >= minmatch) {
+      addLengthDistance(out, length, 1);
+      pos += length;
+    } else {
+      if(!uivector_push_back(out, in[pos])) return 83; /*alloc fail*/
+      ++pos;
+    }
+  }
+
+  return 0;
+}
+
 /*
 LZ77-encode the data. Return value is error code. The input are raw bytes, the output
 is in the form of unsigned integers with codes representing for example literal bytes, or
@@ -1593,6 +1633,7 @@ static unsigned encodeLZ77(uivector* out, Hash* hash,
 
   if(windowsize == 0 || windowsize > 32768) return 60; /*error: windowsize smaller/larger than allowed*/
   if((windowsize & (windowsize - 1)) != 0) return 90; /*error: must be power of two*/
+  if(windowsize == 1) return encodeRLE(out, in, inpos, insize, minmatch);
 
   if(nicematch > MAX_SUPPORTED_DEFLATE_LENGTH) nicematch = MAX_SUPPORTED_DEFLATE_LENGTH;
 
@@ -1720,18 +1761,19 @@ static unsigned encodeLZ77(uivector* out, Hash* hash,
 
 /* /////////////////////////////////////////////////////////////////////////// */
 
-static unsigned deflateNoCompression(ucvector* out, const unsigned char* data, size_t datasize) {
+static unsigned deflateNoCompression(ucvector* out, const unsigned char* data, size_t datasize, unsigned final) {
   /*non compressed deflate block data: 1 bit BFINAL,2 bits BTYPE,(5 bits): it jumps to start of next byte,
   2 bytes LEN, 2 bytes NLEN, LEN bytes literal DATA*/
 
   size_t i, numdeflateblocks = (datasize + 65534u) / 65535u;
   size_t datapos = 0;
+  if(numdeflateblocks == 0) numdeflateblocks = 1; /*empty input still needs one (empty) block*/
   for(i = 0; i != numdeflateblocks; ++i) {
     unsigned BFINAL, BTYPE, LEN, NLEN;
     unsigned char firstbyte;
     size_t pos = out->size;
 
-    BFINAL = (i == numdeflateblocks - 1);
+    BFINAL = final && (i == numdeflateblocks - 1);
     BTYPE = 0;
 
     LEN = 65535;
@@ -1761,9 +1803,12 @@ tree_d: the tree for distance codes.
 static void writeLZ77data(LodePNGBitWriter* writer, const uivector* lz77_encoded,
                           const HuffmanTree* tree_ll, const HuffmanTree* tree_d) {
   size_t i = 0;
+  /*huffman codes are written MSB first: reverse each code once rather than for every symbol*/
+  unsigned reversed_ll[288];
+  for(i = 0; i != tree_ll->numcodes; ++i) reversed_ll[i] = reverseBits(tree_ll->codes[i], tree_ll->lengths[i]);
   for(i = 0; i != lz77_encoded->size; ++i) {
     unsigned val = lz77_encoded->data[i];
-    writeBitsReversed(writer, tree_ll->codes[val], tree_ll->lengths[val]);
+    writeBits(writer, reversed_ll[val], tree_ll->lengths[val]);
     if(val > 256) /*for a length code, 3 more things have to be added*/ {
       unsigned length_index = val - FIRST_LENGTH_CODE_INDEX;
       unsigned n_length_extra_bits = LENGTHEXTRA[length_index];
@@ -2060,7 +2105,7 @@ static unsigned lodepng_deflatev(ucvector* out, const unsigned char* in, size_t
   LodePNGBitWriter_init(&writer, out);
 
   if(settings->btype > 2) return 61;
-  else if(settings->btype == 0) return deflateNoCompression(out, in, insize);
+  else if(settings->btype == 0) return deflateNoCompression(out, in, insize, 1);
   else if(settings->btype == 1) blocksize = insize;
   else /*if(settings->btype == 2)*/ {
     /*on PNGs, deflate blocks of 65-262k seem to give most dense encoding*/
@@ -2144,6 +2189,213 @@ static unsigned adler32(const unsigned char* data, unsigned len) {
   return update_adler32(1u, data, len);
 }
 
+#ifdef LODEPNG_COMPILE_ENCODER
+
+/*adler32 of the concatenation of two pieces, from the adler32 of each piece and the length of the second*/
+static unsigned adler32_combine(unsigned adler1, unsigned adler2, size_t len2) {
+  const unsigned long BASE = 65521u;
+  unsigned long rem = (unsigned long)(len2 % BASE);
+  unsigned long sum1 = adler1 & 0xffffu;
+  unsigned long sum2 = (rem * sum1) % BASE;
+  sum1 += (adler2 & 0xffffu) + BASE - 1u;
+  sum2 += ((adler1 >> 16u) & 0xffffu) + ((adler2 >> 16u) & 0xffffu) + BASE - rem;
+  if(sum1 >= BASE) sum1 -= BASE;
+  if(sum1 >= BASE) sum1 -= BASE;
+  if(sum2 >= (BASE << 1u)) sum2 -= (BASE << 1u);
+  if(sum2 >= BASE) sum2 -= BASE;
+  return (unsigned)(sum1 | (sum2 << 16u));
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* / Chunked and parallel deflate                                           / */
+/* ////////////////////////////////////////////////////////////////////////// */
+
+/*below this many input bytes per thread, the lost matches at piece boundaries and the thread
+startup cost more than what is gained*/
+#define PARALLEL_DEFLATE_MIN_PIECE 131072u
+
+/*fill the hash chains with the positions of in[dictstart..start), as encodeLZ77 would have, so the
+LZ77 matches of the piece starting at start can refer back to them*/
+static void primeHash(Hash* hash, const unsigned char* in, size_t dictstart, size_t start, size_t end,
+                      unsigned windowsize) {
+  size_t pos;
+  unsigned numzeros = 0;
+  for(pos = dictstart; pos < start; ++pos) {
+    size_t wpos = pos & (windowsize - 1);
+    unsigned hashval = getHash(in, end, pos);
+    if(hashval == 0) {
+      if(numzeros == 0) numzeros = countZeros(in, end, pos);
+      else if(pos + numzeros > end || in[pos + numzeros - 1] != 0) --numzeros;
+    } else {
+      numzeros = 0;
+    }
+    updateHashChain(hash, wpos, hashval, (unsigned short)numzeros);
+  }
+}
+
+/*
+Deflate in[start..end) as blocks that can be followed by the blocks of in[end..]. Up to windowsize
+bytes before start are used as dictionary. If final is 0, the piece is closed with an empty stored
+block (zlib's "sync flush") so that it ends on a byte boundary.
+*/
+static unsigned deflatePiece(ucvector* out, const unsigned char* in, size_t start, size_t end,
+                             unsigned final, const LodePNGCompressSettings* settings) {
+  unsigned error = 0;
+  size_t i, blocksize, numdeflateblocks;
+  size_t insize = end - start;
+  Hash hash;
+  LodePNGBitWriter writer;
+
+  if(settings->btype > 2) return 61;
+  /*stored blocks always end on a byte boundary, no flush needed*/
+  else if(settings->btype == 0) return deflateNoCompression(out, in + start, insize, final);
+  else if(settings->btype == 1) blocksize = insize;
+  else /*if(settings->btype == 2)*/ {
+    blocksize = insize / 8u + 8;
+    if(blocksize < 65536) blocksize = 65536;
+    if(blocksize > 262144) blocksize = 262144;
+  }
+
+  numdeflateblocks = (insize + blocksize - 1) / blocksize;
+  if(numdeflateblocks == 0) numdeflateblocks = 1;
+
+  LodePNGBitWriter_init(&writer, out);
+  error = hash_init(&hash, settings->windowsize);
+
+  if(!error && settings->use_lz77 && start > 0) {
+    size_t dictstart = start > settings->windowsize ? start - settings->windowsize : 0;
+    primeHash(&hash, in, dictstart, start, end, settings->windowsize);
+  }
+
+  for(i = 0; i != numdeflateblocks && !error; ++i) {
+    unsigned lastblock = final && (i == numdeflateblocks - 1);
+    size_t blockstart = start + i * blocksize;
+    size_t blockend = blockstart + blocksize;
+    if(blockend > end) blockend = end;
+
+    if(settings->btype == 1) error = deflateFixed(&writer, &hash, in, blockstart, blockend, settings, lastblock);
+    else error = deflateDynamic(&writer, &hash, in, blockstart, blockend, settings, lastblock);
+  }
+
+  hash_cleanup(&hash);
+
+  if(!error && !final) {
+    /*empty stored block: BFINAL 0 and BTYPE 00, then LEN 0 and NLEN 65535 from the next byte boundary*/
+    writeBits(&writer, 0, 3);
+    if(!ucvector_resize(out, out->size + 4)) return 83; /*alloc fail*/
+    out->data[out->size - 4] = 0;
+    out->data[out->size - 3] = 0;
+    out->data[out->size - 2] = 255;
+    out->data[out->size - 1] = 255;
+  }
+
+  return error;
+}
+
+typedef struct DeflateJob {
+  const unsigned char* in;
+  size_t start, end;
+  unsigned final;
+  const LodePNGCompressSettings* settings;
+  ucvector out;
+  unsigned adler;
+  unsigned error;
+} DeflateJob;
+
+static void runDeflateJob(DeflateJob* job) {
+  job->error = deflatePiece(&job->out, job->in, job->start, job->end, job->final, job->settings);
+  job->adler = update_adler32(1u, job->in + job->start, (unsigned)(job->end - job->start));
+}
+
+static size_t deflateThreadCount(const LodePNGCompressSettings* settings) {
+#ifdef LODEPNG_COMPILE_CPP
+  if(settings->numthreads == 0) {
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores == 0 ? 1 : cores;
+  }
+  return settings->numthreads;
+#else /*LODEPNG_COMPILE_CPP*/
+  (void)settings;
+  return 1;
+#endif /*LODEPNG_COMPILE_CPP*/
+}
+
+/*
+Deflate in[start..end) and append it to out, on as many threads as the settings allow. Each thread
+compresses one piece with the 32K before it as dictionary, like pigz, and the pieces are appended in
+order. If adler is not NULL, it is updated with the adler32 of the piece.
+*/
+static unsigned deflateChunkv(ucvector* out, unsigned* adler, const unsigned char* in,
+                              size_t start, size_t end, unsigned final,
+                              const LodePNGCompressSettings* settings) {
+  size_t insize = end - start;
+  size_t numpieces = deflateThreadCount(settings);
+  size_t maxpieces = insize / PARALLEL_DEFLATE_MIN_PIECE;
+  unsigned error = 0;
+  if(numpieces > maxpieces) numpieces = maxpieces;
+
+  if(numpieces <= 1) {
+    error = deflatePiece(out, in, start, end, final, settings);
+    if(!error && adler) *adler = adler32_combine(*adler, update_adler32(1u, in + start, (unsigned)insize), insize);
+    return error;
+  }
+
+#ifdef LODEPNG_COMPILE_CPP
+  {
+    size_t i, piecesize = (insize + numpieces - 1) / numpieces;
+    std::vector<DeflateJob> jobs(numpieces);
+    std::vector<std::thread> threads;
+
+    for(i = 0; i != numpieces; ++i) {
+      jobs[i].in = in;
+      jobs[i].start = start + i * piecesize;
+      jobs[i].end = (i == numpieces - 1) ? end : jobs[i].start + piecesize;
+      jobs[i].final = final && (i == numpieces - 1);
+      jobs[i].settings = settings;
+      jobs[i].out = ucvector_init(NULL, 0);
+      jobs[i].adler = 1u;
+      jobs[i].error = 0;
+    }
+
+    /*the first piece runs on the calling thread, if a thread cannot be started its piece runs here too*/
+    for(i = 1; i != numpieces; ++i) {
+      try {
+        threads.push_back(std::thread(runDeflateJob, &jobs[i]));
+      } catch(...) {
+        runDeflateJob(&jobs[i]);
+      }
+    }
+    runDeflateJob(&jobs[0]);
+    for(i = 0; i != threads.size(); ++i) threads[i].join();
+
+    for(i = 0; i != numpieces; ++i) {
+      size_t pos = out->size;
+      if(!error) error = jobs[i].error;
+      if(!error && !ucvector_resize(out, out->size + jobs[i].out.size)) error = 83; /*alloc fail*/
+      if(!error) {
+        lodepng_memcpy(out->data + pos, jobs[i].out.data, jobs[i].out.size);
+        if(adler) *adler = adler32_combine(*adler, jobs[i].adler, jobs[i].end - jobs[i].start);
+      }
+      lodepng_free(jobs[i].out.data);
+    }
+  }
+#endif /*LODEPNG_COMPILE_CPP*/
+
+  return error;
+}
+
+unsigned lodepng_deflate_chunk(unsigned char** out, size_t* outsize, unsigned* adler,
+                               const unsigned char* in, size_t dictsize, size_t insize,
+                               unsigned final, const LodePNGCompressSettings* settings) {
+  ucvector v = ucvector_init(*out, *outsize);
+  unsigned error = deflateChunkv(&v, adler, in - dictsize, dictsize, dictsize + insize, final, settings);
+  *out = v.data;
+  *outsize = v.size;
+  return error;
+}
+
+#endif /*LODEPNG_COMPILE_ENCODER*/
+
 /* ////////////////////////////////////////////////////////////////////////// */
 /* / Zlib                                                                   / */
 /* ////////////////////////////////////////////////////////////////////////// */
@@ -2237,8 +2489,18 @@ unsigned lodepng_zlib_compress(unsigned char** out, size_t* outsize, const unsig
   unsigned error;
   unsigned char* deflatedata = 0;
   size_t deflatesize = 0;
-
-  error = deflate(&deflatedata, &deflatesize, in, insize, settings);
+  unsigned ADLER32 = 1u;
+
+  if(settings->numthreads != 1 && !settings->custom_deflate) {
+    /*the adler32 is computed by the compression threads, piece by piece*/
+    ucvector v = ucvector_init(NULL, 0);
+    error = deflateChunkv(&v, &ADLER32, in, 0, insize, 1, settings);
+    deflatedata = v.data;
+    deflatesize = v.size;
+  } else {
+    error = deflate(&deflatedata, &deflatesize, in, insize, settings);
+    if(!error) ADLER32 = adler32(in, (unsigned)insize);
+  }
 
   *out = NULL;
   *outsize = 0;
@@ -2249,7 +2511,6 @@ unsigned lodepng_zlib_compress(unsigned char** out, size_t* outsize, const unsig
   }
 
   if(!error) {
-    unsigned ADLER32 = adler32(in, (unsigned)insize);
     /*zlib data: 1 byte CMF (CM+CINFO), 1 byte FLG, deflate data, 4 byte ADLER32 checksum of the Decompressed data*/
     unsigned CMF = 120; /*0b01111000: CM 8, CINFO 7. With CINFO 7, any window size up to 32768 can be used.*/
     unsigned FLEVEL = 0;
@@ -2317,13 +2578,14 @@ void lodepng_compress_settings_init(LodePNGCompressSettings* settings) {
   settings->minmatch = 3;
   settings->nicematch = 128;
   settings->lazymatching = 1;
+  settings->numthreads = 1;
 
   settings->custom_zlib = 0;
   settings->custom_deflate = 0;
   settings->custom_context = 0;
 }
 
-const LodePNGCompressSettings lodepng_default_compress_settings = {2, 1, DEFAULT_WINDOWSIZE, 3, 128, 1, 0, 0, 0};
+const LodePNGCompressSettings lodepng_default_compress_settings = {2, 1, DEFAULT_WINDOWSIZE, 3, 128, 1, 1, 0, 0, 0};
 
 
 #endif /*LODEPNG_COMPILE_ENCODER*/
@@ -352,11 +352,16 @@ struct LodePNGCompressSettings /*deflate = compress*/ {
   /*LZ77 related settings*/
   unsigned btype; /*the block type for LZ (0, 1, 2 or 3, see zlib standard). Should be 2 for proper compression.*/
   unsigned use_lz77; /*whether or not to use LZ77. Should be 1 for proper compression.*/
-  unsigned windowsize; /*must be a power of two <= 32768. higher compresses more but is slower. Default value: 2048.*/
+  unsigned windowsize; /*must be a power of two <= 32768. higher compresses more but is slower. Default value: 2048.
+                        1 only looks for runs of the previous byte (run length encoding), which is the fastest.*/
   unsigned minmatch; /*minimum lz77 length. 3 is normally best, 6 can be better for some PNGs. Default: 0*/
   unsigned nicematch; /*stop searching if >= this length found. Set to 258 for best compression. Default: 128*/
   unsigned lazymatching; /*use lazy matching: better compression but a bit slower. Default: true*/
 
+  /*compress independent pieces of the input on this many threads and stitch them in one zlib stream (like
+  pigz). 1 = single threaded, 0 = one thread per hardware core. Only used in C++ builds. Default: 1*/
+  unsigned numthreads;
+
   /*use custom zlib encoder instead of built in one (default: null)*/
   unsigned (*custom_zlib)(unsigned char**, size_t*,
                           const unsigned char*, size_t,
@@ -1148,6 +1153,18 @@ unsigned lodepng_deflate(unsigned char** out, size_t* outsize,
                          const unsigned char* in, size_t insize,
                          const LodePNGCompressSettings* settings);
 
+/*
+Compress one piece of a longer deflate stream and append it to *out. The dictsize bytes right before in
+(at most windowsize of them are used) must be the previous input of the stream: LZ77 may refer back to
+them. If final is 0, the piece ends with an empty stored block so it stops on a byte boundary and the
+next piece can be appended directly, otherwise its last block is marked final. If adler is not NULL, it
+is updated with the bytes of in, so starting from 1 it ends as the adler32 of the whole stream.
+With settings->numthreads != 1 the piece is split and compressed on several threads.
+*/
+unsigned lodepng_deflate_chunk(unsigned char** out, size_t* outsize, unsigned* adler,
+                               const unsigned char* in, size_t dictsize, size_t insize,
+                               unsigned final, const LodePNGCompressSettings* settings);
+
 #endif /*LODEPNG_COMPILE_ENCODER*/
 #endif /*LODEPNG_COMPILE_ZLIB*/
 
@@ -14,6 +14,7 @@
 #include <GLFW/glfw3.h>
 
 #include <iostream>
+#include <string>
 
 // Transformation imports
 #include <glm/glm.hpp>
@@ -38,8 +39,20 @@
 #define DISPERSION_RATE 2
 
 
-int main()
+int BVHBenchMain();
+int SoftwareMain();
+int TriangleTestMain();
+int HybridTestMain();
+
+
+int main(int argc, char** argv)
 {
+    // Mesures sans fenêtre
+    if(argc > 1 && std::string(argv[1]) == "--bench-bvh") return BVHBenchMain();
+    if(argc > 1 && std::string(argv[1]) == "--software") return SoftwareMain();
+    if(argc > 1 && std::string(argv[1]) == "--test-triangles") return TriangleTestMain();
+    if(argc > 1 && std::string(argv[1]) == "--test-hybrid") return HybridTestMain();
+
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
@@ -0,0 +1,376 @@
+/**
+ * @file main_bvh_bench.cpp
+ * @brief Mesure des performances de construction des hiérarchies englobantes.
+ * 
+ * Ce fichier contient un point d'entrée sans fenêtre (./igai_exe --bench-bvh) qui construit des
+ * hiérarchies de tailles croissantes, sur des sphères et sur des triangles, et affiche le débit de
+ * construction en primitives par seconde, puis compare le débit de parcours des hiérarchies binaires
+ * et à quatre fils (WideBVH) sur des scènes de sphères, les maillages en précision complète et
+ * compressés (QuantizedBVH), et le coût par image (construction + parcours) de la hiérarchie et de
+ * la grille régulière (UniformGrid) sur des scènes animées.
+ * 
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "BVHBuilder.hpp"
+#include "MeshBVH.hpp"
+#include "ThreadPool.hpp"
+#include "UniformGrid.hpp"
+#include "WideBVH.hpp"
+
+#define BENCH_MIN_PRIMITIVES 1000
+#define BENCH_MAX_PRIMITIVES 1000000
+#define BENCH_SPHERE_SPREAD 100.0f
+#define BENCH_RAY_COUNT 200000
+#define BENCH_FRAMES 4 // Images simulées par scène animée
+
+
+/**
+ * @brief Sphères de rayons aléatoires dispersées dans un cube.
+ */
+static std::vector<BVHPrimitive> randomSpheres(unsigned int count, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> position(-BENCH_SPHERE_SPREAD, BENCH_SPHERE_SPREAD);
+    std::uniform_real_distribution<float> radius(0.05f, 1.0f);
+
+    std::vector<BVHPrimitive> primitives(count);
+    for(BVHPrimitive &primitive : primitives) {
+        glm::vec3 center(position(rng), position(rng), position(rng));
+        glm::vec3 extent(radius(rng));
+        primitive = {center - extent, center + extent};
+    }
+    return primitives;
+}
+
+
+/**
+ * @brief Surface ondulée discrétisée en count triangles environ (comme une BezierSurface).
+ */
+static std::vector<Triangle> waveSurface(unsigned int count)
+{
+    unsigned int side = std::max(2u, (unsigned int)std::sqrt(count / 2.0f) + 1);
+    auto point = [side](unsigned int i, unsigned int j) {
+        float u = float(i) / (side - 1), v = float(j) / (side - 1);
+        return glm::vec3(u, 0.2f * std::sin(12.0f * u) * std::cos(9.0f * v), v);
+    };
+
+    std::vector<Triangle> triangles;
+    triangles.reserve(2 * (side - 1) * (side - 1));
+    for(unsigned int i = 0; i + 1 < side; ++i) {
+        for(unsigned int j = 0; j + 1 < side; ++j) {
+            triangles.push_back({point(i, j), point(i + 1, j), point(i, j + 1)});
+            triangles.push_back({point(i + 1, j + 1), point(i + 1, j), point(i, j + 1)});
+        }
+    }
+    return triangles;
+}
+
+
+/**
+ * @brief Sphère la plus proche dans la feuille (first, count), comme TraceScene::intersectSpheres().
+ */
+static bool intersectLeaf(const std::vector<glm::vec4> &spheres, unsigned int first, unsigned int count,
+    const glm::vec3 &origin, const glm::vec3 &direction, float &t)
+{
+    bool hit = false;
+    for(unsigned int i = first; i < first + count; ++i) {
+        glm::vec3 L = origin - glm::vec3(spheres[i]);
+        float b = glm::dot(direction, L);
+        // r² - |L - b d|² plutôt que b² - |L|² + r² : pas de compensation pour les petites sphères
+        // lointaines, où les deux versions (grille et hiérarchies) trouveraient de faux contacts
+        glm::vec3 perpendicular = L - b * direction;
+        float discriminant = spheres[i].w * spheres[i].w - glm::dot(perpendicular, perpendicular);
+        if(discriminant < 0) continue;
+
+        float t0 = -b - std::sqrt(discriminant);
+        if(t0 < 0) t0 = -b + std::sqrt(discriminant);
+        if(t0 >= 0 && t0 < t) {
+            t = t0;
+            hit = true;
+        }
+    }
+    return hit;
+}
+
+
+/**
+ * @brief Parcours de référence de la hiérarchie binaire (le fils le plus proche d'abord).
+ */
+static bool traverseBinary(const std::vector<BVHNode> &nodes, const std::vector<glm::vec4> &spheres,
+    const glm::vec3 &origin, const glm::vec3 &direction, float &t)
+{
+    glm::vec3 invDir = 1.0f / direction;
+    bool hit = false;
+
+    unsigned int stack[BVH_STACK_SIZE];
+    float stackDistance[BVH_STACK_SIZE];
+    unsigned int stackSize = 0;
+    unsigned int current = 0;
+    if(intersectBounds(nodes[0], origin, invDir, t) == std::numeric_limits<float>::infinity()) return false;
+
+    while(true)
+    {
+        const BVHNode &node = nodes[current];
+        if(node.count > 0) {
+            hit |= intersectLeaf(spheres, node.first, node.count, origin, direction, t);
+        }
+        else {
+            float dLeft = intersectBounds(nodes[node.first], origin, invDir, t);
+            float dRight = intersectBounds(nodes[node.first + 1], origin, invDir, t);
+            unsigned int near = node.first, far = node.first + 1;
+            if(dRight < dLeft) {
+                std::swap(dLeft, dRight);
+                std::swap(near, far);
+            }
+
+            if(dLeft != std::numeric_limits<float>::infinity()) {
+                if(dRight != std::numeric_limits<float>::infinity()) {
+                    stack[stackSize] = far;
+                    stackDistance[stackSize++] = dRight;
+                }
+                current = near;
+                continue;
+            }
+        }
+
+        do {
+            if(stackSize == 0) return hit;
+            --stackSize;
+        } while(stackDistance[stackSize] > t);
+        current = stack[stackSize];
+    }
+}
+
+
+/**
+ * @brief Lance BENCH_RAY_COUNT rayons vers un nuage de count sphères et compare les deux parcours.
+ */
+static void benchTraversal(unsigned int count, std::mt19937 &rng)
+{
+    std::vector<BVHPrimitive> primitives = randomSpheres(count, rng);
+    std::vector<BVHNode> nodes;
+    std::vector<unsigned int> order;
+    BVHBuilder::build(primitives, 4, nodes, order);
+    WideBVH wide(nodes);
+
+    std::vector<glm::vec4> spheres;
+    spheres.reserve(count);
+    for(unsigned int index : order) {
+        const BVHPrimitive &primitive = primitives[index];
+        spheres.push_back(glm::vec4(0.5f * (primitive.boundsMin + primitive.boundsMax),
+            0.5f * (primitive.boundsMax.x - primitive.boundsMin.x)));
+    }
+
+    // Rayons depuis une sphère englobant le nuage vers des points du nuage
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<glm::vec3> origins(BENCH_RAY_COUNT), directions(BENCH_RAY_COUNT);
+    for(unsigned int i = 0; i < BENCH_RAY_COUNT; ++i) {
+        glm::vec3 from(unit(rng), unit(rng), unit(rng));
+        glm::vec3 to(unit(rng), unit(rng), unit(rng));
+        origins[i] = 2.0f * BENCH_SPHERE_SPREAD * glm::normalize(from);
+        directions[i] = glm::normalize(BENCH_SPHERE_SPREAD * to - origins[i]);
+    }
+
+    unsigned int binaryHits = 0, wideHits = 0, mismatches = 0;
+    std::vector<float> binaryT(BENCH_RAY_COUNT);
+
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < BENCH_RAY_COUNT; ++i) {
+        binaryT[i] = std::numeric_limits<float>::max();
+        binaryHits += traverseBinary(nodes, spheres, origins[i], directions[i], binaryT[i]);
+    }
+    double binaryMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < BENCH_RAY_COUNT; ++i) {
+        float t = std::numeric_limits<float>::max();
+        wideHits += wide.traverse(origins[i], directions[i], t,
+            [&](unsigned int first, unsigned int leafCount, float &tMax) {
+            return intersectLeaf(spheres, first, leafCount, origins[i], directions[i], tMax);
+        });
+        if(t != binaryT[i]) ++mismatches;
+    }
+    double wideMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[parcours] " << count << " spheres, " << BENCH_RAY_COUNT << " rayons : binaire "
+        << BENCH_RAY_COUNT / binaryMs / 1000.0 << " Mrayons/s (" << binaryHits << " touches), 4 fils "
+        << BENCH_RAY_COUNT / wideMs / 1000.0 << " Mrayons/s (" << wideHits << " touches, "
+        << mismatches << " differences)" << std::endl;
+}
+
+
+/**
+ * @brief Compare la mémoire et le débit d'un maillage de count triangles selon son stockage.
+ */
+static void benchStorage(unsigned int count, std::mt19937 &rng)
+{
+    std::vector<Triangle> triangles = waveSurface(count);
+    MeshBVH meshes[2] = {MeshBVH(triangles, MESH_STORAGE_FLOAT), MeshBVH(triangles, MESH_STORAGE_QUANTIZED)};
+
+    // Rayons de haut en bas, légèrement inclinés, sur toute la surface
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<glm::vec3> origins(BENCH_RAY_COUNT), directions(BENCH_RAY_COUNT);
+    for(unsigned int i = 0; i < BENCH_RAY_COUNT; ++i) {
+        origins[i] = glm::vec3(unit(rng), 1.0f, unit(rng));
+        directions[i] = glm::normalize(glm::vec3(unit(rng) - 0.5f, -2.0f, unit(rng) - 0.5f));
+    }
+
+    std::vector<float> distances[2];
+    for(unsigned int storage = 0; storage < 2; ++storage)
+    {
+        unsigned int hits = 0;
+        distances[storage].resize(BENCH_RAY_COUNT);
+
+        auto start = std::chrono::steady_clock::now();
+        for(unsigned int i = 0; i < BENCH_RAY_COUNT; ++i) {
+            unsigned int triangle;
+            distances[storage][i] = std::numeric_limits<float>::max();
+            hits += meshes[storage].intersect(origins[i], directions[i], distances[storage][i], triangle);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "[stockage] " << triangles.size() << " triangles, "
+            << (storage == MESH_STORAGE_FLOAT ? "flottant " : "compresse ")
+            << meshes[storage].memoryUsage() / 1024 << " Ko, " << BENCH_RAY_COUNT / ms / 1000.0
+            << " Mrayons/s (" << hits << " touches)" << std::endl;
+    }
+
+    float maxError = 0.0f;
+    for(unsigned int i = 0; i < BENCH_RAY_COUNT; ++i)
+        maxError = std::max(maxError, std::abs(distances[0][i] - distances[1][i]));
+    std::cout << "[stockage] ecart maximal des distances : " << maxError << ", rapport de taille : "
+        << (float)meshes[0].memoryUsage() / meshes[1].memoryUsage() << std::endl;
+}
+
+
+/**
+ * @brief Scène de count sphères qui bougent toutes à chaque image, rayCount rayons par image :
+ * compare la reconstruction de la hiérarchie, son recalcul (refit) et la reconstruction de la grille.
+ */
+static void benchAnimated(unsigned int count, unsigned int rayCount, std::mt19937 &rng)
+{
+    std::vector<BVHPrimitive> primitives = randomSpheres(count, rng);
+    std::vector<glm::vec4> spheres(count);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    std::vector<glm::vec3> origins(rayCount), directions(rayCount);
+    for(unsigned int i = 0; i < rayCount; ++i) {
+        origins[i] = 2.0f * BENCH_SPHERE_SPREAD * glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)));
+        directions[i] = glm::normalize(BENCH_SPHERE_SPREAD * glm::vec3(unit(rng), unit(rng), unit(rng)) - origins[i]);
+    }
+
+    std::vector<BVHNode> nodes;
+    std::vector<unsigned int> order, refitOrder; // La reconstruction change l'ordre à chaque image
+    WideBVH refitted;
+    UniformGrid grid;
+    double milliseconds[3] = {0.0, 0.0, 0.0};
+    unsigned int hits[3] = {0, 0, 0};
+
+    for(unsigned int frame = 0; frame < BENCH_FRAMES; ++frame)
+    {
+        // Toutes les sphères bougent un peu
+        for(unsigned int i = 0; i < count; ++i) {
+            glm::vec3 offset(unit(rng), unit(rng), unit(rng));
+            primitives[i].boundsMin += offset;
+            primitives[i].boundsMax += offset;
+            spheres[i] = glm::vec4(0.5f * (primitives[i].boundsMin + primitives[i].boundsMax),
+                0.5f * (primitives[i].boundsMax.x - primitives[i].boundsMin.x));
+        }
+
+        for(unsigned int method = 0; method < 3; ++method)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            if(method == 2) {
+                grid.build(primitives);
+                for(unsigned int r = 0; r < rayCount; ++r) {
+                    float t = std::numeric_limits<float>::max();
+                    hits[method] += grid.traverse(origins[r], directions[r], t, [&](unsigned int index, float &tMax) {
+                        return intersectLeaf(spheres, index, 1, origins[r], directions[r], tMax);
+                    });
+                }
+            }
+            else {
+                // Reconstruction à chaque image, ou une seule fois puis recalcul des boîtes
+                WideBVH rebuilt;
+                if(method == 0 || frame == 0) {
+                    BVHBuilder::build(primitives, 4, nodes, order);
+                    rebuilt = WideBVH(nodes);
+                    if(method == 1) {
+                        refitted = rebuilt;
+                        refitOrder = order;
+                    }
+                }
+                else {
+                    refitted.refit([&](unsigned int first, unsigned int leafCount, glm::vec3 &boundsMin,
+                        glm::vec3 &boundsMax) {
+                        for(unsigned int i = first; i < first + leafCount; ++i) {
+                            boundsMin = glm::min(boundsMin, primitives[refitOrder[i]].boundsMin);
+                            boundsMax = glm::max(boundsMax, primitives[refitOrder[i]].boundsMax);
+                        }
+                    });
+                }
+
+                const WideBVH &tree = (method == 0) ? rebuilt : refitted;
+                const std::vector<unsigned int> &treeOrder = (method == 0) ? order : refitOrder;
+                for(unsigned int r = 0; r < rayCount; ++r) {
+                    float t = std::numeric_limits<float>::max();
+                    hits[method] += tree.traverse(origins[r], directions[r], t,
+                        [&](unsigned int first, unsigned int leafCount, float &tMax) {
+                        bool hit = false;
+                        for(unsigned int i = first; i < first + leafCount; ++i)
+                            hit |= intersectLeaf(spheres, treeOrder[i], 1, origins[r], directions[r], tMax);
+                        return hit;
+                    });
+                }
+            }
+
+            milliseconds[method] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+    std::cout << "[anime] " << count << " spheres, " << rayCount << " rayons par image, ms par image : "
+        << "BVH reconstruite " << milliseconds[0] / BENCH_FRAMES << ", BVH recalculee "
+        << milliseconds[1] / BENCH_FRAMES << ", grille " << milliseconds[2] / BENCH_FRAMES
+        << " (touches " << hits[0] << " / " << hits[1] << " / " << hits[2] << ")" << std::endl;
+}
+
+
+int BVHBenchMain()
+{
+    std::mt19937 rng(42);
+    std::cout << "Construction SAH par intervalles, " << ThreadPool::instance().getWorkerCount() + 1
+        << " threads" << std::endl;
+
+    for(unsigned int count = BENCH_MIN_PRIMITIVES; count <= BENCH_MAX_PRIMITIVES; count *= 10)
+    {
+        std::vector<BVHPrimitive> spheres = randomSpheres(count, rng);
+        std::vector<BVHNode> nodes;
+        std::vector<unsigned int> order;
+        BVHBuilder::printStats("spheres", BVHBuilder::build(spheres, 4, nodes, order));
+
+        MeshBVH mesh(waveSurface(count));
+        BVHBuilder::printStats("triangles", mesh.getBuildStats());
+    }
+
+    for(unsigned int count = BENCH_MIN_PRIMITIVES; count <= BENCH_MAX_PRIMITIVES; count *= 10)
+        benchTraversal(count, rng);
+
+    for(unsigned int count = BENCH_MIN_PRIMITIVES; count <= BENCH_MAX_PRIMITIVES; count *= 10)
+        benchStorage(count, rng);
+
+    for(unsigned int count = BENCH_MIN_PRIMITIVES; count <= BENCH_MAX_PRIMITIVES / 10; count *= 10)
+        for(unsigned int rayCount = 1000; rayCount <= 100000; rayCount *= 10)
+            benchAnimated(count, rayCount, rng);
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file main_hybrid_test.cpp
+ * @brief Vérification des captures hybrides (points vus rastérisés).
+ *
+ * Ce fichier contient un point d'entrée sans fenêtre (./igai_exe --test-hybrid) qui calcule des
+ * captures de plusieurs scènes avec Intersection::rayRenderRows() et avec GBuffer en mode
+ * TRACE_PRIMARY_RASTER, et vérifie que les images, les instances vues et leurs distances sont
+ * identiques au bit près. Les scènes comprennent des carreaux ondulés, des sphères, et des feuilles
+ * enroulées ou repliées qui se cachent elles-mêmes. Le programme renvoie 1 s'il a trouvé une différence.
+ *
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "AppContext.hpp"
+#include "BezierSurface.hpp"
+#include "GBuffer.hpp"
+#include "Intersections.hpp"
+#include "Sphere.hpp"
+
+#define TEST_WIDTH 400
+#define TEST_HEIGHT 300
+#define TEST_GRID 9 // Points de contrôle par côté : au-delà de BEZIER_PATCH_MAX_ORDER, un maillage
+
+#define TEST_SCENE_WAVES 0   // Carreaux ondulés, dont les crêtes cachent les creux
+#define TEST_SCENE_SPHERES 1 // Les mêmes avec des sphères, cherchées par des rayons
+#define TEST_SCENE_CURLED 2  // Feuilles enroulées sur elles-mêmes
+#define TEST_SCENE_FOLDED 3  // Feuille repliée sur elle-même, les deux couches presque confondues
+#define TEST_SCENE_COUNT 4
+#define TEST_FOLD_GAP 0.0001f // Écart entre les couches de la feuille repliée, par rangée
+
+
+/**
+ * @brief Carreau ondulé de côté size à partir de (x0, z0).
+ */
+static ptsGrid waves(float x0, float z0, float size, float phase)
+{
+    ptsGrid grid(TEST_GRID, std::vector<glm::vec3>(TEST_GRID));
+    for(int i = 0; i < TEST_GRID; ++i) {
+        for(int j = 0; j < TEST_GRID; ++j) {
+            float height = 0.4f * std::sin(phase + i * 0.9f) * std::cos(j * 0.7f) + 0.5f * (i + j) / 16.0f;
+            grid[i][j] = glm::vec3(x0 + size * i / 8.0f, height, z0 + size * j / 8.0f);
+        }
+    }
+    return grid;
+}
+
+
+/**
+ * @brief Feuille enroulée presque deux fois autour de l'axe z, de largeur size à partir de z0.
+ */
+static ptsGrid curled(float z0, float size)
+{
+    ptsGrid grid(TEST_GRID, std::vector<glm::vec3>(TEST_GRID));
+    for(int i = 0; i < TEST_GRID; ++i) {
+        float angle = i * 1.5f, radius = 1.6f - 0.12f * i;
+        for(int j = 0; j < TEST_GRID; ++j) {
+            grid[i][j] = glm::vec3(radius * std::cos(angle), 1.5f + radius * std::sin(angle),
+                z0 + size * j / 8.0f + 0.3f * std::sin(i * 1.3f));
+        }
+    }
+    return grid;
+}
+
+
+/**
+ * @brief Feuille qui part vers +x puis revient sur ses pas, chaque rangée un peu plus haute.
+ */
+static ptsGrid folded()
+{
+    static const float along[TEST_GRID] = {0.f, 1.f, 2.f, 3.f, 4.f, 3.f, 2.f, 1.f, 0.f};
+    ptsGrid grid(TEST_GRID, std::vector<glm::vec3>(TEST_GRID));
+    for(int i = 0; i < TEST_GRID; ++i)
+        for(int j = 0; j < TEST_GRID; ++j)
+            grid[i][j] = glm::vec3(along[i] - 2.0f, TEST_FOLD_GAP * i + 0.2f * std::sin(j * 0.8f), 0.5f * j - 2.0f);
+    return grid;
+}
+
+
+static void buildScene(AppContext &context, unsigned int scene)
+{
+    // La lumière est l'objet actif : la première sphère
+    context.addObject(std::make_unique<Sphere>(0.2f, glm::vec3(0.f, 4.f, 1.f), glm::vec3(1.f)));
+    Camera* camera = context.getCamera();
+
+    if(scene == TEST_SCENE_CURLED) {
+        context.addObject(std::make_unique<BezierSurface>(curled(-1.5f, 3.0f)));
+        context.addObject(std::make_unique<BezierSurface>(curled(2.0f, 2.0f)));
+        camera->Position = glm::vec3(0.2f, 1.2f, -3.2f);
+        camera->Yaw = 88.0f;
+        camera->Pitch = 8.0f;
+        camera->ProcessMouseMovement(0.0f, 0.0f);
+        return;
+    }
+
+    if(scene == TEST_SCENE_FOLDED) {
+        context.addObject(std::make_unique<BezierSurface>(folded()));
+        camera->Position = glm::vec3(0.3f, 2.5f, -4.0f);
+        camera->Yaw = 90.0f;
+        camera->Pitch = -35.0f;
+        camera->ProcessMouseMovement(0.0f, 0.0f);
+        return;
+    }
+
+    if(scene == TEST_SCENE_SPHERES) {
+        context.addObject(std::make_unique<Sphere>(0.8f, glm::vec3(1.0f, 1.5f, 0.f), glm::vec3(0.8f, 0.8f, 0.9f)));
+        context.addObject(std::make_unique<Sphere>(0.5f, glm::vec3(-1.2f, 1.2f, 1.0f), glm::vec3(0.9f, 0.3f, 0.2f)));
+    }
+    for(int a = 0; a < 3; ++a) {
+        for(int b = 0; b < 3; ++b) {
+            context.addObject(std::make_unique<BezierSurface>(waves(-4.5f + 3.f * a, -4.5f + 3.f * b, 2.9f, a + b * 1.3f)));
+            context.getObject(context.size()-1)->setColor(glm::vec3(0.2f + 0.1f * a, 0.3f + 0.1f * b, 0.7f));
+        }
+    }
+    camera->Position = glm::vec3(-2.0f, 0.5f, -1.0f);
+    camera->ProcessMouseMovement(-300.0f, -200.0f);
+}
+
+
+/**
+ * @brief Compare les captures d'une scène.
+ * @return le nombre de pixels différents.
+ */
+static size_t compareScene(unsigned int scene)
+{
+    AppContext context(TEST_WIDTH, TEST_HEIGHT, glm::vec3(0.1f), glm::vec3(1.f));
+    buildScene(context, scene);
+    TraceCamera camera(context, TEST_WIDTH, TEST_HEIGHT);
+
+    std::vector<float> reference(3 * TEST_WIDTH * TEST_HEIGHT), cached(reference.size()), hybrid(reference.size());
+    Intersection::rayRenderRows(*context.getTraceScene(), camera, 0, TEST_HEIGHT, reference.data());
+
+    GBuffer rays;
+    rays.render(*context.getTraceScene(), camera, cached.data());
+
+    context.setTracePrimary(TRACE_PRIMARY_RASTER);
+    GBuffer raster;
+    GBufferStats stats = raster.render(*context.getTraceScene(), camera, hybrid.data());
+
+    size_t differences = 0;
+    for(unsigned int y = 0; y < TEST_HEIGHT; ++y) {
+        for(unsigned int x = 0; x < TEST_WIDTH; ++x) {
+            size_t pixel = (size_t)y * TEST_WIDTH + x;
+            bool same = rays.getInstance(x, y) == raster.getInstance(x, y) && rays.getDepth(x, y) == raster.getDepth(x, y);
+            for(unsigned int c = 0; c < 3; ++c)
+                same = same && reference[3 * pixel + c] == hybrid[3 * pixel + c] && reference[3 * pixel + c] == cached[3 * pixel + c];
+            if(!same) ++differences;
+        }
+    }
+
+    std::cout << "Scene " << scene << " : " << differences << " pixels differents sur " << stats.pixels
+        << " (" << stats.rasterPixels << " rasterises)" << std::endl;
+    return differences;
+}
+
+
+int HybridTestMain()
+{
+    size_t differences = 0;
+    for(unsigned int scene = 0; scene < TEST_SCENE_COUNT; ++scene) differences += compareScene(scene);
+
+    std::cout << (differences ? "Echec" : "Succes") << " des captures hybrides" << std::endl;
+    return differences ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file main_software.cpp
+ * @brief Rendu logiciel sans fenêtre ni carte graphique.
+ *
+ * Ce fichier contient un point d'entrée sans fenêtre (./igai_exe --software) qui construit la
+ * scène de main.cpp (avec des sphères placées par un générateur à graine fixe), la dessine avec
+ * SoftwareRenderer en faisant tourner la caméra autour d'elle, affiche le temps moyen par image et
+ * enregistre la dernière image dans software_capture.png.
+ *
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+
+#include <glm/glm.hpp>
+
+#include "AppContext.hpp"
+#include "BezierCurve.hpp"
+#include "BezierSurface.hpp"
+#include "Capture.hpp"
+#include "SoftwareRenderer.hpp"
+#include "Sphere.hpp"
+
+#define SOFTWARE_BENCH_WIDTH 800
+#define SOFTWARE_BENCH_HEIGHT 600
+#define SOFTWARE_BENCH_FRAMES 60
+#define SOFTWARE_BENCH_SEED 42
+#define SOFTWARE_BENCH_ORBIT 8.0f  // Distance de la caméra au centre de la scène
+#define SOFTWARE_BENCH_STEP 6.0f   // Degrés parcourus par la caméra à chaque image
+
+
+/**
+ * @brief Ajoute au contexte les objets de main.cpp.
+ */
+static void buildScene(AppContext &context)
+{
+    std::mt19937 rng(SOFTWARE_BENCH_SEED);
+    std::uniform_real_distribution<float> position(-2.0f, 2.0f);
+    std::uniform_real_distribution<float> radius(0.1f, 1.0f);
+    for(int i = 0; i < 10; ++i) {
+        glm::vec3 origin(position(rng), position(rng), position(rng));
+        context.addObject(std::make_unique<Sphere>(radius(rng), origin, glm::vec3(1.0f)));
+    }
+
+    ptsTab controlPolygon = {
+        {-0.5f, -0.5f, -0.5f},
+        {-0.5f, 0.5f, -0.5f},
+        {0.5f, 0.5f, -0.5f},
+        {0.5f, -0.5f, -0.5f},
+        {0.5f, -0.5f, 0.5f},
+        {0.5f, 0.5f, 0.5f},
+        {-0.5f, 0.5f, 0.5f},
+        {-0.5f, -0.5f, 0.5f}
+    };
+    context.addObject(std::make_unique<BezierCurve>(controlPolygon));
+    context.getObject(context.size()-1)->setOrigin({-1.f, 0.5f, -0.5f});
+
+    ptsGrid controlPolygonSurface = {
+        {
+            {-0.5f,  0.0f,  0.0f},
+            {-0.5f,  1.0f,  0.0f},
+            { 0.5f,  1.0f,  0.0f},
+            { 0.5f,  0.0f,  0.0f}
+        },
+        {
+            {-0.5f,  0.0f, -1.0f},
+            {-0.5f,  1.0f, -1.0f},
+            { 0.5f,  1.0f, -1.0f},
+            { 0.5f,  0.0f, -1.0f}
+        }
+    };
+    context.addObject(std::make_unique<BezierSurface>(controlPolygonSurface));
+    context.getObject(context.size()-1)->setOrigin({-3.f, 0.f, 0.f});
+
+    context.addObject(std::make_unique<Sphere>(0.5f, glm::vec3(-5.f, 0.5f, 0.f), glm::vec3(1.0f)));
+}
+
+
+int SoftwareMain()
+{
+    AppContext context(
+        SOFTWARE_BENCH_WIDTH,
+        SOFTWARE_BENCH_HEIGHT,
+        glm::vec3(0.2f, 0.3f, 0.3f),
+        glm::vec3(1.f, 1.0f, 1.0f)
+    );
+    buildScene(context);
+
+    SoftwareRenderer renderer(SOFTWARE_BENCH_WIDTH, SOFTWARE_BENCH_HEIGHT);
+    Camera* camera = context.getCamera();
+    glm::vec3 center(-1.0f, 0.5f, 0.0f);
+
+    SoftwareStats stats = {0, 0, 0, 0.0, 0.0};
+    double total = 0.0;
+    for(unsigned int frame = 0; frame < SOFTWARE_BENCH_FRAMES; ++frame)
+    {
+        // Tour de la caméra autour de la scène, toujours tournée vers son centre
+        camera->ProcessMouseMovement(SOFTWARE_BENCH_STEP / camera->MouseSensitivity, 0.0f);
+        camera->Position = center - SOFTWARE_BENCH_ORBIT * camera->Front;
+
+        auto start = std::chrono::steady_clock::now();
+        stats = renderer.render(context);
+        total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double average = total / SOFTWARE_BENCH_FRAMES;
+    std::cout << SOFTWARE_BENCH_FRAMES << " images " << SOFTWARE_BENCH_WIDTH << "x" << SOFTWARE_BENCH_HEIGHT
+        << " : " << average << " ms par image (" << 1000.0 / average << " images/s)" << std::endl;
+    SoftwareRenderer::printStats("derniere image", stats);
+
+    unsigned error = Capture::savePNG("software_capture.png", renderer.getPixels(), renderer.getWidth(),
+        renderer.getHeight(), PNG_PRESET_DEFAULT);
+    if(error) {
+        std::cout << "Echec de l'enregistrement de software_capture.png (erreur " << error << ")" << std::endl;
+        return 1;
+    }
+    std::cout << "Image enregistree dans software_capture.png" << std::endl;
+    return 0;
+}
@@ -30,6 +30,7 @@
 #include "BezierSurface.hpp"
 #include "Ray.hpp"
 #include "Sphere.hpp"
+#include "TraceScene.hpp"
 
 
 #define SCREEN_WIDTH 800
@@ -123,6 +124,9 @@ int StarsMain()
     // ---------------
     contextIGAI.addObject(std::make_unique<Sphere>(0.5f, glm::vec3(-5.f, 0.5f, 0.f), glm::vec3(1.0f)));
 
+    // Animated scene: the uniform grid is cheaper to rebuild every frame than the BVH
+    contextIGAI.setTraceAcceleration(TRACE_ACCEL_GRID);
+
     // crosshair setup
     // ---------------
     Shader crosshairShader("shaders/quad.vs", "shaders/quad.fs");
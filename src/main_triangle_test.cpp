@@ -0,0 +1,146 @@
+/**
+ * @file main_triangle_test.cpp
+ * @brief Vérification des tests d'intersection rayon / triangle.
+ *
+ * Ce fichier contient un point d'entrée sans fenêtre (./igai_exe --test-triangles) qui compare,
+ * sur des triangles et des rayons aléatoires, la version par paquet de TriangleIntersection à la
+ * version de référence, puis vérifie qu'aucun rayon visant un sommet ou une arête commune d'un
+ * éventail de triangles ne passe entre eux. Le programme renvoie 1 s'il a trouvé une erreur.
+ *
+ * @author Oscar G.
+ * @date 2026-10-19
+ */
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "TriangleIntersection.hpp"
+
+#define TEST_SEED 7
+#define TEST_PACKETS 200000    // Paquets comparés à la version de référence
+#define TEST_EDGE_RAYS 100000  // Rayons visant un sommet ou une arête commune
+#define TEST_FAN_TRIANGLES 8   // Triangles de l'éventail, deux paquets
+#define TEST_T_MIN 0.00001f
+
+
+/**
+ * @brief Cherche le triangle le plus proche de paquet en paquet, avec la version par paquet ou la
+ * version de référence.
+ * @return l'indice du triangle touché, -1 si aucun ne l'est.
+ */
+static int closestHit(const WatertightRay &ray, const std::vector<TrianglePacket> &packets, bool packed,
+    float &t, float &u, float &v)
+{
+    int hit = -1;
+    for(const TrianglePacket &packet : packets) {
+        if(packed) {
+            int lane = TriangleIntersection::intersectPacket(ray, packet, TEST_T_MIN, t, u, v);
+            if(lane >= 0) hit = packet.triangles[lane];
+            continue;
+        }
+        for(int lane = 0; lane < TRIANGLE_PACKET_SIZE; ++lane) {
+            if(TriangleIntersection::intersect(ray, TriangleIntersection::getPacketTriangle(packet, lane),
+                TEST_T_MIN, t, u, v)) hit = packet.triangles[lane];
+        }
+    }
+    return hit;
+}
+
+
+/**
+ * @brief Compare les deux versions sur des paquets de triangles quelconques : même triangle, même
+ * distance et mêmes coordonnées barycentriques, au bit près.
+ * @return le nombre de différences.
+ */
+static unsigned int comparePackets(std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+    auto point = [&]() {return glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));};
+
+    unsigned int mismatches = 0, hits = 0;
+    std::vector<TrianglePacket> packets(1);
+    for(unsigned int i = 0; i < TEST_PACKETS; ++i) {
+        Triangle triangles[TRIANGLE_PACKET_SIZE];
+        for(unsigned int lane = 0; lane < TRIANGLE_PACKET_SIZE; ++lane) {
+            triangles[lane] = {point(), point(), point()};
+            TriangleIntersection::setPacketTriangle(packets[0], lane, triangles[lane], lane);
+        }
+
+        // Rayon visant un point près d'un des triangles, dedans ou juste à côté
+        const Triangle &aimed = triangles[i % TRIANGLE_PACKET_SIZE];
+        float b = 0.6f * coordinate(rng) + 0.4f, c = 0.6f * coordinate(rng) + 0.4f;
+        glm::vec3 target = aimed.a + b * (aimed.b - aimed.a) + c * (aimed.c - aimed.a);
+        glm::vec3 origin = 3.0f * point();
+        WatertightRay ray = TriangleIntersection::prepare(origin, target - origin);
+
+        float t1 = INFINITY, u1 = 0.0f, v1 = 0.0f;
+        float t2 = INFINITY, u2 = 0.0f, v2 = 0.0f;
+        int packed = closestHit(ray, packets, true, t1, u1, v1);
+        int reference = closestHit(ray, packets, false, t2, u2, v2);
+        if(packed != reference || (packed >= 0 && (t1 != t2 || u1 != u2 || v1 != v2))) ++mismatches;
+        if(packed >= 0) ++hits;
+    }
+
+    std::cout << "Paquets / reference : " << mismatches << " differences sur " << TEST_PACKETS
+        << " paquets (" << hits << " touches)" << std::endl;
+    return mismatches;
+}
+
+
+/**
+ * @brief Vise le centre d'un éventail de triangles ou un point d'une de ses arêtes intérieures, avec
+ * les deux versions : le rayon doit toujours toucher un triangle.
+ * @return le nombre de rayons passés entre les triangles.
+ */
+static unsigned int checkEdges(std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> along(0.0f, 1.0f);
+
+    unsigned int leaks = 0;
+    std::vector<TrianglePacket> packets(TEST_FAN_TRIANGLES / TRIANGLE_PACKET_SIZE);
+    for(unsigned int i = 0; i < TEST_EDGE_RAYS; ++i) {
+        glm::vec3 center(coordinate(rng), coordinate(rng), coordinate(rng));
+        float twist = along(rng);
+        std::vector<glm::vec3> rim;
+        for(unsigned int k = 0; k < TEST_FAN_TRIANGLES; ++k) {
+            float angle = (k + twist) * 6.2831853f / TEST_FAN_TRIANGLES;
+            rim.push_back(center + glm::vec3(std::cos(angle), 0.3f * coordinate(rng), std::sin(angle)));
+        }
+        for(unsigned int k = 0; k < TEST_FAN_TRIANGLES; ++k) {
+            Triangle triangle = {center, rim[k], rim[(k + 1) % TEST_FAN_TRIANGLES]};
+            TriangleIntersection::setPacketTriangle(packets[k / TRIANGLE_PACKET_SIZE],
+                k % TRIANGLE_PACKET_SIZE, triangle, k);
+        }
+
+        // Un rayon sur deux vise le sommet commun, les autres une arête commune
+        glm::vec3 target = center;
+        if(i % 2) target += 0.9f * along(rng) * (rim[i % TEST_FAN_TRIANGLES] - center);
+        glm::vec3 origin = target + glm::vec3(0.5f * coordinate(rng), 1.0f, 0.5f * coordinate(rng));
+        WatertightRay ray = TriangleIntersection::prepare(origin, target - origin);
+
+        for(bool packed : {false, true}) {
+            float t = INFINITY, u = 0.0f, v = 0.0f;
+            if(closestHit(ray, packets, packed, t, u, v) < 0) ++leaks;
+        }
+    }
+
+    std::cout << "Aretes communes : " << leaks << " rayons passes entre les triangles sur "
+        << 2 * TEST_EDGE_RAYS << std::endl;
+    return leaks;
+}
+
+
+int TriangleTestMain()
+{
+    std::mt19937 rng(TEST_SEED);
+    unsigned int errors = comparePackets(rng);
+    errors += checkEdges(rng);
+
+    std::cout << (errors ? "Echec" : "Succes") << " des tests d'intersection rayon / triangle" << std::endl;
+    return errors ? 1 : 0;
+}